@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+// Generated by cmake/RestoreHeightsGenerator.cmake, do not edit
+
+#ifndef FEATHER_RESTOREHEIGHTSDATA_H
+#define FEATHER_RESTOREHEIGHTSDATA_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct RestoreHeightCheckpoint {
+    std::int64_t timestamp;
+    std::int64_t height;
+};
+
+namespace RestoreHeightsData {
+    constexpr RestoreHeightCheckpoint mainnet[] = {
+@RESTORE_HEIGHTS_MAINNET@
+    };
+
+    constexpr RestoreHeightCheckpoint stagenet[] = {
+@RESTORE_HEIGHTS_STAGENET@
+    };
+
+    template <std::size_t N>
+    constexpr bool isSorted(const RestoreHeightCheckpoint (&table)[N]) {
+        for (std::size_t i = 1; i < N; i++) {
+            if (table[i].timestamp <= table[i-1].timestamp || table[i].height <= table[i-1].height) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(isSorted(mainnet), "mainnet restore heights must be strictly increasing");
+    static_assert(isSorted(stagenet), "stagenet restore heights must be strictly increasing");
+}
+
+#endif //FEATHER_RESTOREHEIGHTSDATA_H
@@ -0,0 +1,24 @@
+# Generates constexpr restore height tables from the lists produced by contrib/generate-restore-heights/heights.py
+
+function(restore_heights_table NETTYPE OUTVAR)
+    set(HEIGHTS_FILE "${CMAKE_CURRENT_SOURCE_DIR}/src/assets/restore_heights_monero_${NETTYPE}.txt")
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${HEIGHTS_FILE}")
+
+    file(STRINGS "${HEIGHTS_FILE}" HEIGHTS_LINES REGEX "^[0-9]+:[0-9]+")
+    foreach(LINE ${HEIGHTS_LINES})
+        string(REGEX MATCH "^([0-9]+):([0-9]+)" _ "${LINE}")
+        list(APPEND TABLE "        {${CMAKE_MATCH_1}, ${CMAKE_MATCH_2}},")
+    endforeach()
+
+    if (NOT TABLE)
+        message(FATAL_ERROR "No restore heights found in ${HEIGHTS_FILE}")
+    endif()
+
+    list(JOIN TABLE "\n" TABLE_DATA)
+    set(${OUTVAR} "${TABLE_DATA}" PARENT_SCOPE)
+endfunction()
+
+restore_heights_table(mainnet RESTORE_HEIGHTS_MAINNET)
+restore_heights_table(stagenet RESTORE_HEIGHTS_STAGENET)
+
+configure_file("cmake/RestoreHeightsData.h.cmake" "${CMAKE_CURRENT_SOURCE_DIR}/src/utils/RestoreHeightsData.h")
@@ -5,15 +5,21 @@
 #include "ui_MainWindow.h"
 
 #include <QFileDialog>
+#include <QFutureWatcher>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QSaveFile>
+#include <QTextStream>
 
 #include "config-feather.h"
 #include "constants.h"
 #include "dialog/AccountSwitcherDialog.h"
 #include "dialog/BalanceDialog.h"
+#include "dialog/ConsolidationDialog.h"
 #include "dialog/DebugInfoDialog.h"
 #include "dialog/PasswordDialog.h"
+#include "dialog/PayoutDialog.h"
+#include "dialog/QrCodeDialog.h"
 #include "dialog/TorInfoDialog.h"
 #include "dialog/TxBroadcastDialog.h"
 #include "dialog/TxConfAdvDialog.h"
@@ -26,6 +32,7 @@
 #include "dialog/UpdateDialog.h"
 #include "libwalletqt/AddressBook.h"
 #include "libwalletqt/CoinsInfo.h"
+#include "libwalletqt/Subaddress.h"
 #include "libwalletqt/Transfer.h"
 #include "utils/AppData.h"
 #include "utils/AsyncTask.h"
@@ -34,16 +41,24 @@
 #include "utils/NetworkManager.h"
 #include "utils/os/tails.h"
 #include "utils/SemanticVersion.h"
+#include "utils/SyncBundle.h"
 #include "utils/TorManager.h"
+#include "utils/Trace.h"
 #include "utils/Updater.h"
 #include "utils/WebsocketNotifier.h"
 
+#ifdef WITH_SCANNER
+#include "qrcode_scanner/QrCodeScanDialog.h"
+#include <QtMultimedia/QCameraInfo>
+#endif
+
 MainWindow::MainWindow(WindowManager *windowManager, Wallet *wallet, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , m_windowManager(windowManager)
     , m_ctx(new AppContext(wallet))
 {
+    TRACE_SCOPE("MainWindow::MainWindow");
     ui->setupUi(this);
 
     // Ensure the destructor is called after closeEvent()
@@ -61,19 +76,15 @@ MainWindow::MainWindow(WindowManager *windowManager, Wallet *wallet, QWidget *pa
     this->initWalletContext();
 
     // Websocket notifier
-    connect(websocketNotifier(), &WebsocketNotifier::CCSReceived, ui->ccsWidget->model(), &CCSModel::updateEntries);
-    connect(websocketNotifier(), &WebsocketNotifier::BountyReceived, ui->bountiesWidget->model(), &BountiesModel::updateBounties);
-    connect(websocketNotifier(), &WebsocketNotifier::RedditReceived, ui->redditWidget->model(), &RedditModel::updatePosts);
-    connect(websocketNotifier(), &WebsocketNotifier::RevuoReceived, ui->revuoWidget, &RevuoWidget::updateItems);
     connect(websocketNotifier(), &WebsocketNotifier::UpdatesReceived, this, &MainWindow::onUpdatesAvailable);
-#ifdef HAS_XMRIG
-    connect(websocketNotifier(), &WebsocketNotifier::XMRigDownloadsReceived, m_xmrig, &XMRigWidget::onDownloads);
-#endif
     websocketNotifier()->emitCache(); // Get cached data
 
     connect(m_windowManager, &WindowManager::websocketStatusChanged, this, &MainWindow::onWebsocketStatusChanged);
     this->onWebsocketStatusChanged(!config()->get(Config::disableWebsocket).toBool());
 
+    // Create the widgets for the tab that is visible on startup
+    this->onTabChanged(ui->tabWidget->currentIndex());
+
     connect(m_windowManager, &WindowManager::torSettingsChanged, m_ctx.get(), &AppContext::onTorSettingsChanged);
     connect(torManager(), &TorManager::connectionStateChanged, this, &MainWindow::onTorConnectionStateChanged);
     this->onTorConnectionStateChanged(torManager()->torConnected);
@@ -107,10 +118,6 @@ void MainWindow::initStatusBar() {
     this->statusBar()->setStyleSheet("QStatusBar::item {border: None;}");
 #endif
 
-#if defined(Q_OS_MACOS)
-    this->patchStylesheetMac();
-#endif
-
     this->statusBar()->setFixedHeight(30);
 
     m_statusLabelStatus = new QLabel("Idle", this);
@@ -168,49 +175,19 @@ void MainWindow::initStatusBar() {
 }
 
 void MainWindow::initWidgets() {
+    TRACE_SCOPE("MainWindow::initWidgets");
     int homeWidget = config()->get(Config::homeWidget).toInt();
     ui->tabHomeWidget->setCurrentIndex(TabsHome(homeWidget));
 
-    // [History]
-    m_historyWidget = new HistoryWidget(m_ctx, this);
-    ui->historyWidgetLayout->addWidget(m_historyWidget);
-    connect(m_historyWidget, &HistoryWidget::viewOnBlockExplorer, this, &MainWindow::onViewOnBlockExplorer);
-    connect(m_historyWidget, &HistoryWidget::resendTransaction, this, &MainWindow::onResendTransaction);
-
-    // [Send]
-    m_sendWidget = new SendWidget(m_ctx, this);
-    ui->sendWidgetLayout->addWidget(m_sendWidget);
-    // --------------
-    m_contactsWidget = new ContactsWidget(m_ctx, this);
-    ui->contactsWidgetLayout->addWidget(m_contactsWidget);
-
-    // [Receive]
-    m_receiveWidget = new ReceiveWidget(m_ctx, this);
-    ui->receiveWidgetLayout->addWidget(m_receiveWidget);
-    connect(m_receiveWidget, &ReceiveWidget::showTransactions, [this](const QString &text) {
-        m_historyWidget->setSearchText(text);
-        ui->tabWidget->setCurrentIndex(Tabs::HISTORY);
-    });
-    connect(m_contactsWidget, &ContactsWidget::fillAddress, m_sendWidget, &SendWidget::fillAddress);
+    // Tab widgets are created the first time they are shown
+    connect(ui->tabWidget, &QTabWidget::currentChanged, this, &MainWindow::onTabChanged);
+    connect(ui->tabHomeWidget, &QTabWidget::currentChanged, this, &MainWindow::onHomeTabChanged);
 
-    // [Coins]
-    m_coinsWidget = new CoinsWidget(m_ctx, this);
-    ui->coinsWidgetLayout->addWidget(m_coinsWidget);
-
-#ifdef HAS_LOCALMONERO
-    m_localMoneroWidget = new LocalMoneroWidget(this, m_ctx);
-    ui->localMoneroLayout->addWidget(m_localMoneroWidget);
-#else
+#ifndef HAS_LOCALMONERO
     ui->tabWidgetExchanges->setTabVisible(0, false);
 #endif
 
-#ifdef HAS_XMRIG
-    m_xmrig = new XMRigWidget(m_ctx, this);
-    ui->xmrRigLayout->addWidget(m_xmrig);
-
-    connect(m_xmrig, &XMRigWidget::miningStarted, [this]{ this->updateTitle(); });
-    connect(m_xmrig, &XMRigWidget::miningEnded, [this]{ this->updateTitle(); });
-#else
+#ifndef HAS_XMRIG
     ui->tabWidget->setTabVisible(Tabs::XMRIG, false);
 #endif
 
@@ -224,6 +201,195 @@ void MainWindow::initWidgets() {
     });
 }
 
+void MainWindow::onTabChanged(int index) {
+    switch (index) {
+        case Tabs::HOME:
+            this->onHomeTabChanged(ui->tabHomeWidget->currentIndex());
+            break;
+        case Tabs::HISTORY:
+            this->historyWidget();
+            break;
+        case Tabs::SEND:
+            this->sendWidget();
+            this->contactsWidget();
+            break;
+        case Tabs::RECEIVE:
+            this->receiveWidget();
+            break;
+        case Tabs::COINS:
+            this->coinsWidget();
+            break;
+#ifdef HAS_LOCALMONERO
+        case Tabs::EXCHANGES:
+            this->localMoneroWidget();
+            break;
+#endif
+#ifdef HAS_XMRIG
+        case Tabs::XMRIG:
+            this->xmrigWidget();
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+void MainWindow::onHomeTabChanged(int index) {
+    if (ui->tabWidget->currentIndex() != Tabs::HOME) {
+        return;
+    }
+
+    switch (index) {
+        case TabsHome::CCS:
+            this->ccsWidget();
+            break;
+        case TabsHome::BOUNTIES:
+            this->bountiesWidget();
+            break;
+        case TabsHome::REDDIT:
+            this->redditWidget();
+            break;
+        case TabsHome::REVUO:
+            this->revuoWidget();
+            break;
+        default:
+            break;
+    }
+}
+
+HistoryWidget* MainWindow::historyWidget() {
+    if (!m_historyWidget) {
+        m_historyWidget = new HistoryWidget(m_ctx, this);
+        ui->historyWidgetLayout->addWidget(m_historyWidget);
+        connect(m_historyWidget, &HistoryWidget::viewOnBlockExplorer, this, &MainWindow::onViewOnBlockExplorer);
+        connect(m_historyWidget, &HistoryWidget::resendTransaction, this, &MainWindow::onResendTransaction);
+        m_historyWidget->setSearchbarVisible(config()->get(Config::showSearchbar).toBool());
+        m_historyWidget->setWebsocketEnabled(m_websocketEnabled);
+    }
+    return m_historyWidget;
+}
+
+SendWidget* MainWindow::sendWidget() {
+    if (!m_sendWidget) {
+        m_sendWidget = new SendWidget(m_ctx, this);
+        ui->sendWidgetLayout->addWidget(m_sendWidget);
+        m_sendWidget->skinChanged();
+        if (m_criticalWarningShown) {
+            m_sendWidget->disableSendButton();
+        }
+    }
+    return m_sendWidget;
+}
+
+ContactsWidget* MainWindow::contactsWidget() {
+    if (!m_contactsWidget) {
+        m_contactsWidget = new ContactsWidget(m_ctx, this);
+        ui->contactsWidgetLayout->addWidget(m_contactsWidget);
+        connect(m_contactsWidget, &ContactsWidget::fillAddress, [this](const QString &address) {
+            this->sendWidget()->fillAddress(address);
+        });
+        m_contactsWidget->setSearchbarVisible(config()->get(Config::showSearchbar).toBool());
+    }
+    return m_contactsWidget;
+}
+
+ReceiveWidget* MainWindow::receiveWidget() {
+    if (!m_receiveWidget) {
+        m_receiveWidget = new ReceiveWidget(m_ctx, this);
+        ui->receiveWidgetLayout->addWidget(m_receiveWidget);
+        connect(m_receiveWidget, &ReceiveWidget::showTransactions, [this](const QString &text) {
+            this->historyWidget()->setSearchText(text);
+            ui->tabWidget->setCurrentIndex(Tabs::HISTORY);
+        });
+        m_receiveWidget->setSearchbarVisible(config()->get(Config::showSearchbar).toBool());
+    }
+    return m_receiveWidget;
+}
+
+CoinsWidget* MainWindow::coinsWidget() {
+    if (!m_coinsWidget) {
+        m_coinsWidget = new CoinsWidget(m_ctx, this);
+        ui->coinsWidgetLayout->addWidget(m_coinsWidget);
+        m_coinsWidget->setModel(m_ctx->wallet->coinsModel(), m_ctx->wallet->coins());
+        m_coinsWidget->setSearchbarVisible(config()->get(Config::showSearchbar).toBool());
+    }
+    return m_coinsWidget;
+}
+
+CCSWidget* MainWindow::ccsWidget() {
+    if (!m_ccsWidget) {
+        m_ccsWidget = new CCSWidget(this);
+        ui->ccsWidgetLayout->addWidget(m_ccsWidget);
+        connect(m_ccsWidget, &CCSWidget::selected, this, &MainWindow::showSendScreen);
+        connect(websocketNotifier(), &WebsocketNotifier::CCSReceived, m_ccsWidget->model(), &CCSModel::updateEntries);
+        websocketNotifier()->emitCache("ccs");
+    }
+    return m_ccsWidget;
+}
+
+BountiesWidget* MainWindow::bountiesWidget() {
+    if (!m_bountiesWidget) {
+        m_bountiesWidget = new BountiesWidget(this);
+        ui->bountiesWidgetLayout->addWidget(m_bountiesWidget);
+        connect(m_bountiesWidget, &BountiesWidget::donate, this, &MainWindow::fillSendTab);
+        connect(websocketNotifier(), &WebsocketNotifier::BountyReceived, m_bountiesWidget->model(), &BountiesModel::updateBounties);
+        websocketNotifier()->emitCache("bounties");
+    }
+    return m_bountiesWidget;
+}
+
+RedditWidget* MainWindow::redditWidget() {
+    if (!m_redditWidget) {
+        m_redditWidget = new RedditWidget(this);
+        ui->redditWidgetLayout->addWidget(m_redditWidget);
+        connect(m_redditWidget, &RedditWidget::setStatusText, this, &MainWindow::setStatusText);
+        connect(websocketNotifier(), &WebsocketNotifier::RedditReceived, m_redditWidget->model(), &RedditModel::updatePosts);
+        websocketNotifier()->emitCache("reddit");
+    }
+    return m_redditWidget;
+}
+
+RevuoWidget* MainWindow::revuoWidget() {
+    if (!m_revuoWidget) {
+        m_revuoWidget = new RevuoWidget(this);
+        ui->revuoWidgetLayout->addWidget(m_revuoWidget);
+        connect(m_revuoWidget, &RevuoWidget::donate, this, &MainWindow::fillSendTab);
+        connect(websocketNotifier(), &WebsocketNotifier::RevuoReceived, m_revuoWidget, &RevuoWidget::updateItems);
+        m_revuoWidget->skinChanged();
+        websocketNotifier()->emitCache("revuo");
+    }
+    return m_revuoWidget;
+}
+
+#ifdef HAS_LOCALMONERO
+LocalMoneroWidget* MainWindow::localMoneroWidget() {
+    if (!m_localMoneroWidget) {
+        m_localMoneroWidget = new LocalMoneroWidget(this, m_ctx);
+        ui->localMoneroLayout->addWidget(m_localMoneroWidget);
+        m_localMoneroWidget->skinChanged();
+        websocketNotifier()->emitCache("localmonero_countries");
+        websocketNotifier()->emitCache("localmonero_currencies");
+        websocketNotifier()->emitCache("localmonero_payment_methods");
+    }
+    return m_localMoneroWidget;
+}
+#endif
+
+#ifdef HAS_XMRIG
+XMRigWidget* MainWindow::xmrigWidget() {
+    if (!m_xmrig) {
+        m_xmrig = new XMRigWidget(m_ctx, this);
+        ui->xmrRigLayout->addWidget(m_xmrig);
+        connect(m_xmrig, &XMRigWidget::miningStarted, [this]{ this->updateTitle(); });
+        connect(m_xmrig, &XMRigWidget::miningEnded, [this]{ this->updateTitle(); });
+        connect(websocketNotifier(), &WebsocketNotifier::XMRigDownloadsReceived, m_xmrig, &XMRigWidget::onDownloads);
+        m_xmrig->setDownloadsTabEnabled(m_websocketEnabled);
+        websocketNotifier()->emitCache("xmrig");
+    }
+    return m_xmrig;
+}
+#endif
+
 void MainWindow::initMenu() {
     // TODO: Rename actions to follow style
     // [File]
@@ -255,10 +421,16 @@ void MainWindow::initMenu() {
     // [Wallet] -> [Advanced] -> [Export]
     connect(ui->actionExportOutputs,   &QAction::triggered, this, &MainWindow::exportOutputs);
     connect(ui->actionExportKeyImages, &QAction::triggered, this, &MainWindow::exportKeyImages);
+    connect(ui->actionExportSyncBundleFile,      &QAction::triggered, [this]{this->exportSyncBundle(File);});
+    connect(ui->actionExportSyncBundleClipboard, &QAction::triggered, [this]{this->exportSyncBundle(Clipboard);});
+    connect(ui->actionExportSyncBundleQrCode,    &QAction::triggered, [this]{this->exportSyncBundle(AnimatedQrCode);});
 
     // [Wallet] -> [Advanced] -> [Import]
     connect(ui->actionImportOutputs,   &QAction::triggered, this, &MainWindow::importOutputs);
     connect(ui->actionImportKeyImages, &QAction::triggered, this, &MainWindow::importKeyImages);
+    connect(ui->actionImportSyncBundleFile,      &QAction::triggered, [this]{this->importSyncBundle(File);});
+    connect(ui->actionImportSyncBundleClipboard, &QAction::triggered, [this]{this->importSyncBundle(Clipboard);});
+    connect(ui->actionImportSyncBundleQrCode,    &QAction::triggered, [this]{this->importSyncBundle(AnimatedQrCode);});
 
     // [Wallet] -> [History]
     connect(ui->actionExport_CSV, &QAction::triggered, this, &MainWindow::onExportHistoryCSV);
@@ -267,6 +439,12 @@ void MainWindow::initMenu() {
     connect(ui->actionExportContactsCSV, &QAction::triggered, this, &MainWindow::onExportContactsCSV);
     connect(ui->actionImportContactsCSV, &QAction::triggered, this, &MainWindow::importContacts);
 
+    // [Wallet] -> [Addresses]
+    connect(ui->actionGenerateSubaddresses, &QAction::triggered, this, &MainWindow::generateSubaddresses);
+    connect(ui->actionExportSubaddressesCSV, &QAction::triggered, [this]{
+        this->exportSubaddresses(0);
+    });
+
     // [View]
     m_tabShowHideSignalMapper = new QSignalMapper(this);
     connect(ui->actionShow_Searchbar, &QAction::toggled, this, &MainWindow::toggleSearchbar);
@@ -319,10 +497,19 @@ void MainWindow::initMenu() {
     connect(ui->actionVerifyTxProof,               &QAction::triggered, this, &MainWindow::menuVerifyTxProof);
     connect(ui->actionLoadUnsignedTxFromFile,      &QAction::triggered, this, &MainWindow::loadUnsignedTx);
     connect(ui->actionLoadUnsignedTxFromClipboard, &QAction::triggered, this, &MainWindow::loadUnsignedTxFromClipboard);
+    connect(ui->actionLoadUnsignedTxFromQrCode,    &QAction::triggered, this, &MainWindow::loadUnsignedTxFromQrCode);
     connect(ui->actionLoadSignedTxFromFile,        &QAction::triggered, this, &MainWindow::loadSignedTx);
     connect(ui->actionLoadSignedTxFromText,        &QAction::triggered, this, &MainWindow::loadSignedTxFromText);
+    connect(ui->actionLoadSignedTxFromQrCode,      &QAction::triggered, this, &MainWindow::loadSignedTxFromQrCode);
+#ifndef WITH_SCANNER
+    ui->actionLoadUnsignedTxFromQrCode->setVisible(false);
+    ui->actionLoadSignedTxFromQrCode->setVisible(false);
+    ui->actionImportSyncBundleQrCode->setVisible(false);
+#endif
     connect(ui->actionImport_transaction,          &QAction::triggered, this, &MainWindow::importTransaction);
     connect(ui->actionPay_to_many,                 &QAction::triggered, this, &MainWindow::payToMany);
+    connect(ui->actionBulkPayout,                  &QAction::triggered, this, &MainWindow::showPayoutDialog);
+    connect(ui->actionConsolidateOutputs,          &QAction::triggered, this, &MainWindow::showConsolidationDialog);
     connect(ui->actionAddress_checker,             &QAction::triggered, this, &MainWindow::showAddressChecker);
     connect(ui->actionCalculator,                  &QAction::triggered, this, &MainWindow::showCalcWindow);
     connect(ui->actionCreateDesktopEntry,          &QAction::triggered, this, &MainWindow::onCreateDesktopEntry);
@@ -369,14 +556,6 @@ void MainWindow::initHome() {
 
     m_balanceTickerWidget = new BalanceTickerWidget(this, m_ctx, false);
     ui->fiatTickerLayout->addWidget(m_balanceTickerWidget);
-
-    connect(ui->ccsWidget, &CCSWidget::selected, this, &MainWindow::showSendScreen);
-    connect(ui->bountiesWidget, &BountiesWidget::donate, this, &MainWindow::fillSendTab);
-    connect(ui->redditWidget, &RedditWidget::setStatusText, this, &MainWindow::setStatusText);
-    connect(ui->revuoWidget, &RevuoWidget::donate, [this](const QString &address, const QString &description){
-        m_sendWidget->fill(address, description);
-        ui->tabWidget->setCurrentIndex(Tabs::SEND);
-    });
 }
 
 void MainWindow::initWalletContext() {
@@ -403,6 +582,12 @@ void MainWindow::initWalletContext() {
     connect(m_ctx->wallet, &Wallet::connectionStatusChanged, this, &MainWindow::onConnectionStatusChanged);
     connect(m_ctx->wallet, &Wallet::currentSubaddressAccountChanged, this, &MainWindow::updateTitle);
     connect(m_ctx->wallet, &Wallet::walletPassphraseNeeded, this, &MainWindow::onWalletPassphraseNeeded);
+    connect(m_ctx->wallet, &Wallet::importExportStarted, this, &MainWindow::onImportExportStarted);
+    connect(m_ctx->wallet, &Wallet::importExportFinished, this, &MainWindow::onImportExportFinished);
+    connect(m_ctx->wallet, &Wallet::subaddressesProgress, this, &MainWindow::onSubaddressesProgress);
+    connect(m_ctx->wallet, &Wallet::subaddressesAdded, this, &MainWindow::onSubaddressesAdded);
+    connect(m_ctx->wallet, &Wallet::contactsProgress, this, &MainWindow::onContactsProgress);
+    connect(m_ctx->wallet, &Wallet::contactsAdded, this, &MainWindow::onContactsAdded);
 }
 
 void MainWindow::menuToggleTabVisible(const QString &key){
@@ -482,7 +667,6 @@ void MainWindow::onWalletOpened() {
 
     // coins page
     m_ctx->wallet->coins()->refresh(m_ctx->wallet->currentSubaddressAccount());
-    m_coinsWidget->setModel(m_ctx->wallet->coinsModel(), m_ctx->wallet->coins());
     m_ctx->wallet->coinsModel()->setCurrentSubaddressAccount(m_ctx->wallet->currentSubaddressAccount());
 
     // Coin labeling uses set_tx_note, so we need to refresh history too
@@ -503,9 +687,10 @@ void MainWindow::onWalletOpened() {
 }
 
 void MainWindow::onBalanceUpdated(quint64 balance, quint64 spendable) {
-    bool hide = config()->get(Config::hideBalance).toBool();
-    int displaySetting = config()->get(Config::balanceDisplay).toInt();
-    int decimals = config()->get(Config::amountPrecision).toInt();
+    auto settings = configSnapshot();
+    bool hide = settings->hideBalance;
+    int displaySetting = settings->balanceDisplay;
+    int decimals = settings->amountPrecision;
 
     QString balance_str = "Balance: ";
     if (hide) {
@@ -552,7 +737,7 @@ void MainWindow::tryStoreWallet() {
         return;
     }
 
-    m_ctx->wallet->store();
+    m_ctx->storeWallet(true);
 }
 
 void MainWindow::onWebsocketStatusChanged(bool enabled) {
@@ -564,10 +749,15 @@ void MainWindow::onWebsocketStatusChanged(bool enabled) {
     ui->tabWidget->setTabVisible(Tabs::CALC, enabled && config()->get(Config::showTabCalc).toBool());
     ui->tabWidget->setTabVisible(Tabs::EXCHANGES, enabled && config()->get(Config::showTabExchange).toBool());
 
-    m_historyWidget->setWebsocketEnabled(enabled);
+    m_websocketEnabled = enabled;
+    if (m_historyWidget) {
+        m_historyWidget->setWebsocketEnabled(enabled);
+    }
 
 #ifdef HAS_XMRIG
-    m_xmrig->setDownloadsTabEnabled(enabled);
+    if (m_xmrig) {
+        m_xmrig->setDownloadsTabEnabled(enabled);
+    }
 #endif
 }
 
@@ -731,7 +921,9 @@ void MainWindow::onTransactionCommitted(bool status, PendingTransaction *tx, con
             dialog->setAttribute(Qt::WA_DeleteOnClose);
         }
 
-        m_sendWidget->clearFields();
+        if (m_sendWidget) {
+            m_sendWidget->clearFields();
+        }
     } else {
         auto err = tx->errorString();
         QString body = QString("Error committing transaction: %1").arg(err);
@@ -842,7 +1034,9 @@ void MainWindow::menuSettingsClicked() {
         connect(&settings, &Settings::preferredFiatCurrencyChanged, widget, &TickerWidgetBase::updateDisplay);
     }
     connect(&settings, &Settings::preferredFiatCurrencyChanged, m_balanceTickerWidget, &BalanceTickerWidget::updateDisplay);
-    connect(&settings, &Settings::preferredFiatCurrencyChanged, m_sendWidget, QOverload<>::of(&SendWidget::onPreferredFiatCurrencyChanged));
+    if (m_sendWidget) {
+        connect(&settings, &Settings::preferredFiatCurrencyChanged, m_sendWidget, QOverload<>::of(&SendWidget::onPreferredFiatCurrencyChanged));
+    }
     connect(&settings, &Settings::skinChanged, this, &MainWindow::skinChanged);
     connect(&settings, &Settings::websocketStatusChanged, m_windowManager, &WindowManager::onWebsocketStatusChanged);
     settings.exec();
@@ -867,21 +1061,26 @@ void MainWindow::skinChanged(const QString &skinName) {
     m_windowManager->changeSkin(skinName);
     ColorScheme::updateFromWidget(this);
     this->updateWidgetIcons();
-
-#if defined(Q_OS_MACOS)
-    this->patchStylesheetMac();
-#endif
 }
 
 void MainWindow::updateWidgetIcons() {
-    m_sendWidget->skinChanged();
+    if (m_sendWidget) {
+        m_sendWidget->skinChanged();
+    }
 #ifdef HAS_LOCALMONERO
-    m_localMoneroWidget->skinChanged();
+    if (m_localMoneroWidget) {
+        m_localMoneroWidget->skinChanged();
+    }
 #endif
     ui->conversionWidget->skinChanged();
-    ui->revuoWidget->skinChanged();
+    if (m_revuoWidget) {
+        m_revuoWidget->skinChanged();
+    }
 
     m_statusBtnHwDevice->setIcon(this->hardwareDevicePairedIcon());
+
+    // Only restyle the coin control frame when the color scheme changes
+    ui->frame_coinControl->setStyleSheet(ColorScheme::GREEN.asStylesheet(true));
 }
 
 QIcon MainWindow::hardwareDevicePairedIcon() {
@@ -910,7 +1109,9 @@ void MainWindow::closeEvent(QCloseEvent *event) {
 
         config()->set(Config::homeWidget, ui->tabHomeWidget->currentIndex());
 
-        m_historyWidget->resetModel();
+        if (m_historyWidget) {
+            m_historyWidget->resetModel();
+        }
 
         m_updateBytes.stop();
         m_txTimer.stop();
@@ -927,7 +1128,7 @@ void MainWindow::closeEvent(QCloseEvent *event) {
 }
 
 void MainWindow::donateButtonClicked() {
-    m_sendWidget->fill(constants::donationAddress, "Donation to the Feather development team");
+    this->sendWidget()->fill(constants::donationAddress, "Donation to the Feather development team");
     ui->tabWidget->setCurrentIndex(Tabs::SEND);
 }
 
@@ -942,7 +1143,7 @@ void MainWindow::showSendTab() {
 }
 
 void MainWindow::fillSendTab(const QString &address, const QString &description) {
-    m_sendWidget->fill(address, description);
+    this->sendWidget()->fill(address, description);
     ui->tabWidget->setCurrentIndex(Tabs::SEND);
 }
 
@@ -952,15 +1153,35 @@ void MainWindow::showCalcWindow() {
 
 void MainWindow::payToMany() {
     ui->tabWidget->setCurrentIndex(Tabs::SEND);
-    m_sendWidget->payToMany();
+    this->sendWidget()->payToMany();
     QMessageBox::information(this, "Pay to many", "Enter a list of outputs in the 'Pay to' field.\n"
                                                   "One output per line.\n"
                                                   "Format: address, amount\n"
                                                   "A maximum of 16 addresses may be specified.");
 }
 
+void MainWindow::showPayoutDialog() {
+    if (m_ctx->wallet->viewOnly()) {
+        QMessageBox::warning(this, "Bulk payout", "Bulk payouts need a wallet that can sign transactions.");
+        return;
+    }
+
+    PayoutDialog dialog(this, m_ctx);
+    dialog.exec();
+}
+
+void MainWindow::showConsolidationDialog() {
+    if (m_ctx->wallet->viewOnly() || m_ctx->wallet->isHwBacked()) {
+        QMessageBox::warning(this, "Consolidate outputs", "Consolidation needs a wallet that can sign transactions without a device.");
+        return;
+    }
+
+    ConsolidationDialog dialog(this, m_ctx);
+    dialog.exec();
+}
+
 void MainWindow::showSendScreen(const CCSEntry &entry) { // TODO: rename this function
-    m_sendWidget->fill(entry.address, QString("CCS: %1").arg(entry.title));
+    this->sendWidget()->fill(entry.address, QString("CCS: %1").arg(entry.title));
     ui->tabWidget->setCurrentIndex(Tabs::SEND);
 }
 
@@ -987,19 +1208,186 @@ void MainWindow::importContacts() {
     const QString targetFile = QFileDialog::getOpenFileName(this, "Import CSV file", QDir::homePath(), "CSV Files (*.csv)");
     if(targetFile.isEmpty()) return;
 
-    auto *model = m_ctx->wallet->addressBookModel();
-    QMapIterator<QString, QString> i(model->readCSV(targetFile));
-    int inserts = 0;
-    while (i.hasNext()) {
-        i.next();
-        bool addressValid = WalletManager::addressValid(i.value(), m_ctx->wallet->nettype());
-        if(addressValid) {
-            m_ctx->wallet->addressBook()->addRow(i.value(), "", i.key());
-            inserts++;
+    QSet<QString> existing;
+    auto *addressBook = m_ctx->wallet->addressBook();
+    for (quint64 i = 0; i < addressBook->count(); i++) {
+        addressBook->getRow(i, [&existing](AddressBookInfo &row) {
+            existing.insert(row.address());
+        });
+    }
+    NetworkType::Type nettype = m_ctx->wallet->nettype();
+
+    // Validating addresses is slow, keep the GUI responsive
+    ui->actionImportContactsCSV->setEnabled(false);
+    auto *watcher = new QFutureWatcher<QVector<AddressBookModel::CsvRow>>(this);
+    connect(watcher, &QFutureWatcher<QVector<AddressBookModel::CsvRow>>::finished, [this, watcher]{
+        watcher->deleteLater();
+        this->onContactsParsed(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([targetFile, nettype, existing]{
+        return AddressBookModel::readCSV(targetFile, nettype, existing);
+    }));
+}
+
+void MainWindow::onContactsParsed(const QVector<AddressBookModel::CsvRow> &rows) {
+    QVector<QPair<QString, QString>> valid;
+    m_contactLines.clear();
+    m_contactsRejected.clear();
+    for (const auto &row : rows) {
+        if (row.error.isEmpty()) {
+            valid.append({row.address, row.description});
+            m_contactLines.append(row.line);
+        } else {
+            m_contactsRejected.insert(row.line, row.error);
         }
     }
 
-    QMessageBox::information(this, "Contacts imported", QString("Total contacts imported: %1").arg(inserts));
+    if (valid.isEmpty()) {
+        this->onContactsAdded(0, {});
+        return;
+    }
+
+    auto *dialog = new QProgressDialog("Waiting for the wallet to finish synchronizing...", QString(), 0, valid.size(), this);
+    dialog->setWindowTitle("Import contacts");
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setMinimumDuration(0);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+    m_contactsDialog = dialog;
+    dialog->show();
+
+    m_ctx->wallet->addContactsAsync(valid);
+}
+
+void MainWindow::onContactsProgress(int done, int total) {
+    if (m_contactsDialog) {
+        m_contactsDialog->setLabelText(QString("Importing contacts (%1 of %2)...").arg(QString::number(done), QString::number(total)));
+        m_contactsDialog->setValue(done);
+    }
+}
+
+void MainWindow::onContactsAdded(int added, const QMap<int, QString> &errors) {
+    if (m_contactsDialog) {
+        m_contactsDialog->deleteLater();
+        m_contactsDialog = nullptr;
+    }
+    ui->actionImportContactsCSV->setEnabled(true);
+
+    QMap<int, QString> rejected = m_contactsRejected;
+    for (auto it = errors.begin(); it != errors.end(); ++it) {
+        rejected.insert(m_contactLines.value(it.key()), it.value());
+    }
+    m_contactLines.clear();
+    m_contactsRejected.clear();
+
+    QMessageBox box(QMessageBox::Information, "Contacts imported", QString("Total contacts imported: %1").arg(added), QMessageBox::Ok, this);
+    if (!rejected.isEmpty()) {
+        box.setInformativeText(QString("%1 rows were not imported.").arg(rejected.size()));
+        QStringList details;
+        for (auto it = rejected.begin(); it != rejected.end(); ++it) {
+            details << QString("Line %1: %2").arg(QString::number(it.key()), it.value());
+        }
+        box.setDetailedText(details.join("\n"));
+    }
+    box.exec();
+}
+
+void MainWindow::generateSubaddresses() {
+    if (m_subaddressDialog) {
+        QMessageBox::warning(this, "Generate addresses", "Addresses are already being generated.");
+        return;
+    }
+
+    const QString labelsFile = QFileDialog::getOpenFileName(this, "Open labels file", QDir::homePath(), "Text files (*.txt *.csv);;All files (*)");
+    if (labelsFile.isEmpty()) return;
+
+    QFile file(labelsFile);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, "Generate addresses", QString("Unable to open file: %1").arg(file.errorString()));
+        return;
+    }
+
+    // One label per line, empty lines get an address without a label
+    QStringList labels;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        labels.append(in.readLine().trimmed());
+    }
+    file.close();
+
+    while (!labels.isEmpty() && labels.last().isEmpty()) {
+        labels.removeLast();
+    }
+    if (labels.isEmpty()) {
+        QMessageBox::warning(this, "Generate addresses", "File contains no labels");
+        return;
+    }
+
+    quint32 account = m_ctx->wallet->currentSubaddressAccount();
+    auto result = QMessageBox::question(this, "Generate addresses", QString("Generate %1 addresses in account #%2?")
+                                        .arg(QString::number(labels.size()), QString::number(account)));
+    if (result != QMessageBox::Yes) {
+        return;
+    }
+
+    // Waits for any refresh in progress, libwallet can't be interrupted once it started
+    auto *dialog = new QProgressDialog("Waiting for the wallet to finish synchronizing...", QString(), 0, labels.size(), this);
+    dialog->setWindowTitle("Generate addresses");
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setMinimumDuration(0);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+    m_subaddressDialog = dialog;
+    dialog->show();
+
+    m_ctx->wallet->addSubaddressesAsync(account, labels);
+}
+
+void MainWindow::onSubaddressesProgress(int done, int total) {
+    if (m_subaddressDialog) {
+        m_subaddressDialog->setLabelText(QString("Generating addresses (%1 of %2)...").arg(QString::number(done), QString::number(total)));
+        m_subaddressDialog->setValue(done);
+    }
+}
+
+void MainWindow::onSubaddressesAdded(quint32 accountIndex, qint64 first, int count) {
+    if (m_subaddressDialog) {
+        m_subaddressDialog->deleteLater();
+        m_subaddressDialog = nullptr;
+    }
+
+    if (first < 0) {
+        QMessageBox::warning(this, "Generate addresses", QString("Failed to generate addresses: %1").arg(m_ctx->wallet->errorString()));
+        return;
+    }
+    m_ctx->wallet->subaddress()->showAddedRows(accountIndex);
+    m_ctx->storeWallet();
+
+    auto result = QMessageBox::question(this, "Generate addresses", QString("Generated %1 addresses. Export them to a CSV file?")
+                                        .arg(QString::number(count)));
+    if (result == QMessageBox::Yes) {
+        this->exportSubaddresses(first);
+    }
+}
+
+void MainWindow::exportSubaddresses(quint32 first) {
+    quint32 account = m_ctx->wallet->currentSubaddressAccount();
+    QString fn = QFileDialog::getSaveFileName(this, "Save CSV file", QString("%1/monero-addresses_%2.csv").arg(QDir::homePath(), QString::number(account)), "CSV (*.csv)");
+    if (fn.isEmpty()) return;
+    if (!fn.endsWith(".csv"))
+        fn += ".csv";
+
+    QSaveFile file(fn);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, "CSV export", QString("Unable to open file: %1").arg(file.errorString()));
+        return;
+    }
+
+    if (!m_ctx->wallet->subaddress()->exportRows(account, first, &file) || !file.commit()) {
+        QMessageBox::warning(this, "CSV export", QString("Unable to write file: %1").arg(file.errorString()));
+        return;
+    }
+    QMessageBox::information(this, "CSV export", QString("Addresses exported to %1").arg(fn));
 }
 
 void MainWindow::saveGeo() {
@@ -1069,52 +1457,205 @@ void MainWindow::showWSNodeExhaustedMessage() {
     QMessageBox::warning(this, "Could not connect to a node", msg);
 }
 
+bool MainWindow::showImportExportProgress(const QString &title) {
+    if (m_importExportDialog) {
+        QMessageBox::warning(this, title, "Another import or export is in progress.");
+        return false;
+    }
+
+    auto *dialog = new QProgressDialog("Waiting for the wallet to finish synchronizing...", "Cancel", 0, 0, this);
+    dialog->setWindowTitle(title);
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setMinimumDuration(0);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+    // The dialog stays up until the wallet reports back, unless the task could be cancelled before it started
+    disconnect(dialog, &QProgressDialog::canceled, dialog, &QProgressDialog::cancel);
+    connect(dialog, &QProgressDialog::canceled, [this, dialog]{
+        if (m_ctx->wallet->cancelImportExport()) {
+            dialog->hide();
+        } else {
+            dialog->setLabelText("Already in progress, please wait...");
+            dialog->show();
+        }
+    });
+
+    m_importExportDialog = dialog;
+    dialog->show();
+    return true;
+}
+
+void MainWindow::onImportExportStarted(Wallet::ImportExport type) {
+    if (!m_importExportDialog) {
+        return;
+    }
+
+    // libwallet can't be interrupted once it started
+    m_importExportDialog->setCancelButtonText(QString());
+    switch (type) {
+        case Wallet::ExportKeyImages:
+            m_importExportDialog->setLabelText("Exporting key images...");
+            break;
+        case Wallet::ImportKeyImages:
+            m_importExportDialog->setLabelText("Importing key images...");
+            break;
+        case Wallet::ExportOutputs:
+            m_importExportDialog->setLabelText("Exporting outputs...");
+            break;
+        case Wallet::ImportOutputs:
+            m_importExportDialog->setLabelText("Importing outputs...");
+            break;
+        case Wallet::ExportSyncBundle:
+            m_importExportDialog->setLabelText("Exporting sync bundle...");
+            break;
+        case Wallet::ImportSyncBundle:
+            m_importExportDialog->setLabelText("Importing sync bundle...");
+            break;
+    }
+}
+
+void MainWindow::onImportExportFinished(Wallet::ImportExport type, bool success, bool cancelled, const QString &errorString) {
+    if (m_importExportDialog) {
+        m_importExportDialog->deleteLater();
+        m_importExportDialog = nullptr;
+    }
+
+    if (cancelled) {
+        return;
+    }
+
+    switch (type) {
+        case Wallet::ExportKeyImages:
+            if (!success) {
+                QMessageBox::warning(this, "Key image export", QString("Failed to export key images.\nReason: %1").arg(errorString));
+            } else {
+                QMessageBox::information(this, "Key image export", "Successfully exported key images.");
+            }
+            break;
+        case Wallet::ImportKeyImages:
+            if (!success) {
+                QMessageBox::warning(this, "Key image import", QString("Failed to import key images.\n\n%1").arg(errorString));
+            } else {
+                QMessageBox::information(this, "Key image import", "Successfully imported key images");
+                m_ctx->refreshModels();
+            }
+            break;
+        case Wallet::ExportOutputs:
+            if (!success) {
+                QMessageBox::warning(this, "Outputs export", QString("Failed to export outputs.\nReason: %1").arg(errorString));
+            } else {
+                QMessageBox::information(this, "Outputs export", "Successfully exported outputs.");
+            }
+            break;
+        case Wallet::ImportOutputs:
+            if (!success) {
+                QMessageBox::warning(this, "Outputs import", QString("Failed to import outputs.\n\n%1").arg(errorString));
+            } else {
+                QMessageBox::information(this, "Outputs import", "Successfully imported outputs");
+                m_ctx->refreshModels();
+            }
+            break;
+        case Wallet::ExportSyncBundle: {
+            if (!success) {
+                QMessageBox::warning(this, "Sync bundle export", QString("Failed to export sync bundle.\nReason: %1").arg(errorString));
+                break;
+            }
+            QByteArray bundle = m_ctx->wallet->syncBundle();
+            if (m_syncBundleMedium == Clipboard) {
+                Utils::copyToClipboard(SyncBundle::toText(bundle));
+                QMessageBox::information(this, "Sync bundle export", "Sync bundle copied to clipboard.");
+                break;
+            }
+            if (m_syncBundleMedium == AnimatedQrCode) {
+                QrCodeDialog dialog{this, bundle, "Sync bundle"};
+                dialog.exec();
+                break;
+            }
+            QFile file(m_syncBundlePath);
+            if (!file.open(QIODevice::WriteOnly) || file.write(bundle) != bundle.size()) {
+                QMessageBox::warning(this, "Sync bundle export", QString("Failed to write sync bundle to %1").arg(m_syncBundlePath));
+                break;
+            }
+            QMessageBox::information(this, "Sync bundle export", "Successfully exported sync bundle.");
+            break;
+        }
+        case Wallet::ImportSyncBundle:
+            if (!success) {
+                QMessageBox::warning(this, "Sync bundle import", QString("Failed to import sync bundle.\n\n%1").arg(errorString));
+            } else {
+                QMessageBox::information(this, "Sync bundle import", "Successfully imported sync bundle");
+                m_ctx->refreshModels();
+            }
+            break;
+    }
+}
+
 void MainWindow::exportKeyImages() {
     QString fn = QFileDialog::getSaveFileName(this, "Save key images to file", QString("%1/%2_%3").arg(QDir::homePath(), this->walletName(), QString::number(QDateTime::currentSecsSinceEpoch())), "Key Images (*_keyImages)");
     if (fn.isEmpty()) return;
     if (!fn.endsWith("_keyImages")) fn += "_keyImages";
-    bool r = m_ctx->wallet->exportKeyImages(fn, true);
-    if (!r) {
-        QMessageBox::warning(this, "Key image export", QString("Failed to export key images.\nReason: %1").arg(m_ctx->wallet->errorString()));
-    } else {
-        QMessageBox::information(this, "Key image export", "Successfully exported key images.");
-    }
+    if (!this->showImportExportProgress("Key image export")) return;
+    m_ctx->wallet->exportKeyImagesAsync(fn, true);
 }
 
 void MainWindow::importKeyImages() {
     QString fn = QFileDialog::getOpenFileName(this, "Import key image file", QDir::homePath(), "Key Images (*_keyImages)");
     if (fn.isEmpty()) return;
-    bool r = m_ctx->wallet->importKeyImages(fn);
-    if (!r) {
-        QMessageBox::warning(this, "Key image import", QString("Failed to import key images.\n\n%1").arg(m_ctx->wallet->errorString()));
-    } else {
-        QMessageBox::information(this, "Key image import", "Successfully imported key images");
-        m_ctx->refreshModels();
-    }
+    if (!this->showImportExportProgress("Key image import")) return;
+    m_ctx->wallet->importKeyImagesAsync(fn);
 }
 
 void MainWindow::exportOutputs() {
     QString fn = QFileDialog::getSaveFileName(this, "Save outputs to file", QString("%1/%2_%3").arg(QDir::homePath(), this->walletName(), QString::number(QDateTime::currentSecsSinceEpoch())), "Outputs (*_outputs)");
     if (fn.isEmpty()) return;
     if (!fn.endsWith("_outputs")) fn += "_outputs";
-    bool r = m_ctx->wallet->exportOutputs(fn, true);
-    if (!r) {
-        QMessageBox::warning(this, "Outputs export", QString("Failed to export outputs.\nReason: %1").arg(m_ctx->wallet->errorString()));
-    } else {
-        QMessageBox::information(this, "Outputs export", "Successfully exported outputs.");
-    }
+    if (!this->showImportExportProgress("Outputs export")) return;
+    m_ctx->wallet->exportOutputsAsync(fn, true);
 }
 
 void MainWindow::importOutputs() {
     QString fn = QFileDialog::getOpenFileName(this, "Import outputs file", QDir::homePath(), "Outputs (*_outputs)");
     if (fn.isEmpty()) return;
-    bool r = m_ctx->wallet->importOutputs(fn);
-    if (!r) {
-        QMessageBox::warning(this, "Outputs import", QString("Failed to import outputs.\n\n%1").arg(m_ctx->wallet->errorString()));
+    if (!this->showImportExportProgress("Outputs import")) return;
+    m_ctx->wallet->importOutputsAsync(fn);
+}
+
+void MainWindow::exportSyncBundle(TransferMedium medium) {
+    m_syncBundleMedium = medium;
+    m_syncBundlePath.clear();
+    if (medium == File) {
+        QString fn = QFileDialog::getSaveFileName(this, "Save sync bundle to file", QString("%1/%2_%3").arg(QDir::homePath(), this->walletName(), QString::number(QDateTime::currentSecsSinceEpoch())), "Sync bundle (*_syncBundle)");
+        if (fn.isEmpty()) return;
+        if (!fn.endsWith("_syncBundle")) fn += "_syncBundle";
+        m_syncBundlePath = fn;
+    }
+    if (!this->showImportExportProgress("Sync bundle export")) return;
+    m_ctx->wallet->exportSyncBundleAsync();
+}
+
+void MainWindow::importSyncBundle(TransferMedium medium) {
+    QByteArray data;
+    if (medium == Clipboard) {
+        data = SyncBundle::fromText(Utils::copyFromClipboard());
+        if (data.isEmpty()) {
+            QMessageBox::warning(this, "Sync bundle import", "Clipboard does not contain a sync bundle.");
+            return;
+        }
+    } else if (medium == AnimatedQrCode) {
+        data = this->scanAnimatedQrCode("Sync bundle import");
+        if (data.isEmpty()) return;
     } else {
-        QMessageBox::information(this, "Outputs import", "Successfully imported outputs");
-        m_ctx->refreshModels();
+        QString fn = QFileDialog::getOpenFileName(this, "Import sync bundle file", QDir::homePath(), "Sync bundle (*_syncBundle)");
+        if (fn.isEmpty()) return;
+        QFile file(fn);
+        if (!file.open(QIODevice::ReadOnly)) {
+            QMessageBox::warning(this, "Sync bundle import", QString("Unable to open %1").arg(fn));
+            return;
+        }
+        data = file.readAll();
     }
+    if (!this->showImportExportProgress("Sync bundle import")) return;
+    m_ctx->wallet->importSyncBundleAsync(data);
 }
 
 void MainWindow::loadUnsignedTx() {
@@ -1146,6 +1687,19 @@ void MainWindow::loadUnsignedTxFromClipboard() {
     this->createUnsignedTxDialog(tx);
 }
 
+void MainWindow::loadUnsignedTxFromQrCode() {
+    QByteArray unsigned_tx = this->scanAnimatedQrCode("Load unsigned transaction from QR code");
+    if (unsigned_tx.isEmpty()) return;
+    UnsignedTransaction *tx = m_ctx->wallet->loadTxFromBase64Str(QString::fromLatin1(unsigned_tx.toBase64()));
+    auto err = m_ctx->wallet->errorString();
+    if (!err.isEmpty()) {
+        QMessageBox::warning(this, "Load unsigned transaction from QR code", QString("Failed to load transaction.\n\n%1").arg(err));
+        return;
+    }
+
+    this->createUnsignedTxDialog(tx);
+}
+
 void MainWindow::loadSignedTx() {
     QString fn = QFileDialog::getOpenFileName(this, "Select transaction to load", QDir::homePath(), "Transaction (*signed_monero_tx)");
     if (fn.isEmpty()) return;
@@ -1166,6 +1720,32 @@ void MainWindow::loadSignedTxFromText() {
     dialog.exec();
 }
 
+void MainWindow::loadSignedTxFromQrCode() {
+    QByteArray signed_tx = this->scanAnimatedQrCode("Broadcast transaction from QR code");
+    if (signed_tx.isEmpty()) return;
+    TxBroadcastDialog dialog{this, m_ctx, QString::fromLatin1(signed_tx.toHex())};
+    dialog.exec();
+}
+
+QByteArray MainWindow::scanAnimatedQrCode(const QString &title) {
+#ifdef WITH_SCANNER
+    if (QCameraInfo::availableCameras().isEmpty()) {
+        QMessageBox::warning(this, title, "No available cameras found.");
+        return {};
+    }
+
+    QrCodeScanDialog dialog{this, true};
+    dialog.setWindowTitle(title);
+    if (dialog.exec() != QDialog::Accepted) {
+        return {};
+    }
+    return dialog.decodedData;
+#else
+    QMessageBox::warning(this, title, "Feather was built without webcam QR scanner support.");
+    return {};
+#endif
+}
+
 void MainWindow::createUnsignedTxDialog(UnsignedTransaction *tx) {
     TxConfAdvDialog dialog{m_ctx, "", this};
     dialog.setUnsignedTransaction(tx);
@@ -1443,14 +2023,15 @@ void MainWindow::onKeysCorrupted() {
     if (!m_criticalWarningShown) {
         m_criticalWarningShown = true;
         QMessageBox::warning(this, "Critical error", "WARNING!\n\nThe wallet keys are corrupted.\n\nTo prevent LOSS OF FUNDS do NOT continue to use this wallet file.\n\nRestore your wallet from seed.\n\nPlease report this incident to the Feather developers.\n\nWARNING!");
-        m_sendWidget->disableSendButton();
+        if (m_sendWidget) {
+            m_sendWidget->disableSendButton();
+        }
     }
 }
 
 void MainWindow::onSelectedInputsChanged(const QStringList &selectedInputs) {
     int numInputs = selectedInputs.size();
 
-    ui->frame_coinControl->setStyleSheet(ColorScheme::GREEN.asStylesheet(true));
     ui->frame_coinControl->setVisible(numInputs > 0);
 
     if (numInputs > 0) {
@@ -1542,7 +2123,7 @@ void MainWindow::updateTitle() {
     if (m_ctx->wallet->viewOnly())
         title += " [view-only]";
 #ifdef HAS_XMRIG
-    if (m_xmrig->isMining())
+    if (m_xmrig && m_xmrig->isMining())
         title += " [mining]";
 #endif
 
@@ -1630,14 +2211,6 @@ bool MainWindow::verifyPassword(bool sensitive) {
     return true;
 }
 
-void MainWindow::patchStylesheetMac() {
-    auto patch = Utils::fileOpenQRC(":assets/macStylesheet.patch");
-    auto patch_text = Utils::barrayToString(patch);
-
-    QString styleSheet = qApp->styleSheet() + patch_text;
-    qApp->setStyleSheet(styleSheet);
-}
-
 void MainWindow::userActivity() {
     m_userLastActive = QDateTime::currentSecsSinceEpoch();
 }
@@ -1683,20 +2256,24 @@ void MainWindow::checkUserActivity() {
 void MainWindow::toggleSearchbar(bool visible) {
     config()->set(Config::showSearchbar, visible);
 
-    m_historyWidget->setSearchbarVisible(visible);
-    m_receiveWidget->setSearchbarVisible(visible);
-    m_contactsWidget->setSearchbarVisible(visible);
-    m_coinsWidget->setSearchbarVisible(visible);
+    if (m_historyWidget)
+        m_historyWidget->setSearchbarVisible(visible);
+    if (m_receiveWidget)
+        m_receiveWidget->setSearchbarVisible(visible);
+    if (m_contactsWidget)
+        m_contactsWidget->setSearchbarVisible(visible);
+    if (m_coinsWidget)
+        m_coinsWidget->setSearchbarVisible(visible);
 
     int currentTab = ui->tabWidget->currentIndex();
     if (currentTab == Tabs::HISTORY)
-        m_historyWidget->focusSearchbar();
+        this->historyWidget()->focusSearchbar();
     else if (currentTab == Tabs::SEND)
-        m_contactsWidget->focusSearchbar();
+        this->contactsWidget()->focusSearchbar();
     else if (currentTab == Tabs::RECEIVE)
-        m_receiveWidget->focusSearchbar();
+        this->receiveWidget()->focusSearchbar();
     else if (currentTab == Tabs::COINS)
-        m_coinsWidget->focusSearchbar();
+        this->coinsWidget()->focusSearchbar();
 }
 
 MainWindow::~MainWindow() = default;
\ No newline at end of file
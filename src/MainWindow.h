@@ -7,6 +7,7 @@
 #include <QMainWindow>
 #include <QSystemTrayIcon>
 #include <QMenu>
+#include <QProgressDialog>
 
 #include "appcontext.h"
 #include "components.h"
@@ -22,6 +23,7 @@
 #include "dialog/AboutDialog.h"
 #include "dialog/SplashDialog.h"
 #include "libwalletqt/Wallet.h"
+#include "model/AddressBookModel.h"
 #include "model/SubaddressModel.h"
 #include "model/SubaddressProxyModel.h"
 #include "model/TransactionHistoryModel.h"
@@ -30,8 +32,10 @@
 #include "utils/networking.h"
 #include "utils/config.h"
 #include "utils/EventFilter.h"
+#include "widgets/BountiesWidget.h"
 #include "widgets/CCSWidget.h"
 #include "widgets/RedditWidget.h"
+#include "widgets/RevuoWidget.h"
 #include "widgets/TickerWidget.h"
 #include "wizard/WalletWizard.h"
 
@@ -96,6 +100,12 @@ public:
         REVUO
     };
 
+    enum TransferMedium {
+        File = 0,
+        Clipboard,
+        AnimatedQrCode
+    };
+
     void showOrHide();
     void bringToFront();
 
@@ -128,10 +138,20 @@ private slots:
     void importKeyImages();
     void exportOutputs();
     void importOutputs();
+    void exportSyncBundle(TransferMedium medium);
+    void importSyncBundle(TransferMedium medium);
     void loadUnsignedTx();
     void loadUnsignedTxFromClipboard();
+    void loadUnsignedTxFromQrCode();
     void loadSignedTx();
     void loadSignedTxFromText();
+    void loadSignedTxFromQrCode();
+    void onImportExportStarted(Wallet::ImportExport type);
+    void onImportExportFinished(Wallet::ImportExport type, bool success, bool cancelled, const QString &errorString);
+    void onSubaddressesProgress(int done, int total);
+    void onSubaddressesAdded(quint32 accountIndex, qint64 first, int count);
+    void onContactsProgress(int done, int total);
+    void onContactsAdded(int added, const QMap<int, QString> &errors);
 
     void onTorConnectionStateChanged(bool connected);
     void onCheckUpdatesComplete(const QString &version, const QString &binaryFilename, const QString &hash, const QString &signer);
@@ -164,6 +184,8 @@ private slots:
     void donateButtonClicked();
     void showCalcWindow();
     void payToMany();
+    void showPayoutDialog();
+    void showConsolidationDialog();
     void showSendTab();
     void showHistoryTab();
     void showSendScreen(const CCSEntry &entry);
@@ -173,6 +195,9 @@ private slots:
     void onViewOnBlockExplorer(const QString &txid);
     void onResendTransaction(const QString &txid);
     void importContacts();
+    void onContactsParsed(const QVector<AddressBookModel::CsvRow> &rows);
+    void generateSubaddresses();
+    void exportSubaddresses(quint32 first);
     void importTransaction();
     void onDeviceError(const QString &error);
     void onDeviceButtonRequest(quint64 code);
@@ -183,6 +208,8 @@ private slots:
     void toggleSearchbar(bool enabled);
     void tryStoreWallet();
     void onWebsocketStatusChanged(bool enabled);
+    void onTabChanged(int index);
+    void onHomeTabChanged(int index);
 
 private:
     friend WindowManager;
@@ -192,6 +219,25 @@ private:
     void initMenu();
     void initHome();
     void initWalletContext();
+    bool showImportExportProgress(const QString &title);
+    QByteArray scanAnimatedQrCode(const QString &title);
+
+    // Tab widgets are created on first use
+    HistoryWidget* historyWidget();
+    SendWidget* sendWidget();
+    ContactsWidget* contactsWidget();
+    ReceiveWidget* receiveWidget();
+    CoinsWidget* coinsWidget();
+    CCSWidget* ccsWidget();
+    BountiesWidget* bountiesWidget();
+    RedditWidget* redditWidget();
+    RevuoWidget* revuoWidget();
+#ifdef HAS_LOCALMONERO
+    LocalMoneroWidget* localMoneroWidget();
+#endif
+#ifdef HAS_XMRIG
+    XMRigWidget* xmrigWidget();
+#endif
 
     void closeEvent(QCloseEvent *event) override;
 
@@ -216,7 +262,6 @@ private:
     void updateRecentlyOpenedMenu();
     void updateWidgetIcons();
     bool verifyPassword(bool senstive = true);
-    void patchStylesheetMac();
     void fillSendTab(const QString &address, const QString &description);
     void userActivity();
     void checkUserActivity();
@@ -242,11 +287,22 @@ private:
 #ifdef HAS_LOCALMONERO
     LocalMoneroWidget *m_localMoneroWidget = nullptr;
 #endif
+    CCSWidget *m_ccsWidget = nullptr;
+    BountiesWidget *m_bountiesWidget = nullptr;
+    RedditWidget *m_redditWidget = nullptr;
+    RevuoWidget *m_revuoWidget = nullptr;
 
     QList<TickerWidgetBase*> m_tickerWidgets;
     BalanceTickerWidget *m_balanceTickerWidget;
 
     QPointer<QAction> m_clearRecentlyOpenAction;
+    QPointer<QProgressDialog> m_importExportDialog;
+    QPointer<QProgressDialog> m_subaddressDialog;
+    QPointer<QProgressDialog> m_contactsDialog;
+    QVector<int> m_contactLines;              // file line of each row handed to the wallet
+    QMap<int, QString> m_contactsRejected;    // by file line
+    TransferMedium m_syncBundleMedium = File;
+    QString m_syncBundlePath;
 
     // lower status bar
     QPushButton *m_statusUpdateAvailable;
@@ -272,6 +328,7 @@ private:
     bool m_constructingTransaction = false;
     bool m_statusOverrideActive = false;
     bool m_showDeviceError = false;
+    bool m_websocketEnabled = true;
     QTimer m_txTimer;
 
     bool cleanedUp = false;
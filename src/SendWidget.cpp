@@ -43,6 +43,15 @@ SendWidget::SendWidget(QSharedPointer<AppContext> ctx, QWidget *parent)
     connect(ui->lineAddress, &QPlainTextEdit::textChanged, this, &SendWidget::addressEdited);
     connect(ui->btn_openAlias, &QPushButton::clicked, this, &SendWidget::aliasClicked);
     connect(ui->lineAddress, &PayToEdit::dataPasted, this, &SendWidget::onDataPasted);
+
+    // Construct the transaction once the form stops changing, see AppContext::prepareTransaction
+    m_prepareTimer.setSingleShot(true);
+    m_prepareTimer.setInterval(1000);
+    connect(&m_prepareTimer, &QTimer::timeout, this, &SendWidget::prepareTransaction);
+    connect(ui->lineAmount, &QLineEdit::textChanged, [this]{ m_prepareTimer.start(); });
+    connect(ui->lineAddress, &QPlainTextEdit::textChanged, [this]{ m_prepareTimer.start(); });
+    connect(ui->comboCurrencySelection, QOverload<int>::of(&QComboBox::currentIndexChanged), [this]{ m_prepareTimer.start(); });
+    connect(m_ctx.get(), &AppContext::selectedInputsChanged, [this]{ m_prepareTimer.start(); });
     ui->label_conversionAmount->setText("");
     ui->label_conversionAmount->hide();
     ui->btn_openAlias->hide();
@@ -196,6 +205,47 @@ void SendWidget::sendClicked() {
     m_ctx->onCreateTransaction(recipient, amount, description, sendAll);
 }
 
+void SendWidget::prepareTransaction() {
+    // Same checks as sendClicked(), anything that would be rejected there is not prepared
+    if (!m_ctx->wallet->isConnected() || !m_ctx->wallet->isSynchronized()) {
+        return;
+    }
+
+    QVector<PartialTxOutput> outputs = ui->lineAddress->getOutputs();
+    if (!outputs.empty()) {
+        if (!ui->lineAddress->getErrors().empty() || outputs.size() > 16) {
+            return;
+        }
+
+        QVector<QString> addresses;
+        QVector<quint64> amounts;
+        for (auto &output : outputs) {
+            addresses.push_back(output.address);
+            amounts.push_back(output.amount);
+        }
+
+        m_ctx->prepareTransaction(addresses, amounts, false);
+        return;
+    }
+
+    QString recipient = ui->lineAddress->text().simplified().remove(' ');
+    if (!WalletManager::addressValid(recipient, constants::networkType)) {
+        return;
+    }
+
+    bool sendAll = (ui->lineAmount->text() == "all");
+    quint64 amount = this->amount();
+    if (ui->comboCurrencySelection->currentText() != "XMR" && !sendAll) {
+        amount = WalletManager::amountFromDouble(this->conversionAmount());
+    }
+
+    if (amount == 0 && !sendAll) {
+        return;
+    }
+
+    m_ctx->prepareTransaction({recipient}, {amount}, sendAll);
+}
+
 void SendWidget::aliasClicked() {
     ui->btn_openAlias->setEnabled(false);
     auto alias = ui->lineAddress->text();
@@ -206,6 +256,8 @@ void SendWidget::clearClicked() {
     ui->lineAddress->clear();
     ui->lineAmount->clear();
     ui->lineDescription->clear();
+    m_prepareTimer.stop();
+    m_ctx->discardPreparedTransaction();
 }
 
 void SendWidget::btnMaxClicked() {
@@ -296,6 +348,8 @@ void SendWidget::clearFields() {
     ui->lineAmount->clear();
     ui->lineDescription->clear();
     ui->label_conversionAmount->clear();
+    m_prepareTimer.stop();
+    m_ctx->discardPreparedTransaction();
 }
 
 void SendWidget::payToMany() {
@@ -4,6 +4,7 @@
 #ifndef FEATHER_SENDWIDGET_H
 #define FEATHER_SENDWIDGET_H
 
+#include <QTimer>
 #include <QWidget>
 
 #include "appcontext.h"
@@ -50,6 +51,7 @@ private slots:
 
 private:
     void setupComboBox();
+    void prepareTransaction();
     double amountDouble();
 
     quint64 amount();
@@ -58,6 +60,7 @@ private:
     QScopedPointer<Ui::SendWidget> ui;
     QSharedPointer<AppContext> m_ctx;
     bool m_sendDisabled = false;
+    QTimer m_prepareTimer;
 };
 
 #endif // FEATHER_SENDWIDGET_H
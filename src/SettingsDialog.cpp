@@ -104,6 +104,16 @@ void Settings::setupPrivacyTab() {
         QMessageBox::information(this, "Multibroadcasting", "Multibroadcasting relays outgoing transactions to all nodes in your selected node list. This may improve transaction relay speed and reduces the chance of your transaction failing.");
     });
 
+    // [Prepare transactions while the send form is edited]
+    ui->checkBox_prepareTransactions->setChecked(config()->get(Config::prepareTransactions).toBool());
+    connect(ui->checkBox_prepareTransactions, &QCheckBox::toggled, [](bool toggled){
+        config()->set(Config::prepareTransactions, toggled);
+    });
+    connect(ui->btn_prepareTransactions, &QPushButton::clicked, [this]{
+        QMessageBox::information(this, "Prepare transactions", "Feather starts constructing a transaction in the background once the address and amount on the Send tab stop changing, so the confirmation dialog appears right away when you click Send.\n\n"
+                                                               "Your node sees the decoy requests of a transaction that may never be broadcast.");
+    });
+
     // [Warn before opening external link]
     ui->checkBox_externalLink->setChecked(config()->get(Config::warnOnExternalLink).toBool());
     connect(ui->checkBox_externalLink, &QCheckBox::clicked, this, &Settings::checkboxExternalLinkWarn);
@@ -151,6 +161,12 @@ void Settings::setupPrivacyTab() {
         m_ctx->wallet->setOffline(checked);
         this->enableWebsocket(!checked);
     });
+
+    // [Block cache]
+    ui->checkBox_useBlockCache->setChecked(config()->get(Config::useBlockCache).toBool());
+    connect(ui->checkBox_useBlockCache, &QCheckBox::toggled, [](bool checked){
+        config()->set(Config::useBlockCache, checked);
+    });
 }
 
 void Settings::setupNodeTab() {
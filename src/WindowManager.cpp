@@ -3,9 +3,12 @@
 
 #include "WindowManager.h"
 
+#include <QFileInfo>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QRegularExpression>
 
+#include "config-feather.h"
 #include "constants.h"
 #include "dialog/PasswordDialog.h"
 #include "dialog/SplashDialog.h"
@@ -13,14 +16,24 @@
 #include "utils/NetworkManager.h"
 #include "utils/os/tails.h"
 #include "utils/TorManager.h"
+#include "utils/Trace.h"
 #include "utils/WebsocketNotifier.h"
 
+namespace {
+    // A wallet can be opened by its keys file or its cache file, closing wallets are tracked by keys file
+    QString keysFilePath(const QString &path) {
+        QString keysPath = path.endsWith(".keys") ? path : path + ".keys";
+        return QDir::toNativeSeparators(QFileInfo(keysPath).absoluteFilePath());
+    }
+}
+
 WindowManager::WindowManager(EventFilter *eventFilter)
     : eventFilter(eventFilter)
 {
+    TRACE_SCOPE("WindowManager::WindowManager");
+
     m_walletManager = WalletManager::instance();
     m_splashDialog = new SplashDialog;
-    m_cleanupThread = new QThread();
 
     connect(m_walletManager, &WalletManager::walletOpened,        this, &WindowManager::onWalletOpened);
     connect(m_walletManager, &WalletManager::walletCreated,       this, &WindowManager::onWalletCreated);
@@ -51,8 +64,9 @@ WindowManager::WindowManager(EventFilter *eventFilter)
 
 WindowManager::~WindowManager() {
     qDebug() << "~WindowManager";
-    m_cleanupThread->quit();
-    m_cleanupThread->wait();
+    for (const auto &thread : m_closingWallets.keys()) {
+        thread->wait();
+    }
 }
 
 // ######################## APPLICATION LIFECYCLE ########################
@@ -67,24 +81,82 @@ void WindowManager::quitAfterLastWindow() {
 }
 
 void WindowManager::close() {
+    if (m_quitting) {
+        return;
+    }
+    m_quitting = true;
+
     qDebug() << Q_FUNC_INFO;
-    for (const auto &window: m_windows) {
+    const auto windows = m_windows;
+    for (const auto &window: windows) {
         window->close();
     }
 
     torManager()->stop();
     m_tray->hide();
 
+    if (!m_closingWallets.isEmpty()) {
+        // Quit once the last wallet is stored, see onWalletClosed()
+        this->updateClosingProgress();
+        return;
+    }
+
     QApplication::quit();
 }
 
 void WindowManager::closeWindow(MainWindow *window) {
     m_windows.removeOne(window);
+    this->closeWallet(window->m_ctx->wallet, window->walletKeysPath());
+}
+
+void WindowManager::closeWallet(Wallet *wallet, const QString &keysPath) {
+    // ~Wallet stores the wallet cache, which can take a while for large wallets.
+    // Each wallet gets its own thread so it doesn't block the GUI thread and multiple wallets close in parallel.
+    auto thread = new QThread();
+    m_closingWallets.insert(thread, keysFilePath(keysPath));
+
+    wallet->moveToThread(thread);
+    connect(wallet, &QObject::destroyed, thread, &QThread::quit, Qt::DirectConnection);
+    connect(thread, &QThread::finished, this, [this, thread]{
+        this->onWalletClosed(thread);
+    });
+    thread->start();
+    wallet->deleteLater();
 
-    // Move Wallet to a different thread for cleanup so it doesn't block GUI thread
-    window->m_ctx->wallet->moveToThread(m_cleanupThread);
-    m_cleanupThread->start();
-    window->m_ctx->wallet->deleteLater();
+    qDebug() << "Closing wallet:" << keysPath;
+    this->updateClosingProgress();
+}
+
+void WindowManager::onWalletClosed(QThread *thread) {
+    QString keysPath = m_closingWallets.take(thread);
+    thread->deleteLater();
+    qDebug() << "Wallet closed:" << keysPath;
+
+    if (!m_pendingOpenWallet.first.isEmpty() && !m_closingWallets.values().contains(m_pendingOpenWallet.first)) {
+        auto pending = m_pendingOpenWallet;
+        m_pendingOpenWallet = {};
+        m_openingWallet = false;
+        this->tryOpenWallet(pending.first, pending.second);
+    }
+
+    this->updateClosingProgress();
+
+    if (m_quitting && m_closingWallets.isEmpty()) {
+        QApplication::quit();
+    }
+}
+
+void WindowManager::updateClosingProgress() {
+    // Only show progress when something is waiting on the wallets to finish closing
+    if (m_closingWallets.isEmpty() || (!m_quitting && m_pendingOpenWallet.first.isEmpty())) {
+        m_splashDialog->hide();
+        return;
+    }
+
+    int count = m_closingWallets.count();
+    m_splashDialog->setMessage(QString("Saving and closing %1 wallet%2...").arg(QString::number(count), count == 1 ? "" : "s"));
+    m_splashDialog->show();
+    m_splashDialog->setEnabled(true);
 }
 
 void WindowManager::restartApplication(const QString &binaryFilename) {
@@ -155,11 +227,21 @@ void WindowManager::tryOpenWallet(const QString &path, const QString &password)
         return;
     }
 
+    // The wallet is still being stored after its window was closed, open it when that is done
+    if (m_closingWallets.values().contains(keysFilePath(absolutePath))) {
+        m_pendingOpenWallet = {keysFilePath(absolutePath), password};
+        m_openingWallet = true;
+        this->updateClosingProgress();
+        return;
+    }
+
     m_openingWallet = true;
+    TRACE_BEGIN("Wallet open");
     m_walletManager->openWalletAsync(path, password, constants::networkType, constants::kdfRounds, Utils::ringDatabasePath());
 }
 
 void WindowManager::onWalletOpened(Wallet *wallet) {
+    TRACE_END("Wallet open");
     auto status = wallet->status();
     if (status != Wallet::Status_Ok) {
         QString errMsg = wallet->errorString();
@@ -580,22 +662,55 @@ void WindowManager::wizardOpenWallet() {
 // ######################## SKINS ########################
 
 void WindowManager::initSkins() {
-    m_skins.insert("Native", "");
+    TRACE_SCOPE("WindowManager::initSkins");
+
+    // Stylesheets are loaded on first use, see skin()
+    m_skinResources.insert("Native", "");
+    m_skinResources.insert("QDarkStyle", ":qdarkstyle/style.qss");
+    m_skinResources.insert("Breeze/Dark", ":/dark.qss");
+    m_skinResources.insert("Breeze/Light", ":/light.qss");
+
+    QString skinName = config()->get(Config::skin).toString();
+    if (!m_skinResources.contains(skinName)) {
+        skinName = "Native";
+    }
+
+    m_currentSkin = skinName;
+    qApp->setStyleSheet(this->skin(skinName));
+}
+
+QString WindowManager::skin(const QString &skinName) {
+    if (m_skins.contains(skinName)) {
+        return m_skins[skinName];
+    }
+
+    // Processed stylesheets are cached on disk, keyed by version
+    QString cacheName = QString(skinName).replace("/", "_");
+    QString cachePath = Config::defaultConfigDir().filePath(QString("cache/skins/%1-%2/%3.qss").arg(FEATHER_VERSION, FEATHER_COMMIT, cacheName));
+
+    QString stylesheet;
+    if (Utils::fileExists(cachePath)) {
+        stylesheet = Utils::barrayToString(Utils::fileOpen(cachePath));
+    }
+    else {
+        QString resource = m_skinResources.value(skinName);
+        if (!resource.isEmpty()) {
+            stylesheet = this->loadStylesheet(resource);
+        }
 
-    QString qdarkstyle = this->loadStylesheet(":qdarkstyle/style.qss");
-    if (!qdarkstyle.isEmpty())
-        m_skins.insert("QDarkStyle", qdarkstyle);
+#if defined(Q_OS_MACOS)
+        stylesheet += Utils::barrayToString(Utils::fileOpenQRC(":assets/macStylesheet.patch"));
+#endif
 
-    QString breeze_dark = this->loadStylesheet(":/dark.qss");
-    if (!breeze_dark.isEmpty())
-        m_skins.insert("Breeze/Dark", breeze_dark);
+        stylesheet = this->processStylesheet(stylesheet);
 
-    QString breeze_light = this->loadStylesheet(":/light.qss");
-    if (!breeze_light.isEmpty())
-        m_skins.insert("Breeze/Light", breeze_light);
+        if (!stylesheet.isEmpty() && QDir().mkpath(QFileInfo(cachePath).path())) {
+            Utils::fileWrite(cachePath, stylesheet);
+        }
+    }
 
-    QString skin = config()->get(Config::skin).toString();
-    qApp->setStyleSheet(m_skins[skin]);
+    m_skins[skinName] = stylesheet;
+    return stylesheet;
 }
 
 QString WindowManager::loadStylesheet(const QString &resource) {
@@ -614,13 +729,35 @@ QString WindowManager::loadStylesheet(const QString &resource) {
     return data;
 }
 
+QString WindowManager::processStylesheet(const QString &stylesheet) {
+    // Strip comments and indentation, Qt has less to parse when the stylesheet is applied
+    static const QRegularExpression comments(R"(/\*.*?\*/)", QRegularExpression::DotMatchesEverythingOption);
+
+    QString data = stylesheet;
+    data.remove(comments);
+
+    QStringList lines;
+    for (const auto &line : data.split('\n')) {
+        QString trimmed = line.trimmed();
+        if (!trimmed.isEmpty()) {
+            lines.append(trimmed);
+        }
+    }
+    return lines.join('\n');
+}
+
 void WindowManager::changeSkin(const QString &skinName) {
-    if (!m_skins.contains(skinName)) {
+    if (!m_skinResources.contains(skinName)) {
         qWarning() << QString("No such skin %1").arg(skinName);
         return;
     }
 
     config()->set(Config::skin, skinName);
-    qApp->setStyleSheet(m_skins[skinName]);
+    if (skinName == m_currentSkin) {
+        return;
+    }
+
+    m_currentSkin = skinName;
+    qApp->setStyleSheet(this->skin(skinName));
     qDebug() << QString("Skin changed to %1").arg(skinName);
 }
@@ -23,6 +23,7 @@ public:
     void wizardOpenWallet();
     void close();
     void closeWindow(MainWindow *window);
+    void closeWallet(Wallet *wallet, const QString &keysPath);
     void showWizard(WalletWizard::Page startPage);
     void changeSkin(const QString &skinName);
     void restartApplication(const QString &binaryFilename);
@@ -48,6 +49,7 @@ private slots:
     void onDeviceButtonPressed();
     void onDeviceError(const QString &errorMessage);
     void onWalletPassphraseNeeded(bool on_device);
+    void onWalletClosed(QThread *thread);
 
 private:
     void tryCreateWallet(Seed seed, const QString &path, const QString &password, const QString &seedLanguage, const QString &seedOffset);
@@ -65,12 +67,15 @@ private:
     void initTor();
     void initWS();
     void initSkins();
+    QString skin(const QString &skinName);
     QString loadStylesheet(const QString &resource);
+    QString processStylesheet(const QString &stylesheet);
     void buildTrayMenu();
     void startupWarning();
     void showWarningMessageBox(const QString &title, const QString &message);
 
     void quitAfterLastWindow();
+    void updateClosingProgress();
 
     QVector<MainWindow*> m_windows;
 
@@ -80,13 +85,18 @@ private:
 
     QSystemTrayIcon *m_tray;
 
+    QMap<QString, QString> m_skinResources;
     QMap<QString, QString> m_skins;
+    QString m_currentSkin;
 
     bool m_openWalletTriedOnce = false;
     bool m_openingWallet = false;
     bool m_initialNetworkConfigured = false;
 
-    QThread *m_cleanupThread;
+    // Wallets that are being stored and freed in the background, by keys path
+    QHash<QThread*, QString> m_closingWallets;
+    QPair<QString, QString> m_pendingOpenWallet;
+    bool m_quitting = false;
 };
 
 
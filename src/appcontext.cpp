@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // SPDX-FileCopyrightText: 2020-2022 The Monero Project
 
+#include <QCryptographicHash>
 #include <QDir>
 
 #include "appcontext.h"
@@ -13,9 +14,26 @@
 #include "model/TransactionHistoryModel.h"
 #include "model/SubaddressModel.h"
 #include "utils/NetworkManager.h"
+#include "utils/Trace.h"
 #include "utils/WebsocketClient.h"
 #include "utils/WebsocketNotifier.h"
 
+// Wallet stores are coalesced: at most one per debounce interval, and no later than the max latency after a change
+constexpr qint64 storeDebounce = 10 * 1000;
+constexpr qint64 storeMaxLatency = 2 * 60 * 1000;
+
+// Prepared transactions are rebuilt after this long, the fee and decoys are picked for the chain at construction time
+constexpr qint64 preparedTxExpiry = 2 * 60 * 1000;
+
+// Stored transactions that still haven't confirmed after this long are given up on
+constexpr qint64 txStoreMaxAge = 14 * 24 * 60 * 60;
+
+// The transaction store is keyed off the secret view key, like the wallet cache
+static QByteArray txStoreKey(Wallet *wallet) {
+    QByteArray viewKey = QByteArray::fromHex(wallet->getSecretViewKey().toLatin1());
+    return QCryptographicHash::hash(viewKey + "feather-tx-store", QCryptographicHash::Sha256);
+}
+
 // This class serves as a business logic layer between MainWindow and libwalletqt.
 // This way we don't clutter the GUI with wallet logic,
 // and keep libwalletqt (mostly) clean of Feather specific implementation details
@@ -25,6 +43,7 @@ AppContext::AppContext(Wallet *wallet)
     , nodes(new Nodes(this, this))
     , networkType(constants::networkType)
     , m_rpc(new DaemonRpc{this, getNetworkTor(), ""})
+    , m_txStore(new TxBlobStore(QString("%1.txs").arg(wallet->cachePath()), txStoreKey(wallet), this))
 {
     connect(this->wallet, &Wallet::moneySpent,               this, &AppContext::onMoneySpent);
     connect(this->wallet, &Wallet::moneyReceived,            this, &AppContext::onMoneyReceived);
@@ -33,8 +52,10 @@ AppContext::AppContext(Wallet *wallet)
     connect(this->wallet, &Wallet::updated,                  this, &AppContext::onWalletUpdate);
     connect(this->wallet, &Wallet::refreshed,                this, &AppContext::onWalletRefreshed);
     connect(this->wallet, &Wallet::transactionCommitted,     this, &AppContext::onTransactionCommitted);
+    connect(this->wallet, &Wallet::stored,                   this, &AppContext::onWalletStored);
     connect(this->wallet, &Wallet::heightRefreshed,          this, &AppContext::onHeightRefreshed);
     connect(this->wallet, &Wallet::transactionCreated,       this, &AppContext::onTransactionCreated);
+    connect(this->wallet, &Wallet::transactionPrepared,      this, &AppContext::onTransactionPrepared);
     connect(this->wallet, &Wallet::deviceError,              this, &AppContext::onDeviceError);
     connect(this->wallet, &Wallet::deviceButtonRequest,      this, &AppContext::onDeviceButtonRequest);
     connect(this->wallet, &Wallet::deviceButtonPressed,      this, &AppContext::onDeviceButtonPressed);
@@ -47,14 +68,15 @@ AppContext::AppContext(Wallet *wallet)
 
     connect(this, &AppContext::createTransactionError, this, &AppContext::onCreateTransactionError);
 
-    // Store the wallet every 2 minutes
-    m_storeTimer.start(2 * 60 * 1000);
-    connect(&m_storeTimer, &QTimer::timeout, [this](){
-        this->storeWallet();
-    });
+    // Store requests are coalesced, see storeWallet()
+    m_storeTimer.setSingleShot(true);
+    connect(&m_storeTimer, &QTimer::timeout, this, &AppContext::onStoreTimeout);
 
     this->updateBalance();
 
+    // The history may be refreshed from the refresh thread
+    connect(this->wallet->history(), &TransactionHistory::refreshFinished, this, &AppContext::pruneTransactionStore, Qt::QueuedConnection);
+
     connect(this->wallet->history(), &TransactionHistory::txNoteChanged, [this]{
         this->wallet->history()->refresh(this->wallet->currentSubaddressAccount());
     });
@@ -80,6 +102,10 @@ void AppContext::onCreateTransaction(const QString &address, quint64 amount, con
         return;
     }
 
+    if (this->takePreparedTransaction({address}, {amount}, all)) {
+        return;
+    }
+
     qInfo() << "Creating transaction";
     if (all)
         this->wallet->createTransactionAllAsync(address, "", constants::mixin, this->tx_priority, m_selectedInputs);
@@ -102,6 +128,10 @@ void AppContext::onCreateTransactionMultiDest(const QVector<QString> &addresses,
         emit createTransactionError("Not enough money to spend");
     }
 
+    if (this->takePreparedTransaction(addresses, amounts, false)) {
+        return;
+    }
+
     qInfo() << "Creating transaction";
     this->wallet->createTransactionMultiDestAsync(addresses, amounts, this->tx_priority, m_selectedInputs);
 
@@ -119,6 +149,114 @@ void AppContext::onSweepOutputs(const QVector<QString> &keyImages, QString addre
     emit initiateTransaction();
 }
 
+void AppContext::prepareTransaction(const QVector<QString> &addresses, const QVector<quint64> &amounts, bool all) {
+    if (!config()->get(Config::prepareTransactions).toBool() || this->wallet->isHwBacked()) {
+        return;
+    }
+
+    if (!this->wallet->isConnected() || !this->wallet->isSynchronized() || m_prepared.claimed) {
+        return;
+    }
+
+    if (this->matchesPreparedTransaction(addresses, amounts, all)) {
+        if (m_prepared.pending || m_prepared.age.elapsed() < preparedTxExpiry) {
+            return;
+        }
+    }
+
+    this->discardPreparedTransaction();
+
+    m_prepared.id = ++m_preparedId;
+    m_prepared.addresses = addresses;
+    m_prepared.amounts = amounts;
+    m_prepared.all = all;
+    m_prepared.account = this->wallet->currentSubaddressAccount();
+    m_prepared.priority = this->tx_priority;
+    m_prepared.inputs = m_selectedInputs;
+    m_prepared.pending = true;
+    m_prepared.age.start();
+
+    qDebug() << "Preparing transaction";
+    this->wallet->prepareTransactionAsync(m_prepared.id, addresses, amounts, all, constants::mixin, this->tx_priority, m_selectedInputs);
+}
+
+void AppContext::discardPreparedTransaction() {
+    if (m_prepared.claimed) {
+        return;
+    }
+
+    // A construction still in progress is disposed when it finishes
+    if (m_prepared.tx) {
+        this->wallet->disposeTransaction(m_prepared.tx);
+    }
+    m_prepared = PreparedTransaction();
+}
+
+void AppContext::onTransactionPrepared(quint64 id, PendingTransaction *tx) {
+    if (id != m_prepared.id) {
+        this->wallet->disposeTransaction(tx);
+        return;
+    }
+
+    m_prepared.pending = false;
+
+    if (m_prepared.claimed) {
+        QVector<QString> addresses = m_prepared.addresses;
+        m_prepared = PreparedTransaction();
+        this->onTransactionCreated(tx, addresses);
+        return;
+    }
+
+    // Leave errors to the real attempt, the form may still change
+    if (tx->status() != PendingTransaction::Status_Ok) {
+        this->wallet->disposeTransaction(tx);
+        m_prepared = PreparedTransaction();
+        return;
+    }
+
+    m_prepared.tx = tx;
+}
+
+bool AppContext::matchesPreparedTransaction(const QVector<QString> &addresses, const QVector<quint64> &amounts, bool all) const {
+    if (!m_prepared.pending && !m_prepared.tx) {
+        return false;
+    }
+
+    return m_prepared.addresses == addresses && m_prepared.amounts == amounts && m_prepared.all == all
+           && m_prepared.account == this->wallet->currentSubaddressAccount()
+           && m_prepared.priority == this->tx_priority
+           && m_prepared.inputs == m_selectedInputs;
+}
+
+bool AppContext::takePreparedTransaction(const QVector<QString> &addresses, const QVector<quint64> &amounts, bool all) {
+    if (!this->matchesPreparedTransaction(addresses, amounts, all)) {
+        this->discardPreparedTransaction();
+        return false;
+    }
+
+    if (m_prepared.pending) {
+        qInfo() << "Waiting for prepared transaction";
+        m_prepared.claimed = true;
+        emit initiateTransaction();
+        return true;
+    }
+
+    if (m_prepared.age.elapsed() >= preparedTxExpiry) {
+        this->discardPreparedTransaction();
+        return false;
+    }
+
+    qInfo() << "Using prepared transaction";
+    PendingTransaction *tx = m_prepared.tx;
+    m_prepared = PreparedTransaction();
+
+    emit initiateTransaction();
+    QMetaObject::invokeMethod(this, [this, tx, addresses]{
+        this->onTransactionCreated(tx, addresses);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
 void AppContext::onCreateTransactionError(const QString &msg) {
     this->tmpTxDescription = "";
     emit endTransaction();
@@ -144,28 +282,77 @@ void AppContext::commitTransaction(PendingTransaction *tx, const QString &descri
 }
 
 void AppContext::onMultiBroadcast(PendingTransaction *tx) {
+    QStringList txData;
     quint64 count = tx->txCount();
     for (quint64 i = 0; i < count; i++) {
-        QString txData = tx->signedTxToHex(i);
+        txData.append(tx->signedTxToHex(i));
+    }
+    this->multiBroadcast(tx->txid(), txData);
+}
 
+void AppContext::multiBroadcast(const QStringList &txids, const QStringList &txData) {
+    for (int i = 0; i < txData.size(); i++) {
         for (const auto& node: this->nodes->nodes()) {
             QString address = node.toURL();
-            qDebug() << QString("Relaying %1 to: %2").arg(tx->txid()[i], address);
+            qDebug() << QString("Relaying %1 to: %2").arg(txids.value(i), address);
             m_rpc->setDaemonAddress(address);
-            m_rpc->sendRawTransaction(txData);
+            m_rpc->sendRawTransaction(txData[i]);
         }
     }
 }
 
 void AppContext::addCacheTransaction(const QString &txid, const QString &txHex) const {
-    this->wallet->setCacheAttribute(QString("tx:%1").arg(txid), txHex);
+    m_txStore->add(txid, txHex);
 }
 
-QString AppContext::getCacheTransaction(const QString &txid) const {
-    QString txHex = this->wallet->getCacheAttribute(QString("tx:%1").arg(txid));
+QString AppContext::getCacheTransaction(const QString &txid) {
+    QString txHex = m_txStore->get(txid);
+    if (!txHex.isEmpty()) {
+        return txHex;
+    }
+
+    // Older versions kept transactions in the wallet cache
+    QString key = QString("tx:%1").arg(txid);
+    txHex = this->wallet->getCacheAttribute(key);
+    if (!txHex.isEmpty() && m_txStore->add(txid, txHex)) {
+        this->wallet->setCacheAttribute(key, "");
+        this->storeWallet();
+    }
     return txHex;
 }
 
+void AppContext::pruneTransactionStore() {
+    QHash<QString, quint64> confirmations = this->wallet->history()->confirmations();
+    quint64 depth = config()->get(Config::txStoreConfirmations).toULongLong();
+
+    // Move transactions out of the wallet cache once, wallet2 can't delete attributes so they are emptied
+    if (!m_txStoreMigrated && !confirmations.isEmpty()) {
+        m_txStoreMigrated = true;
+        int moved = 0;
+        for (auto it = confirmations.begin(); it != confirmations.end(); ++it) {
+            QString key = QString("tx:%1").arg(it.key());
+            QString txHex = this->wallet->getCacheAttribute(key);
+            if (txHex.isEmpty()) {
+                continue;
+            }
+            if (it.value() < depth && !m_txStore->add(it.key(), txHex)) {
+                continue;
+            }
+            this->wallet->setCacheAttribute(key, "");
+            moved++;
+        }
+        if (moved > 0) {
+            qInfo() << "Moved" << moved << "transactions out of the wallet cache";
+            this->storeWallet();
+        }
+    }
+
+    int pruned = m_txStore->prune(confirmations, depth, txStoreMaxAge);
+    if (pruned > 0) {
+        qDebug() << "Pruned" << pruned << "transactions from the transaction store";
+    }
+}
+
 // ################## Device ##################
 
 void AppContext::onDeviceButtonRequest(quint64 code) {
@@ -185,6 +372,7 @@ void AppContext::onDeviceError(const QString &message) {
 
 void AppContext::setSelectedInputs(const QStringList &selectedInputs) {
     m_selectedInputs = selectedInputs;
+    this->discardPreparedTransaction();
     emit selectedInputsChanged(selectedInputs);
 }
 
@@ -208,11 +396,16 @@ void AppContext::stopTimers() {
 void AppContext::onMoneySpent(const QString &txId, quint64 amount) {
     // Outgoing tx included in a block
     qDebug() << Q_FUNC_INFO << txId << " " << WalletManager::displayAmount(amount);
+
+    // The prepared transaction may spend the same outputs
+    this->discardPreparedTransaction();
 }
 
 void AppContext::onMoneyReceived(const QString &txId, quint64 amount) {
     // Incoming tx included in a block.
     qDebug() << Q_FUNC_INFO << txId << " " << WalletManager::displayAmount(amount);
+
+    this->discardPreparedTransaction();
 }
 
 void AppContext::onUnconfirmedMoneyReceived(const QString &txId, quint64 amount) {
@@ -246,7 +439,7 @@ void AppContext::onWalletRefreshed(bool success, const QString &message) {
         this->refreshed = true;
         emit walletRefreshed();
         // store wallet immediately upon finishing synchronization
-        this->wallet->store();
+        this->storeWallet(true);
     }
 }
 
@@ -290,8 +483,10 @@ void AppContext::onTransactionCreated(PendingTransaction *tx, const QVector<QStr
 }
 
 void AppContext::onTransactionCommitted(bool status, PendingTransaction *tx, const QStringList& txid){
+    this->discardPreparedTransaction();
+
     // Store wallet immediately so we don't risk losing tx key if wallet crashes
-    this->wallet->store();
+    this->storeWallet(true);
 
     this->wallet->history()->refresh(this->wallet->currentSubaddressAccount());
     this->wallet->coins()->refresh(this->wallet->currentSubaddressAccount());
@@ -307,13 +502,60 @@ void AppContext::onTransactionCommitted(bool status, PendingTransaction *tx, con
     emit transactionCommitted(status, tx, txid);
 }
 
-void AppContext::storeWallet() {
-    // Do not store a synchronizing wallet: store() is NOT thread safe and may crash the wallet
-    if (!this->wallet->isSynchronized())
+void AppContext::storeWallet(bool immediate) {
+    // Wait for updates to settle, but never leave the wallet dirty for longer than the max latency
+    m_storeDirty = true;
+    if (!m_storeDirtySince.isValid()) {
+        m_storeDirtySince.start();
+    }
+
+    if (immediate) {
+        m_storeImmediate = true;
+        m_storeTimer.start(0);
+        return;
+    }
+
+    if (m_storeImmediate) {
+        return;
+    }
+
+    qint64 remaining = storeMaxLatency - m_storeDirtySince.elapsed();
+    m_storeTimer.start(qBound<qint64>(0, remaining, storeDebounce));
+}
+
+void AppContext::onStoreTimeout() {
+    if (!m_storeDirty || m_storing) {
+        // A store that is in progress picks up new changes when it finishes
+        return;
+    }
+
+    // Stores are serialized with refresh, but don't hold up a worker for the entire initial sync.
+    // The wallet stays dirty and is stored once synchronization finishes.
+    if (!m_storeImmediate && !this->wallet->isSynchronized()) {
         return;
+    }
+
+    m_storeDirty = false;
+    m_storeImmediate = false;
+    m_storeDirtySince.invalidate();
+    m_storing = true;
 
     qDebug() << "Storing wallet";
-    this->wallet->store();
+    this->wallet->storeAsync();
+}
+
+void AppContext::onWalletStored(bool success, qint64 durationMs, qint64 bytesWritten) {
+    m_storing = false;
+
+    if (success) {
+        qDebug() << QString("Wallet stored in %1 ms, %2 bytes written").arg(QString::number(durationMs), QString::number(bytesWritten));
+    } else {
+        qWarning() << "Unable to store wallet:" << this->wallet->errorString();
+    }
+
+    if (m_storeDirty) {
+        m_storeTimer.start(m_storeImmediate ? 0 : storeDebounce);
+    }
 }
 
 void AppContext::updateBalance() {
@@ -334,6 +576,7 @@ void AppContext::syncStatusUpdated(quint64 height, quint64 target) {
 }
 
 void AppContext::refreshModels() {
+    TRACE_SCOPE("AppContext::refreshModels");
     this->wallet->history()->refresh(this->wallet->currentSubaddressAccount());
     this->wallet->coins()->refresh(this->wallet->currentSubaddressAccount());
     bool r = this->wallet->subaddress()->refresh(this->wallet->currentSubaddressAccount());
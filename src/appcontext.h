@@ -4,6 +4,7 @@
 #ifndef FEATHER_APPCONTEXT_H
 #define FEATHER_APPCONTEXT_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QTimer>
 
@@ -13,6 +14,7 @@
 #include "utils/daemonrpc.h"
 #include "utils/RestoreHeightLookup.h"
 #include "utils/nodes.h"
+#include "utils/TxBlobStore.h"
 
 #include "libwalletqt/WalletManager.h"
 #include "PendingTransaction.h"
@@ -38,19 +40,26 @@ public:
     bool refreshed = false;
 
     void commitTransaction(PendingTransaction *tx, const QString &description="");
+    void multiBroadcast(const QStringList &txids, const QStringList &txData);
     void syncStatusUpdated(quint64 height, quint64 target);
     void updateBalance();
     void refreshModels();
 
-    void storeWallet();
+    // Marks the wallet dirty and schedules a store, immediate stores skip the debounce
+    void storeWallet(bool immediate = false);
 
     void stopTimers();
 
+    // Signed transactions are kept in a TxBlobStore next to the wallet, so they can be resent
     void addCacheTransaction(const QString &txid, const QString &txHex) const;
-    QString getCacheTransaction(const QString &txid) const;
+    QString getCacheTransaction(const QString &txid);
 
     void setSelectedInputs(const QStringList &selectedInputs);
 
+    // Starts constructing a transaction in the background, so it is ready by the time the user clicks Send
+    void prepareTransaction(const QVector<QString> &addresses, const QVector<quint64> &amounts, bool all);
+    void discardPreparedTransaction();
+
 public slots:
     void onCreateTransaction(const QString &address, quint64 amount, const QString &description, bool all);
     void onCreateTransactionMultiDest(const QVector<QString> &addresses, const QVector<quint64> &amounts, const QString &description);
@@ -75,6 +84,9 @@ private slots:
     void onHeightRefreshed(quint64 walletHeight, quint64 daemonHeight, quint64 targetHeight);
     void onTransactionCreated(PendingTransaction *tx, const QVector<QString> &address);
     void onTransactionCommitted(bool status, PendingTransaction *t, const QStringList& txid);
+    void onStoreTimeout();
+    void onTransactionPrepared(quint64 id, PendingTransaction *tx);
+    void onWalletStored(bool success, qint64 durationMs, qint64 bytesWritten);
 
 signals:
     void balanceUpdated(quint64 balance, quint64 spendable);
@@ -95,9 +107,35 @@ signals:
     void selectedInputsChanged(const QStringList &selectedInputs);
 
 private:
+    struct PreparedTransaction {
+        quint64 id = 0;
+        QVector<QString> addresses;
+        QVector<quint64> amounts;
+        bool all = false;
+        quint32 account = 0;
+        PendingTransaction::Priority priority = PendingTransaction::Priority_Low;
+        QStringList inputs;
+        PendingTransaction *tx = nullptr;
+        bool pending = false;
+        bool claimed = false; // Send was clicked while it was still being constructed
+        QElapsedTimer age;
+    };
+
+    bool matchesPreparedTransaction(const QVector<QString> &addresses, const QVector<quint64> &amounts, bool all) const;
+    bool takePreparedTransaction(const QVector<QString> &addresses, const QVector<quint64> &amounts, bool all);
+    void pruneTransactionStore();
+
     DaemonRpc *m_rpc;
+    TxBlobStore *m_txStore;
+    bool m_txStoreMigrated = false;
     QTimer m_storeTimer;
+    QElapsedTimer m_storeDirtySince;
+    bool m_storeDirty = false;
+    bool m_storeImmediate = false;
+    bool m_storing = false;
     QStringList m_selectedInputs;
+    PreparedTransaction m_prepared;
+    quint64 m_preparedId = 0;
 };
 
 #endif //FEATHER_APPCONTEXT_H
@@ -12,6 +12,10 @@
 #include "utils/Utils.h"
 #include "constants.h"
 
+#if defined(WITH_SCANNER)
+#include "qrcode_scanner/QrScanBenchmark.h"
+#endif
+
 CLI::CLI(Mode mode, QCommandLineParser *cmdargs, QObject *parent)
     : QObject(parent)
     , m_mode(mode)
@@ -100,6 +104,20 @@ CLI::CLI(Mode mode, QCommandLineParser *cmdargs, QObject *parent)
             }
         }
     }
+    else if (mode == Mode::BenchmarkQrScan)
+    {
+#if defined(WITH_SCANNER)
+        QTimer::singleShot(0, this, [this]{
+            if (m_cmdargs->isSet("benchmark-qr-transport")) {
+                this->finished(QrScanBenchmark::runTransport(m_cmdargs->value("benchmark-qr-transport").toInt()));
+            } else {
+                this->finished(QrScanBenchmark::run(m_cmdargs->value("benchmark-qr-scan")));
+            }
+        });
+#else
+        this->finished("Feather was built without the QR scanner");
+#endif
+    }
     else {
         this->finished("Invalid mode");
     }
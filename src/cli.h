@@ -16,7 +16,8 @@ public:
         Invalid,
         ExportContacts,
         ExportTxHistory,
-        BruteforcePassword
+        BruteforcePassword,
+        BenchmarkQrScan
     };
 
     explicit CLI(Mode mode, QCommandLineParser *cmdargs, QObject *parent = nullptr);
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "ConsolidationDialog.h"
+#include "ui_ConsolidationDialog.h"
+
+#include <QMessageBox>
+
+#include "libwalletqt/WalletManager.h"
+#include "model/ModelUtils.h"
+
+namespace {
+    enum Column {
+        Address = 0,
+        Outputs,
+        Amount,
+        Fee,
+        Status
+    };
+}
+
+ConsolidationDialog::ConsolidationDialog(QWidget *parent, QSharedPointer<AppContext> ctx)
+        : WindowModalDialog(parent)
+        , ui(new Ui::ConsolidationDialog)
+        , m_ctx(std::move(ctx))
+        , m_planner(new ConsolidationPlanner(m_ctx, this))
+{
+    ui->setupUi(this);
+
+    ui->combo_priority->addItem("Low", PendingTransaction::Priority_Low);
+    ui->combo_priority->addItem("Medium", PendingTransaction::Priority_Medium);
+    ui->combo_priority->addItem("High", PendingTransaction::Priority_High);
+
+    ui->tree_sweeps->setHeaderLabels({"Address", "Outputs", "Amount", "Fee", "Status"});
+
+    connect(ui->btn_plan,  &QPushButton::clicked, this, &ConsolidationDialog::onPlan);
+    connect(ui->btn_start, &QPushButton::clicked, this, &ConsolidationDialog::onStart);
+    connect(ui->btn_stop,  &QPushButton::clicked, [this]{
+        m_planner->cancel();
+        this->updateButtons();
+    });
+
+    connect(m_planner, &ConsolidationPlanner::sweepUpdated, this, &ConsolidationDialog::onSweepUpdated);
+    connect(m_planner, &ConsolidationPlanner::finished,     this, &ConsolidationDialog::onFinished);
+
+    // Counts down to the next commit
+    m_updateTimer.setInterval(1000);
+    connect(&m_updateTimer, &QTimer::timeout, this, &ConsolidationDialog::updateSummary);
+
+    this->updateButtons();
+}
+
+void ConsolidationDialog::onPlan() {
+    ConsolidationPlanner::Options options;
+    options.maxInputs = ui->spin_maxInputs->value();
+    options.minAmount = WalletManager::amountFromString(ui->line_minAmount->text().replace(',', '.').trimmed());
+    options.interval = ui->spin_interval->value();
+    options.priority = static_cast<PendingTransaction::Priority>(ui->combo_priority->currentData().toInt());
+
+    m_planner->plan(options);
+
+    ui->tree_sweeps->clear();
+    m_sweepItems.clear();
+
+    QVector<ConsolidationPlanner::Sweep> sweeps = m_planner->sweeps();
+    m_sweepItems.resize(sweeps.size());
+
+    for (const auto &group : m_planner->groups()) {
+        auto *groupItem = new QTreeWidgetItem(ui->tree_sweeps);
+        groupItem->setText(Column::Address, QString("#%1.%2 %3").arg(QString::number(group.account), QString::number(group.subaddress),
+                                                                   ModelUtils::displayAddress(group.address, 1)));
+        groupItem->setText(Column::Outputs, QString::number(group.outputs));
+        groupItem->setText(Column::Amount, WalletManager::displayAmount(group.amount, false));
+
+        QStringList notes;
+        if (group.locked > 0) {
+            notes << QString("%1 locked").arg(group.locked);
+        }
+        if (group.skipped > 0) {
+            notes << QString("%1 below minimum").arg(group.skipped);
+        }
+        if (group.sweeps.isEmpty()) {
+            notes << "nothing to consolidate";
+        }
+        groupItem->setText(Column::Status, notes.join(", "));
+
+        for (int index : group.sweeps) {
+            const auto &sweep = sweeps[index];
+            auto *item = new QTreeWidgetItem(groupItem);
+            item->setText(Column::Address, QString("Sweep %1").arg(index + 1));
+            item->setText(Column::Outputs, QString::number(sweep.keyImages.size()));
+            item->setText(Column::Amount, WalletManager::displayAmount(sweep.amount, false));
+            m_sweepItems[index] = item;
+            this->onSweepUpdated(index);
+        }
+        groupItem->setExpanded(group.sweeps.size() > 1);
+    }
+
+    for (int i = 0; i < ui->tree_sweeps->columnCount(); i++) {
+        ui->tree_sweeps->resizeColumnToContents(i);
+    }
+
+    this->updateSummary();
+    this->updateButtons();
+}
+
+void ConsolidationDialog::onStart() {
+    QVector<ConsolidationPlanner::Sweep> sweeps = m_planner->sweeps();
+    int inputs = 0;
+    for (const auto &sweep : sweeps) {
+        inputs += sweep.keyImages.size();
+    }
+
+    auto result = QMessageBox::question(this, "Consolidate outputs", QString("Merge %1 outputs into %2 in %3 transactions?\n\n"
+                                                                            "Each transaction pays a fee. Keep Feather open until all of them are committed.")
+                                        .arg(QString::number(inputs), QString::number(sweeps.size()), QString::number(sweeps.size())));
+    if (result != QMessageBox::Yes) {
+        return;
+    }
+
+    m_planner->start();
+    m_updateTimer.start();
+    this->updateButtons();
+}
+
+void ConsolidationDialog::onSweepUpdated(int index) {
+    QTreeWidgetItem *item = m_sweepItems.value(index);
+    if (!item) {
+        return;
+    }
+
+    ConsolidationPlanner::Sweep sweep = m_planner->sweep(index);
+    item->setText(Column::Fee, sweep.fee > 0 ? WalletManager::displayAmount(sweep.fee, false) : QString());
+    item->setText(Column::Status, ConsolidationPlanner::stateToString(sweep.state));
+    item->setToolTip(Column::Status, sweep.state == ConsolidationPlanner::Failed ? sweep.error : sweep.txids.join("\n"));
+
+    this->updateSummary();
+}
+
+void ConsolidationDialog::onFinished(int committed, int failed) {
+    m_updateTimer.stop();
+    this->updateSummary();
+    this->updateButtons();
+
+    QString message = QString("%1 consolidation transactions committed.").arg(committed);
+    if (failed > 0) {
+        message += QString(" %1 failed, hover over their status for details.").arg(failed);
+    }
+    QMessageBox::information(this, "Consolidate outputs", message);
+}
+
+void ConsolidationDialog::updateSummary() {
+    QVector<ConsolidationPlanner::Sweep> sweeps = m_planner->sweeps();
+    if (sweeps.isEmpty()) {
+        ui->label_summary->setText(m_planner->groups().isEmpty() ? QString() : "Nothing to consolidate");
+        return;
+    }
+
+    int inputs = 0;
+    int committed = 0;
+    quint64 fees = 0;
+    for (const auto &sweep : sweeps) {
+        inputs += sweep.keyImages.size();
+        fees += sweep.fee;
+        if (sweep.state == ConsolidationPlanner::Committed) {
+            committed++;
+        }
+    }
+
+    QString summary = QString("%1 outputs in %2 sweeps, %3 committed, %4 XMR in fees so far")
+            .arg(QString::number(inputs), QString::number(sweeps.size()), QString::number(committed),
+                 WalletManager::displayAmount(fees, false));
+
+    int next = m_planner->nextCommit();
+    if (next >= 0) {
+        summary += QString(", next commit in %1 s").arg(next);
+    }
+    ui->label_summary->setText(summary);
+}
+
+void ConsolidationDialog::updateButtons() {
+    bool running = m_planner->isRunning();
+
+    ui->btn_plan->setEnabled(!running);
+    ui->btn_start->setEnabled(!running && !m_planner->sweeps().isEmpty());
+    ui->btn_stop->setEnabled(running);
+    ui->frame_options->setEnabled(!running);
+}
+
+ConsolidationDialog::~ConsolidationDialog() = default;
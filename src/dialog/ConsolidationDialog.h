@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_CONSOLIDATIONDIALOG_H
+#define FEATHER_CONSOLIDATIONDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+#include <QTreeWidgetItem>
+
+#include "appcontext.h"
+#include "components.h"
+#include "utils/ConsolidationPlanner.h"
+
+namespace Ui {
+    class ConsolidationDialog;
+}
+
+class ConsolidationDialog : public WindowModalDialog
+{
+Q_OBJECT
+
+public:
+    explicit ConsolidationDialog(QWidget *parent, QSharedPointer<AppContext> ctx);
+    ~ConsolidationDialog() override;
+
+private slots:
+    void onPlan();
+    void onStart();
+    void onSweepUpdated(int index);
+    void onFinished(int committed, int failed);
+
+private:
+    void updateSummary();
+    void updateButtons();
+
+    QScopedPointer<Ui::ConsolidationDialog> ui;
+    QSharedPointer<AppContext> m_ctx;
+    ConsolidationPlanner *m_planner;
+    QVector<QTreeWidgetItem*> m_sweepItems;
+    QTimer m_updateTimer;
+};
+
+#endif //FEATHER_CONSOLIDATIONDIALOG_H
@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "PayoutDialog.h"
+#include "ui_PayoutDialog.h"
+
+#include <QFileDialog>
+#include <QMessageBox>
+
+#include "libwalletqt/WalletManager.h"
+
+namespace {
+    enum Column {
+        Number = 0,
+        Destinations,
+        Amount,
+        Inputs,
+        Status,
+        Txid
+    };
+}
+
+PayoutDialog::PayoutDialog(QWidget *parent, QSharedPointer<AppContext> ctx)
+        : WindowModalDialog(parent)
+        , ui(new Ui::PayoutDialog)
+        , m_ctx(std::move(ctx))
+        , m_engine(new PayoutEngine(m_ctx, this))
+{
+    ui->setupUi(this);
+
+    ui->tree_batches->setHeaderLabels({"Batch", "Destinations", "Amount", "Inputs", "Status", "Transaction ID"});
+    ui->tree_batches->setRootIsDecorated(false);
+
+    connect(ui->btn_open,   &QPushButton::clicked, this, &PayoutDialog::onOpenFile);
+    connect(ui->btn_start,  &QPushButton::clicked, this, &PayoutDialog::onStart);
+    connect(ui->btn_stop,   &QPushButton::clicked, m_engine, &PayoutEngine::cancel);
+    connect(ui->btn_report, &QPushButton::clicked, this, &PayoutDialog::onSaveReport);
+
+    connect(m_engine, &PayoutEngine::validated,    this, &PayoutDialog::onValidated);
+    connect(m_engine, &PayoutEngine::batchUpdated, this, &PayoutDialog::onBatchUpdated);
+    connect(m_engine, &PayoutEngine::finished,     this, &PayoutDialog::onFinished);
+
+    this->updateButtons();
+}
+
+void PayoutDialog::onOpenFile() {
+    QString path = QFileDialog::getOpenFileName(this, "Open payout file", QDir::homePath(), "CSV Files (*.csv)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    ui->tree_batches->clear();
+    ui->log->clear();
+
+    QString error;
+    if (!m_engine->load(path, error)) {
+        QMessageBox::warning(this, "Bulk payout", error);
+        return;
+    }
+
+    ui->line_file->setText(path);
+    ui->label_summary->setText("Validating addresses..");
+    this->updateButtons();
+}
+
+void PayoutDialog::onValidated(int valid, int invalid) {
+    for (const auto &row : m_engine->rows()) {
+        if (!row.error.isEmpty()) {
+            ui->log->appendPlainText(QString("Line %1: %2").arg(QString::number(row.line), row.error));
+        }
+    }
+
+    if (valid == 0) {
+        ui->label_summary->setText(QString("No valid payments, %1 rows rejected").arg(invalid));
+        this->updateButtons();
+        return;
+    }
+
+    QString error;
+    if (!m_engine->plan(error)) {
+        ui->label_summary->clear();
+        QMessageBox::warning(this, "Bulk payout", error);
+        this->updateButtons();
+        return;
+    }
+
+    int paid = 0;
+    for (const auto &row : m_engine->rows()) {
+        if (!row.paidBy.isEmpty()) {
+            ui->log->appendPlainText(QString("Line %1: already paid by %2").arg(QString::number(row.line), row.paidBy));
+            paid++;
+        }
+    }
+    if (paid > 0) {
+        QMessageBox::warning(this, "Bulk payout", QString("%1 payments in this file were already paid by an earlier run "
+                                                          "of a different version of it. They will not be paid again, "
+                                                          "see the log for details.").arg(paid));
+    }
+
+    ui->tree_batches->clear();
+    for (const auto &batch : m_engine->batches()) {
+        auto *item = new QTreeWidgetItem(ui->tree_batches);
+        item->setText(Column::Number, QString::number(batch.index + 1));
+        item->setText(Column::Destinations, QString::number(batch.rows.size()));
+        item->setText(Column::Amount, WalletManager::displayAmount(batch.total, false));
+        this->onBatchUpdated(batch.index);
+    }
+    ui->tree_batches->resizeColumnToContents(Column::Amount);
+
+    if (invalid > 0) {
+        ui->log->appendPlainText(QString("%1 rows rejected, they will not be paid").arg(invalid));
+    }
+    this->updateSummary();
+    this->updateButtons();
+}
+
+void PayoutDialog::onStart() {
+    QVector<PayoutEngine::Batch> batches = m_engine->batches();
+
+    int pending = 0;
+    quint64 amount = 0;
+    for (const auto &batch : batches) {
+        if (batch.state != PayoutEngine::Committed && batch.state != PayoutEngine::Unfunded) {
+            pending++;
+            amount += batch.total;
+        }
+    }
+
+    if (pending == 0) {
+        QMessageBox::information(this, "Bulk payout", "Nothing left to pay that can be funded right now.");
+        return;
+    }
+
+    auto result = QMessageBox::question(this, "Bulk payout", QString("Send %1 XMR in %2 transactions?")
+                                        .arg(WalletManager::displayAmount(amount, false), QString::number(pending)));
+    if (result != QMessageBox::Yes) {
+        return;
+    }
+
+    m_engine->start();
+    this->updateButtons();
+}
+
+void PayoutDialog::onBatchUpdated(int index) {
+    QTreeWidgetItem *item = ui->tree_batches->topLevelItem(index);
+    if (!item) {
+        return;
+    }
+
+    PayoutEngine::Batch batch = m_engine->batch(index);
+    item->setText(Column::Inputs, QString::number(batch.inputs.size()));
+    item->setText(Column::Status, PayoutEngine::stateToString(batch.state));
+    item->setText(Column::Txid, batch.state == PayoutEngine::Committed ? batch.txids.join(", ") : QString());
+    item->setToolTip(Column::Status, batch.error);
+
+    if (!batch.error.isEmpty() && batch.state == PayoutEngine::Failed) {
+        ui->log->appendPlainText(QString("Batch %1: %2").arg(QString::number(index + 1), batch.error));
+    }
+
+    this->updateSummary();
+}
+
+void PayoutDialog::onFinished(int committed, int failed) {
+    this->updateButtons();
+
+    QString message = QString("%1 transactions committed.").arg(committed);
+    if (failed > 0) {
+        message += QString(" %1 failed, start the payout again to retry them with the same outputs.").arg(failed);
+    }
+    QMessageBox::information(this, "Bulk payout", message);
+}
+
+void PayoutDialog::onSaveReport() {
+    QString path = QFileDialog::getSaveFileName(this, "Save reconciliation report",
+                                                QDir::home().filePath(QString("payout_%1.csv").arg(m_engine->batchId())),
+                                                "CSV Files (*.csv)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (!m_engine->exportReport(path, error)) {
+        QMessageBox::warning(this, "Bulk payout", QString("Could not save report: %1").arg(error));
+    }
+}
+
+void PayoutDialog::updateSummary() {
+    QVector<PayoutEngine::Batch> batches = m_engine->batches();
+
+    int destinations = 0;
+    int committed = 0;
+    int unfunded = 0;
+    for (const auto &batch : batches) {
+        destinations += batch.rows.size();
+        if (batch.state == PayoutEngine::Committed) {
+            committed++;
+        } else if (batch.state == PayoutEngine::Unfunded) {
+            unfunded++;
+        }
+    }
+
+    QString summary = QString("%1 destinations, %2 XMR in %3 transactions, %4 committed")
+            .arg(QString::number(destinations), WalletManager::displayAmount(m_engine->total(), false),
+                 QString::number(batches.size()), QString::number(committed));
+    if (unfunded > 0) {
+        summary += QString(", %1 waiting for unlocked balance").arg(unfunded);
+    }
+    ui->label_summary->setText(summary);
+}
+
+void PayoutDialog::updateButtons() {
+    bool running = m_engine->isRunning();
+    bool planned = !m_engine->batchId().isEmpty();
+
+    ui->btn_open->setEnabled(!running);
+    ui->btn_start->setEnabled(!running && planned);
+    ui->btn_stop->setEnabled(running);
+    ui->btn_report->setEnabled(planned);
+}
+
+PayoutDialog::~PayoutDialog() = default;
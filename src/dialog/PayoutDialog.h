@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_PAYOUTDIALOG_H
+#define FEATHER_PAYOUTDIALOG_H
+
+#include <QDialog>
+
+#include "appcontext.h"
+#include "components.h"
+#include "utils/PayoutEngine.h"
+
+namespace Ui {
+    class PayoutDialog;
+}
+
+class PayoutDialog : public WindowModalDialog
+{
+Q_OBJECT
+
+public:
+    explicit PayoutDialog(QWidget *parent, QSharedPointer<AppContext> ctx);
+    ~PayoutDialog() override;
+
+private slots:
+    void onOpenFile();
+    void onValidated(int valid, int invalid);
+    void onStart();
+    void onBatchUpdated(int index);
+    void onFinished(int committed, int failed);
+    void onSaveReport();
+
+private:
+    void updateSummary();
+    void updateButtons();
+
+    QScopedPointer<Ui::PayoutDialog> ui;
+    QSharedPointer<AppContext> m_ctx;
+    PayoutEngine *m_engine;
+};
+
+#endif //FEATHER_PAYOUTDIALOG_H
@@ -8,6 +8,8 @@
 #include <QFileDialog>
 #include <QMessageBox>
 
+#include "utils/config.h"
+
 QrCodeDialog::QrCodeDialog(QWidget *parent, QrCode *qrCode, const QString &title)
         : WindowModalDialog(parent)
         , ui(new Ui::QrCodeDialog)
@@ -16,6 +18,8 @@ QrCodeDialog::QrCodeDialog(QWidget *parent, QrCode *qrCode, const QString &title
     this->setWindowTitle(title);
 
     ui->qrWidget->setQrCode(qrCode);
+    ui->label_frameRate->hide();
+    ui->spin_frameRate->hide();
 
     m_pixmap = qrCode->toPixmap(1).scaled(500, 500, Qt::KeepAspectRatio);
 
@@ -28,6 +32,37 @@ QrCodeDialog::QrCodeDialog(QWidget *parent, QrCode *qrCode, const QString &title
     this->resize(500, 500);
 }
 
+QrCodeDialog::QrCodeDialog(QWidget *parent, const QByteArray &data, const QString &title)
+        : WindowModalDialog(parent)
+        , ui(new Ui::QrCodeDialog)
+{
+    ui->setupUi(this);
+    this->setWindowTitle(title);
+
+    ui->qrWidget->setAnimatedData(data);
+
+    // A single frame of an animation can't be used on its own
+    ui->btn_CopyImage->hide();
+    ui->btn_Save->hide();
+
+    if (ui->qrWidget->isAnimated()) {
+        ui->spin_frameRate->setValue(config()->get(Config::animatedQrFrameRate).toInt());
+        connect(ui->spin_frameRate, QOverload<int>::of(&QSpinBox::valueChanged), [this](int fps){
+            config()->set(Config::animatedQrFrameRate, fps);
+            ui->qrWidget->setFrameRate(fps);
+        });
+    } else {
+        ui->label_frameRate->hide();
+        ui->spin_frameRate->hide();
+    }
+
+    connect(ui->btn_Close, &QPushButton::clicked, [this](){
+        accept();
+    });
+
+    this->resize(500, 500);
+}
+
 void QrCodeDialog::copyImage() {
     QApplication::clipboard()->setPixmap(m_pixmap);
     QMessageBox::information(this, "Information", "QR code copied to clipboard");
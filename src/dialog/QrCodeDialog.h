@@ -20,6 +20,8 @@ Q_OBJECT
 
 public:
     explicit QrCodeDialog(QWidget *parent, QrCode *qrCode, const QString &title = "Qr Code");
+    // Animated QR code for payloads that don't fit a single one
+    explicit QrCodeDialog(QWidget *parent, const QByteArray &data, const QString &title = "Qr Code");
     ~QrCodeDialog() override;
 
 private:
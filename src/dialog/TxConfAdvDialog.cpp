@@ -30,6 +30,7 @@ TxConfAdvDialog::TxConfAdvDialog(QSharedPointer<AppContext> ctx, const QString &
     ui->btn_exportUnsigned->setMenu(m_exportUnsignedMenu);
 
     m_exportSignedMenu->addAction("Copy to clipboard", this, &TxConfAdvDialog::signedCopy);
+    m_exportSignedMenu->addAction("Show as QR code", this, &TxConfAdvDialog::signedQrCode);
     m_exportSignedMenu->addAction("Save to file", this, &TxConfAdvDialog::signedSaveFile);
     ui->btn_exportSigned->setMenu(m_exportSignedMenu);
 
@@ -186,13 +187,8 @@ void TxConfAdvDialog::signedSaveFile() {
 }
 
 void TxConfAdvDialog::unsignedQrCode() {
-    if (m_tx->unsignedTxToBin().size() > 2953) {
-        QMessageBox::warning(this, "Unable to show QR code", "Transaction size exceeds the maximum size for QR codes (2953 bytes).");
-        return;
-    }
-
-    QrCode qr(m_tx->unsignedTxToBin(), QrCode::Version::AUTO, QrCode::ErrorCorrectionLevel::LOW);
-    QrCodeDialog dialog{this, &qr, "Unsigned Transaction"};
+    // Animated if the transaction doesn't fit a single QR code
+    QrCodeDialog dialog{this, m_tx->unsignedTxToBin(), "Unsigned Transaction"};
     dialog.exec();
 }
 
@@ -209,6 +205,8 @@ void TxConfAdvDialog::txKeyCopy() {
 }
 
 void TxConfAdvDialog::signedQrCode() {
+    QrCodeDialog dialog{this, QByteArray::fromHex(m_tx->signedTxToHex(0).toLatin1()), "Signed Transaction"};
+    dialog.exec();
 }
 
 void TxConfAdvDialog::broadcastTransaction() {
@@ -4,92 +4,239 @@
 #include "WalletCacheDebugDialog.h"
 #include "ui_WalletCacheDebugDialog.h"
 
+#include <QClipboard>
+#include <QFileDialog>
+#include <QMessageBox>
 #include <QRadioButton>
+#include <QSaveFile>
+#include <QShortcut>
+#include <QtConcurrent/QtConcurrent>
 
-#include "model/ModelUtils.h"
+namespace {
+    // Bytes of dump indexed per chunk handed to the view
+    constexpr int chunkSize = 4 * 1024 * 1024;
+}
 
 WalletCacheDebugDialog::WalletCacheDebugDialog(QSharedPointer<AppContext> ctx, QWidget *parent)
         : WindowModalDialog(parent)
         , ui(new Ui::WalletCacheDebugDialog)
         , m_ctx(std::move(ctx))
+        , m_model(new CacheDumpModel(this))
 {
     ui->setupUi(this);
 
-    ui->output->setFont(ModelUtils::getMonospaceFont());
+    m_pool.setMaxThreadCount(1);
+
+    ui->output->setModel(m_model);
+    ui->btn_export->setEnabled(false);
+
+    connect(ui->line_search, &QLineEdit::returnPressed, this, &WalletCacheDebugDialog::findNext);
+    connect(ui->btn_export, &QPushButton::clicked, this, &WalletCacheDebugDialog::exportDump);
+    auto *copy = new QShortcut(QKeySequence::Copy, ui->output);
+    connect(copy, &QShortcut::activated, this, &WalletCacheDebugDialog::copySelection);
 
     connect(ui->m_blockchain, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printBlockchain());
+        this->load("m_blockchain", &Wallet::printBlockchain);
     });
 
     connect(ui->m_transfers, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printTransfers());
+        this->load("m_transfers", &Wallet::printTransfers);
     });
 
     connect(ui->m_unconfirmed_payments, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printUnconfirmedPayments());
+        this->load("m_unconfirmed_payments", &Wallet::printUnconfirmedPayments);
     });
 
     connect(ui->m_confirmed_txs, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printConfirmedTransferDetails());
+        this->load("m_confirmed_txs", &Wallet::printConfirmedTransferDetails);
     });
 
     connect(ui->m_unconfirmed_txs, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printUnconfirmedTransferDetails());
+        this->load("m_unconfirmed_txs", &Wallet::printUnconfirmedTransferDetails);
     });
 
     connect(ui->m_payments, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printPayments());
+        this->load("m_payments", &Wallet::printPayments);
     });
 
     connect(ui->m_pub_keys, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printPubKeys());
+        this->load("m_pub_keys", &Wallet::printPubKeys);
     });
 
     connect(ui->m_tx_notes, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printTxNotes());
+        this->load("m_tx_notes", &Wallet::printTxNotes);
     });
 
     connect(ui->m_subaddresses, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printSubaddresses());
+        this->load("m_subaddresses", &Wallet::printSubaddresses);
     });
 
     connect(ui->m_subaddress_labels, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printSubaddressLabels());
+        this->load("m_subaddress_labels", &Wallet::printSubaddressLabels);
     });
 
     connect(ui->m_additional_tx_keys, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printAdditionalTxKeys());
+        this->load("m_additional_tx_keys", &Wallet::printAdditionalTxKeys);
     });
 
     connect(ui->m_attributes, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printAttributes());
+        this->load("m_attributes", &Wallet::printAttributes);
     });
 
     connect(ui->m_key_images, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printKeyImages());
+        this->load("m_key_images", &Wallet::printKeyImages);
     });
 
     connect(ui->m_account_tags, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printAccountTags());
+        this->load("m_account_tags", &Wallet::printAccountTags);
     });
 
     connect(ui->m_tx_keys, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printTxKeys());
+        this->load("m_tx_keys", &Wallet::printTxKeys);
     });
 
     connect(ui->m_address_book, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printAddressBook());
+        this->load("m_address_book", &Wallet::printAddressBook);
     });
 
     connect(ui->m_scanned_pool_txs, &QRadioButton::pressed, [this]{
-        this->setOutput(m_ctx->wallet->printScannedPoolTxs());
+        this->load("m_scanned_pool_txs", &Wallet::printScannedPoolTxs);
     });
 
     this->adjustSize();
 }
 
-void WalletCacheDebugDialog::setOutput(const QString &output) {
-    ui->output->setPlainText(output);
+void WalletCacheDebugDialog::load(const QString &name, QString (Wallet::*print)()) {
+    // Results of an earlier dump that is still being built are dropped
+    int generation = ++m_generation;
+    m_name = name;
+    m_model->clear();
+    ui->btn_export->setEnabled(false);
+    ui->label_status->setText("Loading..");
+
+    Wallet *wallet = m_ctx->wallet;
+    m_pool.clear();
+    QtConcurrent::run(&m_pool, [this, wallet, print, generation]{
+        // The print functions walk wallet2 containers that the refresh thread modifies
+        QByteArray dump;
+        wallet->runLocked([&]{
+            dump = (wallet->*print)().toUtf8();
+        });
+        if (m_generation != generation) {
+            return;
+        }
+
+        QMetaObject::invokeMethod(this, [this, dump, generation]{
+            if (m_generation == generation) {
+                m_model->setDump(dump);
+            }
+        }, Qt::QueuedConnection);
+
+        int from = 0;
+        do {
+            int to = from + chunkSize;
+            QVector<int> offsets = CacheDumpModel::indexLines(dump, from, to);
+            from = to;
+            bool done = from >= dump.size();
+
+            QMetaObject::invokeMethod(this, [this, offsets, generation, done]{
+                if (m_generation != generation) {
+                    return;
+                }
+                m_model->appendLines(offsets);
+                this->updateStatus(done);
+            }, Qt::QueuedConnection);
+        } while (from < dump.size() && m_generation == generation);
+    });
+}
+
+void WalletCacheDebugDialog::findNext() {
+    QByteArray text = ui->line_search->text().toUtf8();
+    if (text.isEmpty()) {
+        return;
+    }
+
+    int from = ui->output->currentIndex().isValid() ? ui->output->currentIndex().row() + 1 : 0;
+
+    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+    int row = m_model->find(text, from);
+    if (row < 0 && from > 0) {
+        row = m_model->find(text, 0);
+    }
+    QApplication::restoreOverrideCursor();
+
+    if (row < 0) {
+        ui->label_status->setText(QString("\"%1\" not found").arg(ui->line_search->text()));
+        return;
+    }
+
+    QModelIndex index = m_model->index(row);
+    ui->output->setCurrentIndex(index);
+    ui->output->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+void WalletCacheDebugDialog::exportDump() {
+    QString fn = QFileDialog::getSaveFileName(this, "Save dump", QDir::home().filePath(QString("%1.txt").arg(m_name)), "Text (*.txt)");
+    if (fn.isEmpty()) {
+        return;
+    }
+
+    QByteArray dump = m_model->dump();
+    ui->btn_export->setEnabled(false);
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, [this, watcher, fn]{
+        watcher->deleteLater();
+        ui->btn_export->setEnabled(true);
+        QString error = watcher->result();
+        if (error.isEmpty()) {
+            QMessageBox::information(this, "Export dump", QString("Dump saved to %1").arg(fn));
+        } else {
+            QMessageBox::warning(this, "Export dump", QString("Unable to save dump: %1").arg(error));
+        }
+    });
+
+    QFuture<QString> future = QtConcurrent::run([dump, fn]{
+        QSaveFile file(fn);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return file.errorString();
+        }
+        for (int pos = 0; pos < dump.size(); pos += chunkSize) {
+            if (file.write(dump.constData() + pos, std::min(chunkSize, static_cast<int>(dump.size()) - pos)) < 0) {
+                return file.errorString();
+            }
+        }
+        if (!file.commit()) {
+            return file.errorString();
+        }
+        return QString();
+    });
+    watcher->setFuture(future);
+}
+
+void WalletCacheDebugDialog::copySelection() {
+    QModelIndexList selected = ui->output->selectionModel()->selectedIndexes();
+    std::sort(selected.begin(), selected.end());
+
+    QStringList lines;
+    for (const auto &index : selected) {
+        lines << m_model->line(index.row());
+    }
+    QApplication::clipboard()->setText(lines.join("\n"));
 }
 
-WalletCacheDebugDialog::~WalletCacheDebugDialog() = default;
+void WalletCacheDebugDialog::updateStatus(bool done) {
+    QString status = QString("%1 lines, %2 MB").arg(QString::number(m_model->rowCount()),
+                                                     QString::number(m_model->dump().size() / 1024.0 / 1024.0, 'f', 1));
+    if (!done) {
+        status += ", indexing..";
+    }
+    ui->label_status->setText(status);
+    ui->btn_export->setEnabled(done);
+}
+
+WalletCacheDebugDialog::~WalletCacheDebugDialog() {
+    m_generation++;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
@@ -5,9 +5,13 @@
 #define FEATHER_WALLETCACHEDEBUGDIALOG_H
 
 #include <QDialog>
+#include <QThreadPool>
+
+#include <atomic>
 
 #include "appcontext.h"
 #include "components.h"
+#include "model/CacheDumpModel.h"
 
 namespace Ui {
     class WalletCacheDebugDialog;
@@ -22,10 +26,20 @@ public:
     ~WalletCacheDebugDialog() override;
 
 private:
-    void setOutput(const QString &output);
+    // Dumps are built and indexed on a worker thread, the view fills in as chunks come in
+    void load(const QString &name, QString (Wallet::*print)());
+    void findNext();
+    void exportDump();
+    void copySelection();
+    void updateStatus(bool done);
 
     QScopedPointer<Ui::WalletCacheDebugDialog> ui;
     QSharedPointer<AppContext> m_ctx;
+    CacheDumpModel *m_model;
+    QString m_name;
+    std::atomic<int> m_generation{0};
+    // One dump at a time, a newer request replaces the one waiting for the thread
+    QThreadPool m_pool;
 };
 
 
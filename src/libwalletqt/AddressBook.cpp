@@ -74,6 +74,28 @@ bool AddressBook::addRow(const QString &address, const QString &payment_id, cons
     return result;
 }
 
+int AddressBook::addRows(const QVector<QPair<QString, QString>> &rows, QMap<int, QString> &errors, const std::function<void (int)> &progress)
+{
+    int added = 0;
+
+    for (int i = 0; i < rows.size(); i++) {
+        // Locked per row, so the model can keep reading m_rows in between
+        QWriteLocker locker(&m_lock);
+
+        if (m_addressBookImpl->addRow(rows[i].first.toStdString(), "", rows[i].second.toStdString())) {
+            added++;
+        } else {
+            errors.insert(i, QString::fromStdString(m_addressBookImpl->errorString()));
+        }
+        locker.unlock();
+
+        if (progress && ((i + 1) % 100 == 0 || i + 1 == rows.size()))
+            progress(i + 1);
+    }
+
+    return added;
+}
+
 void AddressBook::setDescription(int index, const QString &description) {
     bool result;
 
@@ -10,6 +10,7 @@
 #include <QObject>
 #include <QReadWriteLock>
 #include <QList>
+#include <QVector>
 #include <QDateTime>
 
 namespace Monero {
@@ -23,6 +24,9 @@ class AddressBook : public QObject
 public:
     Q_INVOKABLE bool getRow(int index, std::function<void (AddressBookInfo &)> callback) const;
     Q_INVOKABLE bool addRow(const QString &address, const QString &payment_id, const QString &description);
+    // Adds (address, description) pairs, returns the number added. Rows wallet2 refused end up in errors, keyed by
+    // their position in rows. Leaves the rows shown by the model alone, see Wallet::addContactsAsync.
+    int addRows(const QVector<QPair<QString, QString>> &rows, QMap<int, QString> &errors, const std::function<void (int)> &progress = {});
     Q_INVOKABLE bool deleteRow(int rowId);
     Q_INVOKABLE void setDescription(int index, const QString &label);
     quint64 count() const;
@@ -6,6 +6,7 @@
 #include <QDebug>
 
 #include "CoinsInfo.h"
+#include "utils/Trace.h"
 
 #include <QFile>
 
@@ -31,6 +32,7 @@ CoinsInfo* Coins::coin(int index)
 
 void Coins::refresh(quint32 accountIndex)
 {
+    TRACE_SCOPE("Coins::refresh");
     emit refreshStarted();
 
     {
@@ -71,6 +73,21 @@ quint64 Coins::count() const
     return m_tinfo.count();
 }
 
+QVector<Coins::Output> Coins::spendableOutputs()
+{
+    QWriteLocker locker(&m_lock);
+
+    QVector<Output> outputs;
+    m_pimpl->refresh();
+    for (const auto i : m_pimpl->getAll()) {
+        if (i->spent() || i->frozen() || !i->keyImageKnown()) {
+            continue;
+        }
+        outputs.append({QString::fromStdString(i->keyImage()), i->amount(), i->subaddrAccount(), i->subaddrIndex(), i->unlocked()});
+    }
+    return outputs;
+}
+
 void Coins::freeze(QString &publicKey) const
 {
     m_pimpl->setFrozen(publicKey.toStdString());
@@ -8,6 +8,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QVector>
 #include <QReadWriteLock>
 #include <QDateTime>
 #include <wallet/api/wallet2_api.h>
@@ -23,6 +24,14 @@ class Coins : public QObject
 Q_OBJECT
 
 public:
+    struct Output {
+        QString keyImage;
+        quint64 amount;
+        quint32 account;
+        quint32 subaddress;
+        bool unlocked;
+    };
+
     bool coin(int index, std::function<void (CoinsInfo &)> callback);
     CoinsInfo * coin(int index);
     void refresh(quint32 accountIndex);
@@ -35,6 +44,9 @@ public:
 
     quint64 count() const;
 
+    // Unspent, unfrozen outputs with a known key image across all accounts, the coins list is left untouched
+    QVector<Output> spendableOutputs();
+
 signals:
     void refreshStarted() const;
     void refreshFinished() const;
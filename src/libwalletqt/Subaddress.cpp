@@ -3,10 +3,13 @@
 
 #include "Subaddress.h"
 #include <QDebug>
+#include <QTextStream>
+#include "utils/Trace.h"
 
-Subaddress::Subaddress(Monero::Subaddress *subaddressImpl, QObject *parent)
+Subaddress::Subaddress(Monero::Subaddress *subaddressImpl, Monero::Wallet *walletImpl, QObject *parent)
     : QObject(parent)
     , m_subaddressImpl(subaddressImpl)
+    , m_walletImpl(walletImpl)
     , m_unusedLookahead(0)
 {
     getAll();
@@ -23,21 +26,135 @@ void Subaddress::getAll() const
 
     {
         QWriteLocker locker(&m_lock);
+        loadRows();
+    }
+
+    emit refreshFinished();
+}
+
+void Subaddress::loadRows() const
+{
+    m_unusedLookahead = 0;
 
-        m_unusedLookahead = 0;
+    m_rows.clear();
+    for (auto &row: m_subaddressImpl->getAll()) {
+        m_rows.append(row);
 
-        m_rows.clear();
-        for (auto &row: m_subaddressImpl->getAll()) {
-            m_rows.append(row);
+        if (row->isUsed())
+            m_unusedLookahead = 0;
+        else
+            m_unusedLookahead += 1;
+    }
+
+    indexNew();
+}
+
+void Subaddress::indexNew() const
+{
+    quint32 accounts = m_walletImpl->numSubaddressAccounts();
+    if (static_cast<quint32>(m_addresses.size()) < accounts) {
+        m_addresses.resize(accounts);
+        m_used.resize(accounts);
+    }
 
-            if (row->isUsed())
-                m_unusedLookahead = 0;
-            else
-                m_unusedLookahead += 1;
+    // Rows of the shown account already carry their address, the others have to be derived
+    if (m_accountIndex < accounts) {
+        auto &addresses = m_addresses[m_accountIndex];
+        for (const auto *row : m_rows) {
+            if (row->getRowId() != static_cast<std::size_t>(addresses.size()))
+                continue;
+            QString address = QString::fromStdString(row->getAddress());
+            m_index.insert(address, {m_accountIndex, static_cast<quint32>(addresses.size())});
+            addresses.append(address);
         }
     }
 
-    emit refreshFinished();
+    for (quint32 account = 0; account < accounts; account++) {
+        auto &addresses = m_addresses[account];
+        quint32 total = m_walletImpl->numSubaddresses(account);
+        for (quint32 i = addresses.size(); i < total; i++) {
+            QString address = QString::fromStdString(m_walletImpl->address(account, i));
+            m_index.insert(address, {account, i});
+            addresses.append(address);
+        }
+        m_used[account].resize(addresses.size());
+    }
+
+    if (m_accountIndex < accounts) {
+        for (const auto *row : m_rows) {
+            if (row->isUsed() && row->getRowId() < static_cast<std::size_t>(m_used[m_accountIndex].size()))
+                m_used[m_accountIndex].setBit(row->getRowId());
+        }
+    }
+}
+
+void Subaddress::updateIndex() const
+{
+    QWriteLocker locker(&m_lock);
+    indexNew();
+}
+
+bool Subaddress::index(const QString &address, quint32 &accountIndex, quint32 &addressIndex) const
+{
+    QReadLocker locker(&m_lock);
+
+    auto it = m_index.constFind(address);
+    if (it == m_index.constEnd())
+        return false;
+
+    accountIndex = it->first;
+    addressIndex = it->second;
+    return true;
+}
+
+QVector<QPair<qint64, qint64>> Subaddress::indices(const QStringList &addresses) const
+{
+    QReadLocker locker(&m_lock);
+
+    QVector<QPair<qint64, qint64>> result;
+    result.reserve(addresses.size());
+    for (const auto &address : addresses) {
+        auto it = m_index.constFind(address);
+        if (it == m_index.constEnd())
+            result.append({-1, -1});
+        else
+            result.append({it->first, it->second});
+    }
+    return result;
+}
+
+QString Subaddress::address(quint32 accountIndex, quint32 addressIndex) const
+{
+    QReadLocker locker(&m_lock);
+
+    if (accountIndex >= static_cast<quint32>(m_addresses.size()))
+        return {};
+    return m_addresses[accountIndex].value(addressIndex);
+}
+
+bool Subaddress::isUsed(quint32 accountIndex, quint32 addressIndex) const
+{
+    QReadLocker locker(&m_lock);
+
+    if (accountIndex >= static_cast<quint32>(m_used.size()) || addressIndex >= static_cast<quint32>(m_used[accountIndex].size()))
+        return false;
+    return m_used[accountIndex].testBit(addressIndex);
+}
+
+void Subaddress::markUsed(quint32 accountIndex, quint32 addressIndex) const
+{
+    markUsed({{accountIndex, addressIndex}});
+}
+
+void Subaddress::markUsed(const QVector<QPair<quint32, quint32>> &indices) const
+{
+    QWriteLocker locker(&m_lock);
+
+    for (const auto &index : indices) {
+        if (index.first >= static_cast<quint32>(m_used.size()) || index.second >= static_cast<quint32>(m_used[index.first].size()))
+            continue;
+        m_used[index.first].setBit(index.second);
+    }
 }
 
 bool Subaddress::getRow(int index, std::function<void (Monero::SubaddressRow &row)> callback) const
@@ -56,6 +173,7 @@ bool Subaddress::getRow(int index, std::function<void (Monero::SubaddressRow &ro
 bool Subaddress::addRow(quint32 accountIndex, const QString &label) const
 {
     bool r = m_subaddressImpl->addRow(accountIndex, label.toStdString());
+    m_accountIndex = accountIndex;
 
     if (r)
         getAll();
@@ -63,6 +181,54 @@ bool Subaddress::addRow(quint32 accountIndex, const QString &label) const
     return r;
 }
 
+qint64 Subaddress::addRows(quint32 accountIndex, const QStringList &labels, const std::function<void (int)> &progress) const
+{
+    quint32 first = m_walletImpl->numSubaddresses(accountIndex);
+    if (labels.isEmpty())
+        return first;
+
+    // Monero::Subaddress::addRow reloads every row of the account after each new address,
+    // go through the wallet directly and reload once at the end
+    for (int i = 0; i < labels.size(); i++) {
+        m_walletImpl->addSubaddress(accountIndex, labels[i].toStdString());
+        if (progress && ((i + 1) % 100 == 0 || i + 1 == labels.size()))
+            progress(i + 1);
+    }
+
+    quint32 total = m_walletImpl->numSubaddresses(accountIndex);
+    if (total != first + labels.size()) {
+        qWarning() << "Subaddress::addRows: expected" << first + labels.size() << "subaddresses, got" << total;
+        if (total == first)
+            return -1;
+    }
+
+    return first;
+}
+
+void Subaddress::showAddedRows(quint32 accountIndex) const
+{
+    // Rows of another account aren't shown, leave them for the next refresh
+    if (accountIndex != m_accountIndex) {
+        updateIndex();
+        return;
+    }
+
+    quint32 total = m_walletImpl->numSubaddresses(accountIndex);
+    int firstRow = count();
+    bool insert = total > static_cast<quint32>(firstRow);
+    if (insert)
+        emit rowsAboutToBeAdded(firstRow, total - 1);
+
+    {
+        QWriteLocker locker(&m_lock);
+        m_subaddressImpl->refresh(accountIndex);
+        loadRows();
+    }
+
+    if (insert)
+        emit rowsAdded();
+}
+
 bool Subaddress::setLabel(quint32 accountIndex, quint32 addressIndex, const QString &label) const
 {
     bool r = m_subaddressImpl->setLabel(accountIndex, addressIndex, label.toStdString());
@@ -73,8 +239,56 @@ bool Subaddress::setLabel(quint32 accountIndex, quint32 addressIndex, const QStr
     return r;
 }
 
+bool Subaddress::setLabels(quint32 accountIndex, const QMap<quint32, QString> &labels) const
+{
+    if (labels.isEmpty())
+        return true;
+
+    quint32 total = m_walletImpl->numSubaddresses(accountIndex);
+    for (auto it = labels.begin(); it != labels.end(); ++it) {
+        if (it.key() >= total) {
+            qWarning() << "Subaddress::setLabels: no subaddress" << accountIndex << "/" << it.key();
+            return false;
+        }
+        m_walletImpl->setSubaddressLabel(accountIndex, it.key(), it.value().toStdString());
+    }
+
+    this->refresh(accountIndex);
+    emit labelChanged();
+    return true;
+}
+
+bool Subaddress::exportRows(quint32 accountIndex, quint32 first, QIODevice *device) const
+{
+    if (!device || !device->isWritable())
+        return false;
+
+    auto escape = [](QString field) {
+        if (field.contains(',') || field.contains('"') || field.contains('\n')) {
+            field.replace('"', "\"\"");
+            field = QString("\"%1\"").arg(field);
+        }
+        return field;
+    };
+
+    QTextStream out(device);
+    out << "index,address,label\n";
+
+    quint32 total = m_walletImpl->numSubaddresses(accountIndex);
+    for (quint32 i = first; i < total; i++) {
+        out << i << ","
+            << QString::fromStdString(m_walletImpl->address(accountIndex, i)) << ","
+            << escape(QString::fromStdString(m_walletImpl->getSubaddressLabel(accountIndex, i))) << "\n";
+    }
+
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
 bool Subaddress::refresh(quint32 accountIndex) const
 {
+    TRACE_SCOPE("Subaddress::refresh");
+    m_accountIndex = accountIndex;
     bool r = m_subaddressImpl->refresh(accountIndex);
     getAll();
     return r;
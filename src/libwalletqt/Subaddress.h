@@ -11,6 +11,12 @@
 #include <QObject>
 #include <QList>
 #include <QDateTime>
+#include <QBitArray>
+#include <QHash>
+#include <QVector>
+#include <QIODevice>
+#include <QMap>
+#include <QStringList>
 
 class Subaddress : public QObject
 {
@@ -19,27 +25,56 @@ public:
     void getAll() const;
     bool getRow(int index, std::function<void (Monero::SubaddressRow &row)> callback) const;
     bool addRow(quint32 accountIndex, const QString &label) const;
+    // Creates one subaddress per label, returns the index of the first one or -1. Only touches the wallet,
+    // call showAddedRows() on the GUI thread afterwards. progress is called with the number of labels done.
+    qint64 addRows(quint32 accountIndex, const QStringList &labels, const std::function<void (int)> &progress = {}) const;
+    // Reloads the rows of the account and notifies the model of the new ones with a single insert
+    void showAddedRows(quint32 accountIndex) const;
     bool setLabel(quint32 accountIndex, quint32 addressIndex, const QString &label) const;
+    bool setLabels(quint32 accountIndex, const QMap<quint32, QString> &labels) const;
+    // Writes index,address,label as CSV for addresses [first, numSubaddresses)
+    bool exportRows(quint32 accountIndex, quint32 first, QIODevice *device) const;
     bool refresh(quint32 accountIndex) const;
     quint64 unusedLookahead() const;
     quint64 count() const;
     QString errorString() const;
     Monero::SubaddressRow* row(int index) const;
 
+    // Lookups in an index of every generated address of every account, without going through wallet2
+    bool index(const QString &address, quint32 &accountIndex, quint32 &addressIndex) const;
+    QVector<QPair<qint64, qint64>> indices(const QStringList &addresses) const;
+    QString address(quint32 accountIndex, quint32 addressIndex) const;
+    bool isUsed(quint32 accountIndex, quint32 addressIndex) const;
+    void markUsed(quint32 accountIndex, quint32 addressIndex) const;
+    void markUsed(const QVector<QPair<quint32, quint32>> &indices) const;
+    // Picks up addresses created without going through this class
+    void updateIndex() const;
+
 signals:
     void refreshStarted() const;
     void refreshFinished() const;
     void labelChanged() const;
+    void rowsAboutToBeAdded(int first, int last) const;
+    void rowsAdded() const;
 
 public slots:
 
 private:
-    explicit Subaddress(Monero::Subaddress * subaddressImpl, QObject *parent);
+    explicit Subaddress(Monero::Subaddress * subaddressImpl, Monero::Wallet * walletImpl, QObject *parent);
     friend class Wallet;
+    void loadRows() const;
+    void indexNew() const;
+
     mutable QReadWriteLock m_lock;
     Monero::Subaddress * m_subaddressImpl;
+    Monero::Wallet * m_walletImpl;
+    mutable quint32 m_accountIndex = 0;
     mutable QList<Monero::SubaddressRow*> m_rows;
     mutable quint64 m_unusedLookahead;
+
+    mutable QHash<QString, QPair<quint32, quint32>> m_index;
+    mutable QVector<QStringList> m_addresses; // per account, by address index
+    mutable QVector<QBitArray> m_used;
 };
 
 #endif // SUBADDRESS_H
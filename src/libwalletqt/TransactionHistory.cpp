@@ -5,6 +5,7 @@
 #include "TransactionInfo.h"
 #include "utils/Utils.h"
 #include "utils/AppData.h"
+#include "utils/Trace.h"
 #include "utils/config.h"
 #include "constants.h"
 #include "WalletManager.h"
@@ -45,6 +46,7 @@ TransactionInfo* TransactionHistory::transaction(int index)
 
 void TransactionHistory::refresh(quint32 accountIndex)
 {
+    TRACE_SCOPE("TransactionHistory::refresh");
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
     QDateTime firstDateTime = QDate(2014, 4, 18).startOfDay();
 #else
@@ -54,6 +56,7 @@ void TransactionHistory::refresh(quint32 accountIndex)
 
     emit refreshStarted();
 
+    QVector<QPair<quint32, quint32>> used;
     {
         QWriteLocker locker(&m_lock);
 
@@ -65,7 +68,16 @@ void TransactionHistory::refresh(quint32 accountIndex)
         m_minutesToUnlock = 0;
 
         m_pimpl->refresh();
+        m_confirmations.clear();
         for (const auto i : m_pimpl->getAll()) {
+            m_confirmations.insert(QString::fromStdString(i->hash()), i->confirmations());
+
+            if (i->direction() == Monero::TransactionInfo::Direction_In) {
+                for (uint32_t index : i->subaddrIndex()) {
+                    used.append({i->subaddrAccount(), index});
+                }
+            }
+
             if (i->subaddrAccount() != accountIndex) {
                 continue;
             }
@@ -92,6 +104,7 @@ void TransactionHistory::refresh(quint32 accountIndex)
     }
 
     emit refreshFinished();
+    emit subaddressesUsed(used);
 
     if (m_firstDateTime != firstDateTime) {
         m_firstDateTime = firstDateTime;
@@ -136,6 +149,12 @@ bool TransactionHistory::TransactionHistory::locked() const
     return m_locked;
 }
 
+QHash<QString, quint64> TransactionHistory::confirmations() const
+{
+    QReadLocker locker(&m_lock);
+    return m_confirmations;
+}
+
 
 TransactionHistory::TransactionHistory(Monero::TransactionHistory *pimpl, QObject *parent)
     : QObject(parent), m_pimpl(pimpl), m_minutesToUnlock(0), m_locked(false)
@@ -158,6 +177,9 @@ bool TransactionHistory::writeCSV(const QString &path) {
         return info1->blockHeight() < info2->blockHeight();
     });
 
+    QString preferredFiatSymbol = configSnapshot()->preferredFiatCurrency;
+    const auto &prices = appData()->prices;
+    double usdRate = prices.rate(prices.symbolId("USD"), prices.symbolId(preferredFiatSymbol));
     for (const auto &tx : transactions) {
         TransactionInfo info(tx, this);
 
@@ -167,12 +189,11 @@ bool TransactionHistory::writeCSV(const QString &path) {
 
         // calc historical fiat price
         QString fiatAmount;
-        QString preferredFiatSymbol = config()->get(Config::preferredFiatCurrency).toString();
         const double usd_price = appData()->txFiatHistory->get(timeStamp.toString("yyyyMMdd"));
         double fiat_price = usd_price * amount;
 
         if (preferredFiatSymbol != "USD")
-            fiat_price = appData()->prices.convert("USD", preferredFiatSymbol, fiat_price);
+            fiat_price = fiat_price > 0.0 ? fiat_price * usdRate : 0.0;
         double fiat_rounded = ceil(Utils::roundSignificant(fiat_price, 3) * 100.0) / 100.0;
         if (usd_price != 0)
             fiatAmount = QString::number(fiat_rounded);
@@ -7,7 +7,9 @@
 #include <functional>
 
 #include <QObject>
+#include <QHash>
 #include <QList>
+#include <QVector>
 #include <QReadWriteLock>
 #include <QDateTime>
 
@@ -38,6 +40,8 @@ public:
     QDateTime lastDateTime() const;
     quint64 minutesToUnlock() const;
     bool locked() const;
+    // txid -> confirmations, for the transactions of all accounts
+    QHash<QString, quint64> confirmations() const;
 
 signals:
     void refreshStarted() const;
@@ -45,6 +49,8 @@ signals:
     void firstDateTimeChanged() const;
     void lastDateTimeChanged() const;
     void txNoteChanged() const;
+    // (account, index) of every subaddress that received funds, across all accounts
+    void subaddressesUsed(const QVector<QPair<quint32, quint32>> &indices) const;
 
 private:
     explicit TransactionHistory(Monero::TransactionHistory * pimpl, QObject *parent = nullptr);
@@ -54,6 +60,7 @@ private:
     mutable QReadWriteLock m_lock;
     Monero::TransactionHistory * m_pimpl;
     mutable QList<TransactionInfo*> m_tinfo;
+    QHash<QString, quint64> m_confirmations;
     mutable QDateTime   m_firstDateTime;
     mutable QDateTime   m_lastDateTime;
     mutable int m_minutesToUnlock;
@@ -6,6 +6,8 @@
 #include <chrono>
 #include <thread>
 
+#include <QTemporaryDir>
+
 #include "TransactionHistory.h"
 #include "AddressBook.h"
 #include "Subaddress.h"
@@ -19,6 +21,8 @@
 #include "model/CoinsModel.h"
 
 #include "utils/ScopeGuard.h"
+#include "utils/SyncBundle.h"
+#include "utils/Trace.h"
 
 namespace {
     static constexpr char ATTRIBUTE_SUBADDRESS_ACCOUNT[] = "feather.subaddress_account";
@@ -176,11 +180,21 @@ QString Wallet::getPassword()
 
 QString Wallet::address(quint32 accountIndex, quint32 addressIndex) const
 {
+    QString address = m_subaddress->address(accountIndex, addressIndex);
+    if (!address.isEmpty()) {
+        return address;
+    }
     return QString::fromStdString(m_walletImpl->address(accountIndex, addressIndex));
 }
 
 SubaddressIndex Wallet::subaddressIndex(const QString &address) const
 {
+    quint32 account, index;
+    if (m_subaddress->index(address, account, index)) {
+        return SubaddressIndex(account, index);
+    }
+
+    // wallet2 also knows the lookahead addresses that haven't been generated yet
     std::pair<uint32_t, uint32_t> i;
     if (!m_walletImpl->subaddressIndex(address.toStdString(), i)) {
         return SubaddressIndex(-1, -1);
@@ -188,6 +202,21 @@ SubaddressIndex Wallet::subaddressIndex(const QString &address) const
     return SubaddressIndex(i.first, i.second);
 }
 
+QVector<SubaddressIndex> Wallet::subaddressIndices(const QStringList &addresses) const
+{
+    QVector<SubaddressIndex> result;
+    result.reserve(addresses.size());
+    for (const auto &index : m_subaddress->indices(addresses)) {
+        result.append(SubaddressIndex(index.first, index.second));
+    }
+    return result;
+}
+
+bool Wallet::isSubaddressUsed(quint32 accountIndex, quint32 addressIndex) const
+{
+    return m_subaddress->isUsed(accountIndex, addressIndex);
+}
+
 QString Wallet::cachePath() const
 {
     return QDir::toNativeSeparators(QString::fromStdString(m_walletImpl->filename()));
@@ -200,9 +229,33 @@ QString Wallet::keysPath() const
 
 void Wallet::store(const QString &path)
 {
+    TRACE_SCOPE("Wallet::store");
     m_walletImpl->store(path.toStdString());
 }
 
+void Wallet::storeAsync(const QString &path)
+{
+    const auto future = m_scheduler.run([this, path] {
+        // store() is not thread safe, wait for any refresh in progress
+        QMutexLocker locker(&m_asyncMutex);
+        TRACE_SCOPE("Wallet::storeAsync");
+
+        QElapsedTimer timer;
+        timer.start();
+        bool success = m_walletImpl->store(path.toStdString());
+        qint64 duration = timer.elapsed();
+
+        QString storePath = path.isEmpty() ? this->cachePath() : path;
+        qint64 bytesWritten = QFileInfo(storePath).size();
+
+        emit stored(success, duration, bytesWritten);
+    });
+
+    if (!future.first) {
+        emit stored(false, 0, 0);
+    }
+}
+
 bool Wallet::init(const QString &daemonAddress, bool trustedDaemon, quint64 upperTransactionLimit, bool isRecovering, bool isRecoveringFromDevice, quint64 restoreHeight, const QString& proxyAddress)
 {
     qDebug() << "init non async";
@@ -393,6 +446,25 @@ quint32 Wallet::numSubaddresses(quint32 accountIndex) const
 void Wallet::addSubaddress(const QString& label)
 {
     m_walletImpl->addSubaddress(currentSubaddressAccount(), label.toStdString());
+    m_subaddress->updateIndex();
+}
+void Wallet::addSubaddressesAsync(quint32 accountIndex, const QStringList &labels)
+{
+    const auto future = m_scheduler.run([this, accountIndex, labels] {
+        // libwallet is not thread safe, wait for any refresh in progress
+        QMutexLocker locker(&m_asyncMutex);
+
+        int total = labels.size();
+        qint64 first = m_subaddress->addRows(accountIndex, labels, [this, total](int done){
+            emit subaddressesProgress(done, total);
+        });
+
+        emit subaddressesAdded(accountIndex, first, total);
+    });
+
+    if (!future.first) {
+        emit subaddressesAdded(accountIndex, -1, 0);
+    }
 }
 QString Wallet::getSubaddressLabel(quint32 accountIndex, quint32 addressIndex) const
 {
@@ -495,6 +567,182 @@ bool Wallet::importOutputs(const QString& path) {
     return m_walletImpl->importOutputs(path.toStdString());
 }
 
+namespace {
+    enum ImportExportState {
+        Idle = 0,
+        Pending,
+        Running,
+        Cancelled
+    };
+}
+
+void Wallet::exportKeyImagesAsync(const QString& path, bool all) {
+    this->importExportAsync(ExportKeyImages, [this, path, all]{
+        return m_walletImpl->exportKeyImages(path.toStdString(), all) ? QString() : this->errorString();
+    });
+}
+
+void Wallet::importKeyImagesAsync(const QString& path) {
+    this->importExportAsync(ImportKeyImages, [this, path]{
+        return m_walletImpl->importKeyImages(path.toStdString()) ? QString() : this->errorString();
+    });
+}
+
+void Wallet::exportOutputsAsync(const QString& path, bool all) {
+    this->importExportAsync(ExportOutputs, [this, path, all]{
+        return m_walletImpl->exportOutputs(path.toStdString(), all) ? QString() : this->errorString();
+    });
+}
+
+void Wallet::importOutputsAsync(const QString& path) {
+    this->importExportAsync(ImportOutputs, [this, path]{
+        return m_walletImpl->importOutputs(path.toStdString()) ? QString() : this->errorString();
+    });
+}
+
+namespace {
+    const QString syncSequenceKey = "feather.sync.sequence";
+    const QString syncAcknowledgedKey = "feather.sync.acknowledged";
+    const QString syncReceivedKey = "feather.sync.received";
+}
+
+void Wallet::exportSyncBundleAsync() {
+    this->importExportAsync(ExportSyncBundle, [this]{
+        QTemporaryDir dir;
+        if (!dir.isValid()) {
+            return QString("Unable to create temporary directory");
+        }
+
+        // The offline wallet signs with key images, the view-only wallet supplies the outputs to compute them from
+        SyncBundle bundle;
+        bundle.kind = this->viewOnly() ? SyncBundle::Outputs : SyncBundle::KeyImages;
+        bundle.nettype = this->nettype();
+        bundle.walletId = SyncBundle::walletIdFor(this->address(0, 0));
+
+        quint32 sequence = this->getCacheAttribute(syncSequenceKey).toUInt();
+        quint32 acknowledged = this->getCacheAttribute(syncAcknowledgedKey).toUInt();
+
+        // Only send what was added since the last bundle if the other side confirmed it received that one
+        bundle.full = (sequence == 0 || acknowledged != sequence);
+        bundle.sequence = sequence + 1;
+        bundle.acknowledged = this->getCacheAttribute(syncReceivedKey).toUInt();
+
+        QString path = dir.filePath("bundle");
+        bool ok = (bundle.kind == SyncBundle::Outputs) ? m_walletImpl->exportOutputs(path.toStdString(), bundle.full)
+                                                       : m_walletImpl->exportKeyImages(path.toStdString(), bundle.full);
+        if (!ok) {
+            return this->errorString();
+        }
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QString("Unable to read exported data");
+        }
+        bundle.payload = file.readAll();
+
+        m_syncBundle = bundle.encode();
+        this->setCacheAttribute(syncSequenceKey, QString::number(bundle.sequence));
+        qInfo() << "Exported sync bundle" << bundle.sequence << (bundle.full ? "(full)" : "(incremental)") << m_syncBundle.size() << "bytes";
+        return QString();
+    });
+}
+
+void Wallet::importSyncBundleAsync(const QByteArray &data) {
+    this->importExportAsync(ImportSyncBundle, [this, data]{
+        SyncBundle bundle;
+        QString error;
+        if (!SyncBundle::decode(data, bundle, error)) {
+            return error;
+        }
+
+        if (bundle.nettype != this->nettype()) {
+            return QString("Sync bundle is for a different network");
+        }
+        if (bundle.walletId != SyncBundle::walletIdFor(this->address(0, 0))) {
+            return QString("Sync bundle belongs to a different wallet");
+        }
+
+        SyncBundle::Kind expected = this->viewOnly() ? SyncBundle::KeyImages : SyncBundle::Outputs;
+        if (bundle.kind != expected) {
+            return this->viewOnly() ? QString("Expected a key images bundle from the offline wallet")
+                                    : QString("Expected an outputs bundle from the view-only wallet");
+        }
+
+        quint32 received = this->getCacheAttribute(syncReceivedKey).toUInt();
+        if (!bundle.full && bundle.sequence <= received) {
+            return QString("Sync bundle was already imported");
+        }
+
+        QTemporaryDir dir;
+        if (!dir.isValid()) {
+            return QString("Unable to create temporary directory");
+        }
+
+        QString path = dir.filePath("bundle");
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(bundle.payload) != bundle.payload.size()) {
+            return QString("Unable to write bundle data");
+        }
+        file.close();
+
+        bool ok = (bundle.kind == SyncBundle::Outputs) ? m_walletImpl->importOutputs(path.toStdString())
+                                                       : m_walletImpl->importKeyImages(path.toStdString());
+        if (!ok) {
+            return this->errorString();
+        }
+
+        quint32 acknowledged = this->getCacheAttribute(syncAcknowledgedKey).toUInt();
+        this->setCacheAttribute(syncReceivedKey, QString::number(bundle.sequence));
+        this->setCacheAttribute(syncAcknowledgedKey, QString::number(std::max(acknowledged, bundle.acknowledged)));
+        qInfo() << "Imported sync bundle" << bundle.sequence << (bundle.full ? "(full)" : "(incremental)");
+        return QString();
+    });
+}
+
+QByteArray Wallet::syncBundle() const {
+    return m_syncBundle;
+}
+
+bool Wallet::cancelImportExport() {
+    int expected = Pending;
+    return m_importExportState.compare_exchange_strong(expected, Cancelled);
+}
+
+void Wallet::importExportAsync(ImportExport type, const std::function<QString()> &task) {
+    int expected = Idle;
+    if (!m_importExportState.compare_exchange_strong(expected, Pending)) {
+        emit importExportFinished(type, false, false, "Another import or export is in progress");
+        return;
+    }
+
+    const auto future = m_scheduler.run([this, type, task] {
+        // libwallet is not thread safe, wait for any refresh in progress. This is the part that can be cancelled.
+        QMutexLocker locker(&m_asyncMutex);
+
+        int expected = Pending;
+        if (!m_importExportState.compare_exchange_strong(expected, Running)) {
+            m_importExportState = Idle;
+            emit importExportFinished(type, false, true, "");
+            return;
+        }
+        emit importExportStarted(type);
+
+        QElapsedTimer timer;
+        timer.start();
+        QString error = task();
+        bool success = error.isEmpty();
+        qInfo() << "Import/export" << type << (success ? "finished" : "failed") << "in" << timer.elapsed() << "ms";
+
+        m_importExportState = Idle;
+        emit importExportFinished(type, success, false, error);
+    });
+
+    if (!future.first) {
+        m_importExportState = Idle;
+        emit importExportFinished(type, false, false, "Wallet is closing");
+    }
+}
+
 bool Wallet::importTransaction(const QString& txid) {
     std::vector<std::string> txids = {txid.toStdString()};
     return m_walletImpl->scanTransactions(txids);
@@ -590,6 +838,12 @@ bool Wallet::haveTransaction(const QString &txid)
     return m_walletImpl->haveTransaction(txid.toStdString());
 }
 
+void Wallet::runLocked(const std::function<void()> &task)
+{
+    QMutexLocker locker(&m_asyncMutex);
+    task();
+}
+
 void Wallet::startRefresh()
 {
     m_refreshEnabled = true;
@@ -605,6 +859,7 @@ PendingTransaction *Wallet::createTransaction(const QString &dst_addr, const QSt
                                               quint64 amount, quint32 mixin_count,
                                               PendingTransaction::Priority priority, const QStringList &preferredInputs)
 {
+    TRACE_SCOPE("Wallet::createTransaction");
 //    pauseRefresh();
     std::set<std::string> preferred_inputs;
     for (const auto &input : preferredInputs) {
@@ -626,6 +881,7 @@ void Wallet::createTransactionAsync(const QString &dst_addr, const QString &paym
                                     PendingTransaction::Priority priority, const QStringList &preferredInputs)
 {
     m_scheduler.run([this, dst_addr, payment_id, amount, mixin_count, priority, preferredInputs] {
+        QMutexLocker locker(&m_asyncMutex);
         PendingTransaction *tx = createTransaction(dst_addr, payment_id, amount, mixin_count, priority, preferredInputs);
         QVector<QString> address {dst_addr};
         emit transactionCreated(tx, address);
@@ -635,6 +891,7 @@ void Wallet::createTransactionAsync(const QString &dst_addr, const QString &paym
 PendingTransaction* Wallet::createTransactionMultiDest(const QVector<QString> &dst_addr, const QVector<quint64> &amount,
                                                        PendingTransaction::Priority priority, const QStringList &preferredInputs)
 {
+    TRACE_SCOPE("Wallet::createTransactionMultiDest");
 //    pauseRefresh();
 
     std::vector<std::string> dests;
@@ -665,6 +922,7 @@ void Wallet::createTransactionMultiDestAsync(const QVector<QString> &dst_addr, c
                                              PendingTransaction::Priority priority, const QStringList &preferredInputs)
 {
     m_scheduler.run([this, dst_addr, amount, priority, preferredInputs] {
+        QMutexLocker locker(&m_asyncMutex);
         PendingTransaction *tx = createTransactionMultiDest(dst_addr, amount, priority, preferredInputs);
         QVector<QString> addresses;
         for (auto &addr : dst_addr) {
@@ -674,10 +932,29 @@ void Wallet::createTransactionMultiDestAsync(const QVector<QString> &dst_addr, c
     });
 }
 
+void Wallet::prepareTransactionAsync(quint64 id, const QVector<QString> &dst_addr, const QVector<quint64> &amount, bool all,
+                                     quint32 mixin_count, PendingTransaction::Priority priority, const QStringList &preferredInputs)
+{
+    m_scheduler.run([this, id, dst_addr, amount, all, mixin_count, priority, preferredInputs] {
+        // A discarded preparation may still be running when the user sends, libwallet builds one transaction at a time
+        QMutexLocker locker(&m_asyncMutex);
+        PendingTransaction *tx;
+        if (all) {
+            tx = createTransactionAll(dst_addr[0], "", mixin_count, priority, preferredInputs);
+        } else if (dst_addr.size() == 1) {
+            tx = createTransaction(dst_addr[0], "", amount[0], mixin_count, priority, preferredInputs);
+        } else {
+            tx = createTransactionMultiDest(dst_addr, amount, priority, preferredInputs);
+        }
+        emit transactionPrepared(id, tx);
+    });
+}
+
 PendingTransaction *Wallet::createTransactionAll(const QString &dst_addr, const QString &payment_id,
                                                  quint32 mixin_count, PendingTransaction::Priority priority,
                                                  const QStringList &preferredInputs)
 {
+    TRACE_SCOPE("Wallet::createTransactionAll");
 //    pauseRefresh();
 
     std::set<std::string> preferred_inputs;
@@ -700,6 +977,7 @@ void Wallet::createTransactionAllAsync(const QString &dst_addr, const QString &p
                                        PendingTransaction::Priority priority, const QStringList &preferredInputs)
 {
     m_scheduler.run([this, dst_addr, payment_id, mixin_count, priority, preferredInputs] {
+        QMutexLocker locker(&m_asyncMutex);
         PendingTransaction *tx = createTransactionAll(dst_addr, payment_id, mixin_count, priority, preferredInputs);
         QVector<QString> address {dst_addr};
         emit transactionCreated(tx, address);
@@ -709,6 +987,7 @@ void Wallet::createTransactionAllAsync(const QString &dst_addr, const QString &p
 PendingTransaction *Wallet::createTransactionSingle(const QString &key_image, const QString &dst_addr, const size_t outputs,
         PendingTransaction::Priority priority)
 {
+    TRACE_SCOPE("Wallet::createTransactionSingle");
 //    pauseRefresh();
 
     Monero::PendingTransaction * ptImpl = m_walletImpl->createTransactionSingle(key_image.toStdString(), dst_addr.toStdString(),
@@ -723,6 +1002,7 @@ void Wallet::createTransactionSingleAsync(const QString &key_image, const QStrin
                                           PendingTransaction::Priority priority)
 {
     m_scheduler.run([this, key_image, dst_addr, outputs, priority] {
+        QMutexLocker locker(&m_asyncMutex);
         PendingTransaction *tx = createTransactionSingle(key_image, dst_addr, outputs, priority);
         QVector<QString> address {dst_addr};
         emit transactionCreated(tx, address);
@@ -732,6 +1012,7 @@ void Wallet::createTransactionSingleAsync(const QString &key_image, const QStrin
 PendingTransaction *Wallet::createTransactionSelected(const QVector<QString> &key_images, const QString &dst_addr,
                                                       size_t outputs, PendingTransaction::Priority priority)
 {
+    TRACE_SCOPE("Wallet::createTransactionSelected");
     std::vector<std::string> kis;
     for (const auto &key_image : key_images) {
         kis.push_back(key_image.toStdString());
@@ -746,6 +1027,7 @@ void Wallet::createTransactionSelectedAsync(const QVector<QString> &key_images,
                                             size_t outputs, PendingTransaction::Priority priority)
 {
     m_scheduler.run([this, key_images, dst_addr, outputs, priority] {
+        QMutexLocker locker(&m_asyncMutex);
         PendingTransaction *tx = createTransactionSelected(key_images, dst_addr, outputs, priority);
         QVector<QString> address {dst_addr};
         emit transactionCreated(tx, address);
@@ -766,6 +1048,7 @@ PendingTransaction *Wallet::createSweepUnmixableTransaction()
 void Wallet::createSweepUnmixableTransactionAsync()
 {
     m_scheduler.run([this] {
+        QMutexLocker locker(&m_asyncMutex);
         PendingTransaction *tx = createSweepUnmixableTransaction();
         QVector<QString> address {""};
         emit transactionCreated(tx, address);
@@ -896,6 +1179,37 @@ AddressBook *Wallet::addressBook() const
     return m_addressBook;
 }
 
+void Wallet::addContactsAsync(const QVector<QPair<QString, QString>> &rows)
+{
+    const auto future = m_scheduler.run([this, rows] {
+        // Monero::AddressBook::addRow reloads all of its rows after every insert, keep that off the GUI thread
+        QMutexLocker locker(&m_asyncMutex);
+
+        int total = rows.size();
+        QMap<int, QString> errors;
+        int added = m_addressBook->addRows(rows, errors, [this, total](int done){
+            emit contactsProgress(done, total);
+        });
+        locker.unlock();
+
+        // The model is reset on the GUI thread
+        QMetaObject::invokeMethod(m_addressBook, [this, added, errors]{
+            if (added > 0) {
+                m_addressBook->getAll();
+            }
+            emit contactsAdded(added, errors);
+        }, Qt::QueuedConnection);
+    });
+
+    if (!future.first) {
+        QMap<int, QString> errors;
+        for (int i = 0; i < rows.size(); i++) {
+            errors.insert(i, "Wallet is closing");
+        }
+        emit contactsAdded(0, errors);
+    }
+}
+
 AddressBookModel *Wallet::addressBookModel() const
 {
 
@@ -1371,7 +1685,7 @@ Wallet::Wallet(Monero::Wallet *w, QObject *parent)
         , m_connectionStatus(Wallet::ConnectionStatus_Disconnected)
         , m_disconnected(true)
         , m_currentSubaddressAccount(0)
-        , m_subaddress(new Subaddress(m_walletImpl->subaddress(), this))
+        , m_subaddress(new Subaddress(m_walletImpl->subaddress(), m_walletImpl, this))
         , m_subaddressModel(nullptr)
         , m_subaddressAccount(new SubaddressAccount(m_walletImpl->subaddressAccount(), this))
         , m_subaddressAccountModel(nullptr)
@@ -1379,10 +1693,13 @@ Wallet::Wallet(Monero::Wallet *w, QObject *parent)
         , m_refreshNow(false)
         , m_refreshEnabled(false)
         , m_refreshing(false)
+        , m_importExportState(0)
         , m_scheduler(this)
         , m_useSSL(true)
         , m_coins(new Coins(m_walletImpl->coins(), this))
 {
+    connect(m_history, &TransactionHistory::subaddressesUsed, m_subaddress, QOverload<const QVector<QPair<quint32, quint32>>&>::of(&Subaddress::markUsed));
+
     m_walletListener = new WalletListenerImpl(this);
     m_walletImpl->setListener(m_walletListener);
     m_currentSubaddressAccount = getCacheAttribute(ATTRIBUTE_SUBADDRESS_ACCOUNT).toUInt();
@@ -1439,6 +1756,7 @@ void Wallet::startRefreshThread()
                     // We do this to prevent to UI from getting confused about the amount of blocks that are still remaining
                     bool haveHeights = refreshHeights();
                     if (haveHeights) {
+                        TRACE_SCOPE("Wallet::refresh");
                         refresh(false);
                     }
                     last = std::chrono::steady_clock::now();
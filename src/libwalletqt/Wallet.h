@@ -100,6 +100,17 @@ public:
 
     Q_ENUM(ConnectionStatus)
 
+    enum ImportExport {
+        ExportKeyImages = 0,
+        ImportKeyImages,
+        ExportOutputs,
+        ImportOutputs,
+        ExportSyncBundle,
+        ImportSyncBundle
+    };
+
+    Q_ENUM(ImportExport)
+
     //! return connection status
     ConnectionStatus connectionStatus() const;
 
@@ -145,6 +156,9 @@ public:
 
     //! returns the subaddress index of the address
     SubaddressIndex subaddressIndex(const QString &address) const;
+    // Only covers generated addresses, unknown ones come back invalid
+    QVector<SubaddressIndex> subaddressIndices(const QStringList &addresses) const;
+    bool isSubaddressUsed(quint32 accountIndex, quint32 addressIndex) const;
 
     //! returns wallet cache file path
     QString cachePath() const;
@@ -155,7 +169,9 @@ public:
     //! saves wallet to the file by given path
     //! empty path stores in current location
     void store(const QString &path = "");
-   // void storeAsync(const QJSValue &callback, const QString &path = "");
+
+    //! stores the wallet on the wallet's scheduler, serialized with refresh
+    void storeAsync(const QString &path = "");
 
     //! initializes wallet asynchronously
     void initAsync(
@@ -201,6 +217,8 @@ public:
     quint32 numSubaddressAccounts() const;
     quint32 numSubaddresses(quint32 accountIndex) const;
     void addSubaddress(const QString& label);
+    //! creates one subaddress per label on the wallet's executor, reports through subaddressesProgress and subaddressesAdded
+    void addSubaddressesAsync(quint32 accountIndex, const QStringList &labels);
     QString getSubaddressLabel(quint32 accountIndex, quint32 addressIndex) const;
     void setSubaddressLabel(quint32 accountIndex, quint32 addressIndex, const QString &label);
     void deviceShowAddressAsync(quint32 accountIndex, quint32 addressIndex, const QString &paymentId);
@@ -230,6 +248,22 @@ public:
     bool exportOutputs(const QString& path, bool all = false);
     bool importOutputs(const QString& path);
 
+    //! async variants, run on the wallet's executor and report through importExportFinished
+    void exportKeyImagesAsync(const QString& path, bool all = false);
+    void importKeyImagesAsync(const QString& path);
+    void exportOutputsAsync(const QString& path, bool all = false);
+    void importOutputsAsync(const QString& path);
+
+    //! export/import a sync bundle for offline signing: outputs from a view-only wallet, key images from the
+    //! offline wallet, incremental since the last bundle the other side acknowledged
+    void exportSyncBundleAsync();
+    void importSyncBundleAsync(const QByteArray &data);
+    //! encoded bundle from the last successful export
+    QByteArray syncBundle() const;
+
+    //! cancel a pending import/export, fails once it has started
+    bool cancelImportExport();
+
     //! import a transaction
     bool importTransaction(const QString& txid);
 
@@ -254,6 +288,10 @@ public:
     //! does wallet have txid
     bool haveTransaction(const QString &txid);
 
+    //! runs task while no refresh, store or other locked task is using the wallet, blocks until it is done.
+    //! for worker threads that call into libwallet themselves, don't call it from the GUI thread
+    void runLocked(const std::function<void()> &task);
+
     //! refreshes the wallet
     bool refresh(bool historyAndSubaddresses = false);
 
@@ -291,6 +329,11 @@ public:
                                          PendingTransaction::Priority priority, const QStringList &preferredInputs);
 
 
+    //! creates a transaction in the background that is handed back through transactionPrepared,
+    //! single destination if dst_addr has one entry, all outputs if all is set
+    void prepareTransactionAsync(quint64 id, const QVector<QString> &dst_addr, const QVector<quint64> &amount, bool all,
+                                 quint32 mixin_count, PendingTransaction::Priority priority, const QStringList &preferredInputs);
+
     //! creates transaction with all outputs
     PendingTransaction * createTransactionAll(const QString &dst_addr, const QString &payment_id,
                                               quint32 mixin_count, PendingTransaction::Priority priority,
@@ -360,6 +403,8 @@ public:
 
     //! returns Address book
     AddressBook *addressBook() const;
+    //! adds (address, description) pairs on the wallet's executor, reports through contactsProgress and contactsAdded
+    void addContactsAsync(const QVector<QPair<QString, QString>> &rows);
 
     //! returns adress book model
     AddressBookModel *addressBookModel() const;
@@ -474,6 +519,21 @@ signals:
     // signalling only after we
     void refreshed(bool success, const QString &message);
 
+    // emitted when storeAsync finished
+    void stored(bool success, qint64 durationMs, qint64 bytesWritten);
+
+    // emitted when an async import/export starts running and when it is done
+    void importExportStarted(Wallet::ImportExport type);
+    void importExportFinished(Wallet::ImportExport type, bool success, bool cancelled, const QString &errorString);
+
+    // emitted while addSubaddressesAsync runs and when it is done, first is -1 on failure
+    void subaddressesProgress(int done, int total);
+    void subaddressesAdded(quint32 accountIndex, qint64 first, int count);
+
+    // emitted while addContactsAsync runs and when it is done, once the address book model shows the new rows
+    void contactsProgress(int done, int total);
+    void contactsAdded(int added, const QMap<int, QString> &errors);
+
     void moneySpent(const QString &txId, quint64 amount);
     void moneyReceived(const QString &txId, quint64 amount);
     void unconfirmedMoneyReceived(const QString &txId, quint64 amount);
@@ -493,6 +553,7 @@ signals:
 
     // emitted when transaction is created async
     void transactionCreated(PendingTransaction * transaction, QVector<QString> address);
+    void transactionPrepared(quint64 id, PendingTransaction * transaction);
 
     void connectionStatusChanged(int status) const;
     void currentSubaddressAccountChanged() const;
@@ -520,6 +581,7 @@ private:
     QString getProxyAddress() const;
     void setProxyAddress(QString address);
     void startRefreshThread();
+    void importExportAsync(ImportExport type, const std::function<QString()> &task);
 
     void onNewBlock(uint64_t height);
 
@@ -558,6 +620,8 @@ private:
     std::atomic<bool> m_refreshNow;
     std::atomic<bool> m_refreshEnabled;
     std::atomic<bool> m_refreshing;
+    std::atomic<int> m_importExportState;
+    QByteArray m_syncBundle;
     WalletListenerImpl *m_walletListener;
     FutureScheduler m_scheduler;
     int m_connectionTimeout = 30;
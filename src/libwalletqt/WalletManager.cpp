@@ -5,6 +5,7 @@
 #include "Wallet.h"
 
 #include "utils/ScopeGuard.h"
+#include "utils/Trace.h"
 
 class WalletPassphraseListenerImpl : public Monero::WalletListener, public PassphraseReceiver
 {
@@ -76,6 +77,7 @@ Wallet *WalletManager::createWallet(const QString &path, const QString &password
 
 Wallet *WalletManager::openWallet(const QString &path, const QString &password, NetworkType::Type nettype, quint64 kdfRounds, const QString &ringDatabasePath)
 {
+    TRACE_SCOPE("WalletManager::openWallet");
     QMutexLocker locker(&m_mutex);
     WalletPassphraseListenerImpl tmpListener(this);
     m_mutex_passphraseReceiver.lock();
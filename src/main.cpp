@@ -12,6 +12,7 @@
 #include "constants.h"
 #include "MainWindow.h"
 #include "utils/EventFilter.h"
+#include "utils/Trace.h"
 #include "WindowManager.h"
 
 #if defined(Q_OS_WIN)
@@ -90,6 +91,19 @@ if (AttachConsole(ATTACH_PARENT_PROCESS)) {
     QCommandLineOption bruteforceDictionairy(QStringList() << "bruteforce-dict", "Bruteforce dictionairy", "file");
     parser.addOption(bruteforceDictionairy);
 
+#if defined(WITH_SCANNER)
+    QCommandLineOption benchmarkQrScanOption(QStringList() << "benchmark-qr-scan", "Replay recorded camera frames through the QR scanner and report timings.", "directory");
+    parser.addOption(benchmarkQrScanOption);
+
+    QCommandLineOption benchmarkQrTransportOption(QStringList() << "benchmark-qr-transport", "Send a payload of the given size through rendered animated QR codes and report throughput.", "bytes");
+    parser.addOption(benchmarkQrTransportOption);
+#endif
+
+#if defined(HAS_TRACING)
+    QCommandLineOption traceOption(QStringList() << "trace", "Write a Chrome/Perfetto trace to the specified path on exit.", "file");
+    parser.addOption(traceOption);
+#endif
+
     bool parsed = parser.parse(argv_);
     if (!parsed) {
         qCritical() << parser.errorText();
@@ -103,7 +117,12 @@ if (AttachConsole(ATTACH_PARENT_PROCESS)) {
     bool exportContacts = parser.isSet(exportContactsOption);
     bool exportTxHistory = parser.isSet(exportTxHistoryOption);
     bool bruteforcePassword = parser.isSet(bruteforcePasswordOption);
-    bool cliMode = exportContacts || exportTxHistory || bruteforcePassword;
+#if defined(WITH_SCANNER)
+    bool benchmarkQrScan = parser.isSet(benchmarkQrScanOption) || parser.isSet(benchmarkQrTransportOption);
+#else
+    bool benchmarkQrScan = false;
+#endif
+    bool cliMode = exportContacts || exportTxHistory || bruteforcePassword || benchmarkQrScan;
 
     // Setup networkType
     if (stagenet)
@@ -123,6 +142,12 @@ if (AttachConsole(ATTACH_PARENT_PROCESS)) {
 
     SingleApplication app(argc, argv);
 
+#if defined(HAS_TRACING)
+    if (parser.isSet(traceOption)) {
+        Trace::instance()->start(parser.value(traceOption));
+    }
+#endif
+
     QApplication::setQuitOnLastWindowClosed(false);
     QApplication::setApplicationName("FeatherWallet");
 
@@ -185,6 +210,8 @@ if (AttachConsole(ATTACH_PARENT_PROCESS)) {
                 return CLI::Mode::ExportTxHistory;
             if (bruteforcePassword)
                 return CLI::Mode::BruteforcePassword;
+            if (benchmarkQrScan)
+                return CLI::Mode::BenchmarkQrScan;
             return CLI::Mode::Invalid;
         }();
 
@@ -225,6 +252,7 @@ if (AttachConsole(ATTACH_PARENT_PROCESS)) {
     qRegisterMetaType<QVector<QString>>();
     qRegisterMetaType<TxProofResult>("TxProofResult");
     qRegisterMetaType<QPair<bool, bool>>();
+    qRegisterMetaType<Wallet::ImportExport>("Wallet::ImportExport");
 
     EventFilter filter;
     app.installEventFilter(&filter);
@@ -6,6 +6,9 @@
 #include "ModelUtils.h"
 #include "utils/Utils.h"
 #include "utils/Icons.h"
+#include "libwalletqt/WalletManager.h"
+
+#include <QtConcurrent/QtConcurrent>
 
 AddressBookModel::AddressBookModel(QObject *parent, AddressBook *addressBook)
     : QAbstractTableModel(parent)
@@ -165,25 +168,62 @@ bool AddressBookModel::writeCSV(const QString &path) {
     return Utils::fileWrite(path, csv);
 }
 
-QMap<QString, QString> AddressBookModel::readCSV(const QString &path) {
+QVector<AddressBookModel::CsvRow> AddressBookModel::readCSV(const QString &path, NetworkType::Type nettype, const QSet<QString> &existing) {
+    QVector<CsvRow> rows;
     if(!Utils::fileExists(path)) {
-        return QMap<QString, QString>();
+        return rows;
     }
     QString csv = Utils::barrayToString(Utils::fileOpen(path));
     QTextStream stream(&csv);
-    QMap<QString, QString> map;
 
+    int lineNumber = 0;
     while(!stream.atEnd()) {
-        QStringList line = stream.readLine().split(",");
-        if(line.length() != 2) {
+        QString line = stream.readLine();
+        lineNumber++;
+        if(line.trimmed().isEmpty()) {
+            continue;
+        }
+
+        // Addresses can't contain a comma, descriptions can
+        int separator = line.indexOf(',');
+
+        CsvRow row;
+        row.line = lineNumber;
+        row.address = line.left(separator).trimmed();
+        if(lineNumber == 1 && row.address.compare("address", Qt::CaseInsensitive) == 0) {
+            continue;
+        }
+
+        if(separator < 0) {
+            row.error = "Expected \"address,description\"";
+        } else {
+            row.description = line.mid(separator + 1).replace("\"", "").trimmed();
+            if(row.description.isEmpty()) {
+                row.error = "Missing description";
+            }
+        }
+        rows.append(row);
+    }
+
+    QtConcurrent::blockingMap(rows, [nettype](CsvRow &row) {
+        if(row.error.isEmpty() && !WalletManager::addressValid(row.address, nettype)) {
+            row.error = "Invalid address";
+        }
+    });
+
+    QHash<QString, int> seen;
+    for(auto &row : rows) {
+        if(!row.error.isEmpty()) {
             continue;
         }
-        QString address = line.at(0);
-        QString description = line.at(1);
-        description = description.replace("\"", "");
-        if(!description.isEmpty() && !address.isEmpty()) {
-            map[description] = address;
+        if(existing.contains(row.address)) {
+            row.error = "Already in contacts";
+        } else if(seen.contains(row.address)) {
+            row.error = QString("Duplicate of line %1").arg(seen.value(row.address));
+        } else {
+            seen.insert(row.address, row.line);
         }
     }
-    return map;
+
+    return rows;
 }
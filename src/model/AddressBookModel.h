@@ -6,6 +6,10 @@
 
 #include <QAbstractTableModel>
 #include <QIcon>
+#include <QSet>
+#include <QVector>
+
+#include "utils/networktype.h"
 
 class AddressBook;
 
@@ -21,6 +25,13 @@ public:
         COUNT
     };
 
+    struct CsvRow {
+        int line = 0;
+        QString address;
+        QString description;
+        QString error; // empty if the row can be imported
+    };
+
     AddressBookModel(QObject *parent, AddressBook * addressBook);
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -35,7 +46,9 @@ public:
     bool isShowFullAddresses() const;
     void setShowFullAddresses(bool show);
     bool writeCSV(const QString &path);
-    QMap<QString, QString> readCSV(const QString &path);
+    // Parses and validates every row, addresses are checked in parallel. Doesn't touch the model,
+    // so it can run off the GUI thread.
+    static QVector<CsvRow> readCSV(const QString &path, NetworkType::Type nettype, const QSet<QString> &existing);
 
 public slots:
     void startReset();
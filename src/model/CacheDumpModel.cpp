@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "CacheDumpModel.h"
+
+#include <algorithm>
+
+#include "ModelUtils.h"
+
+CacheDumpModel::CacheDumpModel(QObject *parent)
+        : QAbstractListModel(parent)
+{
+}
+
+int CacheDumpModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_offsets.size();
+}
+
+QVariant CacheDumpModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_offsets.size()) {
+        return {};
+    }
+
+    if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
+        return this->line(index.row());
+    }
+    if (role == Qt::FontRole) {
+        return ModelUtils::getMonospaceFont();
+    }
+    return {};
+}
+
+void CacheDumpModel::clear() {
+    beginResetModel();
+    m_dump.clear();
+    m_offsets.clear();
+    endResetModel();
+}
+
+void CacheDumpModel::setDump(const QByteArray &dump) {
+    beginResetModel();
+    m_dump = dump;
+    m_offsets.clear();
+    endResetModel();
+}
+
+void CacheDumpModel::appendLines(const QVector<int> &offsets) {
+    if (offsets.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_offsets.size(), m_offsets.size() + offsets.size() - 1);
+    m_offsets.append(offsets);
+    endInsertRows();
+}
+
+int CacheDumpModel::find(const QByteArray &text, int fromRow) const {
+    if (text.isEmpty() || fromRow < 0 || fromRow >= m_offsets.size()) {
+        return -1;
+    }
+
+    // Only search what has been indexed so far
+    int last = m_dump.indexOf('\n', m_offsets.last());
+    const char *begin = m_dump.constData() + m_offsets[fromRow];
+    const char *end = m_dump.constData() + (last < 0 ? m_dump.size() : last + 1);
+
+    auto lower = [](char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    };
+    const char *match = std::search(begin, end, text.constBegin(), text.constEnd(), [&lower](char a, char b) {
+        return lower(a) == lower(b);
+    });
+    if (match == end) {
+        return -1;
+    }
+
+    int offset = static_cast<int>(match - m_dump.constData());
+    auto it = std::upper_bound(m_offsets.constBegin(), m_offsets.constEnd(), offset);
+    return static_cast<int>(it - m_offsets.constBegin()) - 1;
+}
+
+QByteArray CacheDumpModel::dump() const {
+    return m_dump;
+}
+
+QString CacheDumpModel::line(int row) const {
+    if (row < 0 || row >= m_offsets.size()) {
+        return {};
+    }
+
+    int start = m_offsets[row];
+    int end = (row + 1 < m_offsets.size()) ? m_offsets[row + 1] : m_dump.indexOf('\n', start);
+    if (end < 0) {
+        end = m_dump.size();
+    }
+    while (end > start && (m_dump[end - 1] == '\n' || m_dump[end - 1] == '\r')) {
+        end--;
+    }
+    return QString::fromUtf8(m_dump.constData() + start, end - start);
+}
+
+QVector<int> CacheDumpModel::indexLines(const QByteArray &dump, int from, int &to) {
+    QVector<int> offsets;
+    to = std::min(to, static_cast<int>(dump.size()));
+
+    int pos = from;
+    while (pos < to) {
+        offsets.append(pos);
+        int next = dump.indexOf('\n', pos);
+        pos = (next < 0) ? dump.size() : next + 1;
+    }
+    to = std::max(pos, to);
+    return offsets;
+}
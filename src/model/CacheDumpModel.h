@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_CACHEDUMPMODEL_H
+#define FEATHER_CACHEDUMPMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QVector>
+
+// One row per line of a wallet cache dump. The dump is kept as UTF-8 with the offsets of its lines,
+// a line only becomes a QString when a view asks for it.
+class CacheDumpModel : public QAbstractListModel
+{
+Q_OBJECT
+
+public:
+    explicit CacheDumpModel(QObject *parent);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void clear();
+    void setDump(const QByteArray &dump);
+    // Offsets of the first byte of each line, appended as they are indexed
+    void appendLines(const QVector<int> &offsets);
+
+    // Row of the first line at or after fromRow containing text, ignoring ASCII case, -1 if there is none
+    int find(const QByteArray &text, int fromRow) const;
+
+    QByteArray dump() const;
+    QString line(int row) const;
+
+    // Offsets of the lines of dump in [from, to), to is moved to the end of the line it falls in
+    static QVector<int> indexLines(const QByteArray &dump, int from, int &to);
+
+private:
+    QByteArray m_dump;
+    QVector<int> m_offsets;
+};
+
+#endif //FEATHER_CACHEDUMPMODEL_H
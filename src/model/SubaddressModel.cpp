@@ -17,6 +17,12 @@ SubaddressModel::SubaddressModel(QObject *parent, Subaddress *subaddress)
 {
     connect(m_subaddress, &Subaddress::refreshStarted, this, &SubaddressModel::startReset);
     connect(m_subaddress, &Subaddress::refreshFinished, this, &SubaddressModel::endReset);
+    connect(m_subaddress, &Subaddress::rowsAboutToBeAdded, [this](int first, int last){
+        beginInsertRows(QModelIndex(), first, last);
+    });
+    connect(m_subaddress, &Subaddress::rowsAdded, [this]{
+        endInsertRows();
+    });
 }
 
 void SubaddressModel::startReset(){
@@ -15,6 +15,13 @@ TransactionHistoryModel::TransactionHistoryModel(QObject *parent)
     : QAbstractTableModel(parent),
     m_transactionHistory(nullptr)
 {
+    // A currency we had no price for may have been interned
+    connect(&appData()->prices, &Prices::fiatPricesUpdated, this, [this]{
+        m_fiatCurrency.clear();
+    });
+    connect(&appData()->prices, &Prices::cryptoPricesUpdated, this, [this]{
+        m_fiatCurrency.clear();
+    });
 }
 
 void TransactionHistoryModel::setTransactionHistory(TransactionHistory *th) {
@@ -141,6 +148,8 @@ QVariant TransactionHistoryModel::data(const QModelIndex &index, int role) const
 
 QVariant TransactionHistoryModel::parseTransactionInfo(const TransactionInfo &tInfo, int column, int role) const
 {
+    auto settings = configSnapshot();
+
     switch (column)
     {
         case Column::Date:
@@ -148,8 +157,7 @@ QVariant TransactionHistoryModel::parseTransactionInfo(const TransactionInfo &tI
             if (role == Qt::UserRole) {
                 return tInfo.timestamp();
             }
-            return tInfo.timestamp().toString(QString("%1 %2 ").arg(config()->get(Config::dateFormat).toString(),
-                                                                    config()->get(Config::timeFormat).toString()));
+            return tInfo.timestamp().toString(QString("%1 %2 ").arg(settings->dateFormat, settings->timeFormat));
         }
         case Column::Description:
             return tInfo.description();
@@ -158,7 +166,7 @@ QVariant TransactionHistoryModel::parseTransactionInfo(const TransactionInfo &tI
             if (role == Qt::UserRole) {
                 return tInfo.balanceDelta();
             }
-            QString amount = QString::number(tInfo.balanceDelta() / constants::cdiv, 'f', config()->get(Config::amountPrecision).toInt());
+            QString amount = QString::number(tInfo.balanceDelta() / constants::cdiv, 'f', settings->amountPrecision);
             amount = (tInfo.direction() == TransactionInfo::Direction_Out) ? "-" + amount : "+" + amount;
             return amount;
         }
@@ -174,9 +182,9 @@ QVariant TransactionHistoryModel::parseTransactionInfo(const TransactionInfo &tI
 
             double usd_amount = usd_price * (tInfo.balanceDelta() / constants::cdiv);
 
-            QString preferredFiatCurrency = config()->get(Config::preferredFiatCurrency).toString();
+            QString preferredFiatCurrency = settings->preferredFiatCurrency;
             if (preferredFiatCurrency != "USD") {
-                usd_amount = appData()->prices.convert("USD", preferredFiatCurrency, usd_amount);
+                usd_amount = this->convertFromUsd(preferredFiatCurrency, usd_amount);
             }
             if (role == Qt::UserRole) {
                 return usd_amount;
@@ -196,6 +204,15 @@ QVariant TransactionHistoryModel::parseTransactionInfo(const TransactionInfo &tI
     }
 }
 
+double TransactionHistoryModel::convertFromUsd(const QString &currency, double amount) const {
+    if (currency != m_fiatCurrency) {
+        m_fiatCurrency = currency;
+        m_usdId = appData()->prices.symbolId("USD");
+        m_fiatId = appData()->prices.symbolId(currency);
+    }
+    return appData()->prices.convert(m_usdId, m_fiatId, amount);
+}
+
 QVariant TransactionHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const {
     Q_UNUSED(orientation)
     if (role != Qt::DisplayRole) {
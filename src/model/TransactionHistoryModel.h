@@ -48,8 +48,14 @@ signals:
 
 private:
     QVariant parseTransactionInfo(const TransactionInfo &tInfo, int column, int role) const;
+    double convertFromUsd(const QString &currency, double amount) const;
 
     TransactionHistory * m_transactionHistory;
+
+    // Price ids of the fiat column, resolved once per currency and price update
+    mutable QString m_fiatCurrency;
+    mutable int m_usdId = -1;
+    mutable int m_fiatId = -1;
 };
 
 #endif // TRANSACTIONHISTORYMODEL_H
@@ -33,9 +33,9 @@ bool TransactionHistoryProxyModel::filterAcceptsRow(int sourceRow, const QModelI
         subaddrIndex = tInfo.subaddrIndex();
     });
 
-    bool addressFound;
+    bool addressFound = false;
     for (quint32 i : subaddrIndex) {
-        QString address = m_wallet->address(subaddrAcount, i);
+        QString address = m_wallet->address(subaddrAcount, i); // served from the subaddress index
         addressFound = address.contains(m_searchRegExp);
         if (addressFound) break;
     }
@@ -6,6 +6,10 @@
 #include "utils/Utils.h"
 #include <QDir>
 #include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent/QtConcurrent>
 #include "config.h"
 
 using namespace std::chrono;
@@ -19,6 +23,15 @@ WalletKeysFile::WalletKeysFile(const QFileInfo &info, int networkType, QString a
 {
 }
 
+WalletKeysFile::WalletKeysFile(const QString &path, int networkType, QString address, qint64 modified)
+    : m_fileName(QFileInfo(path).fileName())
+    , m_modified(modified)
+    , m_path(path)
+    , m_networkType(networkType)
+    , m_address(std::move(address))
+{
+}
+
 qint64 WalletKeysFile::getModified(const QFileInfo &info) {
     qint64 m = info.lastModified().toSecsSinceEpoch();
 
@@ -30,12 +43,73 @@ qint64 WalletKeysFile::getModified(const QFileInfo &info) {
     return m;
 }
 
+int WalletKeysFile::networkTypeFromKeysFile(const QFileInfo &info, QString &address) {
+    const QString basePath = QString("%1/%2").arg(info.path(), info.baseName());
+    int networkType = NetworkType::MAINNET;
+
+    if (Utils::fileExists(basePath + ".address.txt")) {
+        QFile file(basePath + ".address.txt");
+        file.open(QFile::ReadOnly | QFile::Text);
+        const QString _address = QString::fromUtf8(file.readAll());
+
+        if (!_address.isEmpty()) {
+            address = _address;
+            if (address.startsWith("5") || address.startsWith("7"))
+                networkType = NetworkType::STAGENET;
+            else if (address.startsWith("9") || address.startsWith("B"))
+                networkType = NetworkType::TESTNET;
+        }
+        file.close();
+    }
+
+    return networkType;
+}
+
+// Like Utils::fileFind, but reports each match as soon as it is found and can be cancelled
+static void findKeysFiles(const QString &baseDir, int level, int depth, int maxPerDir, const std::atomic<bool> &cancelled,
+                          const std::function<void(const QFileInfo &)> &found)
+{
+    QDir dir(baseDir);
+    dir.setFilter(QDir::Dirs | QDir::Files | QDir::NoSymLinks | QDir::NoDot | QDir::NoDotDot);
+
+    int fileCount = 0;
+    for (const auto &fileInfo: dir.entryInfoList({"*"})) {
+        if (cancelled) return;
+
+        fileCount += 1;
+        if (fileCount > maxPerDir) return;
+        if (!fileInfo.isReadable())
+            continue;
+
+        if (fileInfo.isDir()) {
+            if (level + 1 <= depth)
+                findKeysFiles(fileInfo.filePath(), level + 1, depth, maxPerDir, cancelled, found);
+        }
+        else if (fileInfo.fileName().endsWith(".keys")) {
+            found(fileInfo);
+        }
+    }
+}
+
 // Model
 
 WalletKeysFilesModel::WalletKeysFilesModel(QObject *parent)
     : QAbstractTableModel(parent)
 {
     this->updateDirectories();
+
+    connect(this, &WalletKeysFilesModel::walletFound, this, &WalletKeysFilesModel::onWalletFound, Qt::QueuedConnection);
+    connect(this, &WalletKeysFilesModel::scanFinished, this, &WalletKeysFilesModel::onScanFinished, Qt::QueuedConnection);
+
+    // Wallet stores touch the directory a lot, only rescan once things settle down
+    m_rescanTimer.setSingleShot(true);
+    m_rescanTimer.setInterval(500);
+    connect(&m_rescanTimer, &QTimer::timeout, this, &WalletKeysFilesModel::rescanChangedDirectories);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &WalletKeysFilesModel::onDirectoryChanged);
+}
+
+WalletKeysFilesModel::~WalletKeysFilesModel() {
+    this->stopScan();
 }
 
 void WalletKeysFilesModel::clear() {
@@ -45,9 +119,13 @@ void WalletKeysFilesModel::clear() {
 }
 
 void WalletKeysFilesModel::refresh() {
+    this->stopScan();
     this->clear();
+    m_scannedPaths.clear();
+
+    // Show the wallets we know about right away, the scan adds or removes wallets as it goes
+    this->loadIndex();
     this->findWallets();
-    endResetModel();
 }
 
 void WalletKeysFilesModel::updateDirectories() {
@@ -71,50 +149,172 @@ void WalletKeysFilesModel::updateDirectories() {
 
 void WalletKeysFilesModel::findWallets() {
     qDebug() << "wallet .keys search initiated";
-    auto now = high_resolution_clock::now();
 
-    QRegularExpression rx(QRegularExpression::wildcardToRegularExpression("*.keys"));
-    QStringList walletPaths;
+    for (const auto &dir : m_walletDirectories) {
+        this->watchDirectory(dir);
+    }
+
+    m_scanCancelled = false;
+    int generation = ++m_scanGeneration;
+    QStringList directories = m_walletDirectories;
+
+    m_scanFuture = QtConcurrent::run([this, generation, directories]{
+        auto now = high_resolution_clock::now();
+
+        auto found = [this, generation](const QFileInfo &fileInfo) {
+            if (fileInfo.size() <= 0)
+                return;
+
+            QString addr;
+            int networkType = WalletKeysFile::networkTypeFromKeysFile(fileInfo, addr);
+            WalletKeysFile keysFile(fileInfo, networkType, addr);
+            emit walletFound(generation, keysFile.path(), networkType, addr, keysFile.modified());
+        };
+
+        for (auto i = 0; i != directories.length(); i++) {
+            // Scan default wallet dir (~/Monero/)
+            findKeysFiles(directories[i], 0, i == 0 ? 2 : 0, 200, m_scanCancelled, found);
+        }
+
+        auto duration = duration_cast<milliseconds>(high_resolution_clock::now() - now).count();
+        qDebug() << QString("wallet .keys search completed in %1 ms").arg(duration);
+
+        emit scanFinished(generation);
+    });
+}
+
+void WalletKeysFilesModel::stopScan() {
+    m_scanCancelled = true;
+    m_scanFuture.waitForFinished();
+}
+
+void WalletKeysFilesModel::onWalletFound(int generation, const QString &path, int networkType, const QString &address, qint64 modified) {
+    if (generation != m_scanGeneration) {
+        return;
+    }
+
+    m_scannedPaths.insert(path);
+    this->watchDirectory(QFileInfo(path).absolutePath());
 
-    for(auto i = 0; i != m_walletDirectories.length(); i++) {
-        // Scan default wallet dir (~/Monero/)
-        walletPaths << Utils::fileFind(rx, m_walletDirectories[i], 0, i == 0 ? 2 : 0, 200);
+    int row = this->rowForPath(path);
+    if (row < 0) {
+        this->addWalletKeysFile(WalletKeysFile(path, networkType, address, modified));
+        return;
     }
 
-    walletPaths.removeDuplicates();
-    for(const auto &walletPath: walletPaths) {
-        QFile walletPathFile(walletPath);
-        if(walletPathFile.size() <= 0)
+    const auto &current = m_walletKeyFiles[row];
+    if (current.modified() != modified || current.networkType() != networkType || current.address() != address) {
+        m_walletKeyFiles[row] = WalletKeysFile(path, networkType, address, modified);
+        emit dataChanged(this->index(row, 0), this->index(row, Column::COUNT - 1));
+    }
+}
+
+void WalletKeysFilesModel::onScanFinished(int generation) {
+    if (generation != m_scanGeneration) {
+        return;
+    }
+
+    // Drop indexed wallets that no longer exist
+    for (int row = m_walletKeyFiles.count() - 1; row >= 0; row--) {
+        if (!m_scannedPaths.contains(m_walletKeyFiles[row].path())) {
+            this->removeWalletKeysFile(row);
+        }
+    }
+    m_scannedPaths.clear();
+
+    this->saveIndex();
+    emit refreshFinished();
+}
+
+void WalletKeysFilesModel::onDirectoryChanged(const QString &path) {
+    m_changedDirectories.insert(path);
+    m_rescanTimer.start();
+}
+
+void WalletKeysFilesModel::rescanChangedDirectories() {
+    // Only look at the directories that changed, instead of walking everything again
+    for (const auto &dirPath : m_changedDirectories) {
+        QDir dir(dirPath);
+
+        for (int row = m_walletKeyFiles.count() - 1; row >= 0; row--) {
+            const QString &path = m_walletKeyFiles[row].path();
+            if (QFileInfo(path).absolutePath() == dir.absolutePath() && !Utils::fileExists(path)) {
+                this->removeWalletKeysFile(row);
+            }
+        }
+
+        if (!dir.exists()) {
             continue;
+        }
+
+        for (const auto &fileInfo : dir.entryInfoList({"*.keys"}, QDir::Files | QDir::NoSymLinks)) {
+            if (fileInfo.size() <= 0)
+                continue;
+
+            QString addr;
+            int networkType = WalletKeysFile::networkTypeFromKeysFile(fileInfo, addr);
+            WalletKeysFile keysFile(fileInfo, networkType, addr);
 
-        QFileInfo fileInfo(walletPath);
-        const QString absPath = fileInfo.absoluteFilePath();
-        const QString path = fileInfo.path();
-        const QString baseName = fileInfo.baseName();
-        const QString basePath = QString("%1/%2").arg(path).arg(baseName);
-        QString addr = QString("");
-        quint8 networkType = NetworkType::MAINNET;
-
-        if (Utils::fileExists(basePath + ".address.txt")) {
-            QFile file(basePath + ".address.txt");
-            file.open(QFile::ReadOnly | QFile::Text);
-            const QString _address = QString::fromUtf8(file.readAll());
-
-            if (!_address.isEmpty()) {
-                addr = _address;
-                if (addr.startsWith("5") || addr.startsWith("7"))
-                    networkType = NetworkType::STAGENET;
-                else if (addr.startsWith("9") || addr.startsWith("B"))
-                    networkType = NetworkType::TESTNET;
+            int row = this->rowForPath(keysFile.path());
+            if (row < 0) {
+                this->addWalletKeysFile(keysFile);
+            } else if (m_walletKeyFiles[row].modified() != keysFile.modified()) {
+                m_walletKeyFiles[row] = keysFile;
+                emit dataChanged(this->index(row, 0), this->index(row, Column::COUNT - 1));
             }
-            file.close();
         }
+    }
+    m_changedDirectories.clear();
 
-        this->addWalletKeysFile(WalletKeysFile(fileInfo, networkType, std::move(addr)));
+    this->saveIndex();
+}
+
+void WalletKeysFilesModel::watchDirectory(const QString &path) {
+    if (!m_watcher.directories().contains(path) && Utils::dirExists(path)) {
+        m_watcher.addPath(path);
+    }
+}
+
+QString WalletKeysFilesModel::indexPath() const {
+    return Config::defaultConfigDir().filePath("wallets.json");
+}
+
+void WalletKeysFilesModel::loadIndex() {
+    QString path = this->indexPath();
+    if (!Utils::fileExists(path)) {
+        return;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(Utils::fileOpen(path));
+    const QJsonArray wallets = doc.array();
+    if (wallets.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + wallets.count() - 1);
+    for (const auto &value : wallets) {
+        QJsonObject wallet = value.toObject();
+        m_walletKeyFiles.append(WalletKeysFile(wallet.value("path").toString(),
+                                               wallet.value("networkType").toInt(),
+                                               "",
+                                               wallet.value("modified").toVariant().toLongLong()));
     }
+    endInsertRows();
+}
 
-    auto duration = duration_cast<milliseconds>(high_resolution_clock::now() - now).count();
-    qDebug() << QString("wallet .keys search completed in %1 ms").arg(duration);
+void WalletKeysFilesModel::saveIndex() {
+    // Addresses are not stored, we only need enough to list the wallet before the scan completes
+    QJsonArray wallets;
+    for (const auto &walletKeysFile : m_walletKeyFiles) {
+        QJsonObject wallet;
+        wallet["path"] = walletKeysFile.path();
+        wallet["networkType"] = walletKeysFile.networkType();
+        wallet["modified"] = walletKeysFile.modified();
+        wallets.append(wallet);
+    }
+
+    QByteArray data = QJsonDocument(wallets).toJson(QJsonDocument::Compact);
+    Utils::fileWrite(this->indexPath(), QString::fromUtf8(data));
 }
 
 void WalletKeysFilesModel::addWalletKeysFile(const WalletKeysFile &walletKeysFile) {
@@ -123,6 +323,21 @@ void WalletKeysFilesModel::addWalletKeysFile(const WalletKeysFile &walletKeysFil
     endInsertRows();
 }
 
+void WalletKeysFilesModel::removeWalletKeysFile(int row) {
+    beginRemoveRows(QModelIndex(), row, row);
+    m_walletKeyFiles.removeAt(row);
+    endRemoveRows();
+}
+
+int WalletKeysFilesModel::rowForPath(const QString &path) const {
+    for (int i = 0; i < m_walletKeyFiles.count(); i++) {
+        if (m_walletKeyFiles[i].path() == path) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 int WalletKeysFilesModel::rowCount(const QModelIndex & parent) const {
     return parent.isValid() ? 0 : m_walletKeyFiles.count();
 }
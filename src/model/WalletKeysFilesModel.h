@@ -6,8 +6,14 @@
 
 #include <QObject>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFuture>
+#include <QSet>
 #include <QAbstractTableModel>
 #include <QSortFilterProxyModel>
+#include <QTimer>
+
+#include <atomic>
 
 #include "utils/networktype.h"
 
@@ -15,6 +21,9 @@ class WalletKeysFile
 {
 public:
     WalletKeysFile(const QFileInfo &info, int networkType, QString address);
+    WalletKeysFile(const QString &path, int networkType, QString address, qint64 modified);
+
+    static int networkTypeFromKeysFile(const QFileInfo &info, QString &address);
 
     QString fileName() const {return m_fileName;};
     qint64 modified() const {return m_modified;};
@@ -46,6 +55,7 @@ public:
     };
 
     explicit WalletKeysFilesModel(QObject *parent = nullptr);
+    ~WalletKeysFilesModel() override;
 
     Q_INVOKABLE void refresh();
     Q_INVOKABLE void clear();
@@ -58,12 +68,39 @@ public:
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
+signals:
+    void walletFound(int generation, const QString &path, int networkType, const QString &address, qint64 modified);
+    void scanFinished(int generation);
+    void refreshFinished();
+
+private slots:
+    void onWalletFound(int generation, const QString &path, int networkType, const QString &address, qint64 modified);
+    void onScanFinished(int generation);
+    void onDirectoryChanged(const QString &path);
+    void rescanChangedDirectories();
+
 private:
     void updateDirectories();
+    void stopScan();
+    void loadIndex();
+    void saveIndex();
+    void watchDirectory(const QString &path);
+    void removeWalletKeysFile(int row);
+    int rowForPath(const QString &path) const;
+    QString indexPath() const;
 
     QStringList m_walletDirectories;
 
     QList<WalletKeysFile> m_walletKeyFiles;
+
+    QFuture<void> m_scanFuture;
+    std::atomic<bool> m_scanCancelled{false};
+    int m_scanGeneration = 0;
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_rescanTimer;
+    QSet<QString> m_changedDirectories;
+    QSet<QString> m_scannedPaths;
 };
 
 class WalletKeysFilesProxyModel : public QSortFilterProxyModel
@@ -8,12 +8,14 @@
 #include <QtMultimedia/QCamera>
 #include <QtMultimedia/QCameraInfo>
 
-QrCodeScanDialog::QrCodeScanDialog(QWidget *parent)
+QrCodeScanDialog::QrCodeScanDialog(QWidget *parent, bool transport)
     : QDialog(parent)
     , ui(new Ui::QrCodeScanDialog)
+    , m_transport(transport)
 {
     ui->setupUi(this);
-    this->setWindowTitle("Scan QR Code");
+    this->setWindowTitle(transport ? "Scan animated QR Code" : "Scan QR Code");
+    ui->progress_transport->hide();
 
     QPixmap pixmap = QPixmap(":/assets/images/warning.png");
     ui->icon_warning->setPixmap(pixmap.scaledToWidth(32, Qt::SmoothTransformation));
@@ -28,18 +30,16 @@ QrCodeScanDialog::QrCodeScanDialog(QWidget *parent)
 #endif
     }
 
+    m_pipeline = new QrScanPipeline(QrScanOptions(), 0, this);
+    connect(m_pipeline, &QrScanPipeline::decoded, this, &QrCodeScanDialog::onDecoded);
+
     connect(ui->combo_camera, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &QrCodeScanDialog::onCameraSwitched);
 
     this->onCameraSwitched(0);
 
-    m_thread = new QrScanThread(this);
-    m_thread->start();
-
-    connect(m_thread, &QrScanThread::decoded, this, &QrCodeScanDialog::onDecoded);
-    connect(m_thread, &QrScanThread::notifyError, this, &QrCodeScanDialog::notifyError);
-
+    // Still captures are only needed if the backend doesn't let us probe viewfinder frames
     connect(&m_imageTimer, &QTimer::timeout, this, &QrCodeScanDialog::takeImage);
-    m_imageTimer.start(500);
+    m_imageTimer.start(100);
 }
 
 void QrCodeScanDialog::onCameraSwitched(int index) {
@@ -71,6 +71,14 @@ void QrCodeScanDialog::onCameraSwitched(int index) {
     connect(m_imageCapture.data(), QOverload<int, QCameraImageCapture::Error, const QString &>::of(&QCameraImageCapture::error),
             this, &QrCodeScanDialog::displayCaptureError);
 
+    m_probe.reset(new QVideoProbe);
+    if (m_probe->setSource(m_camera.data())) {
+        // Probed frames are only valid during the signal, the pipeline copies out the luma plane right away
+        connect(m_probe.data(), &QVideoProbe::videoFrameProbed, m_pipeline, &QrScanPipeline::addVideoFrame, Qt::DirectConnection);
+    } else {
+        m_probe.reset();
+    }
+
     m_camera->setViewfinder(ui->viewfinder);
     m_camera->start();
 }
@@ -89,34 +97,74 @@ void QrCodeScanDialog::displayCameraError()
 
 void QrCodeScanDialog::processAvailableImage(int id, const QVideoFrame &frame) {
     Q_UNUSED(id);
-    QImage img = frame.image();
-    img.convertTo(QImage::Format_RGB32);
-    m_thread->addImage(img);
+    m_pipeline->addVideoFrame(frame);
 }
 
 void QrCodeScanDialog::takeImage()
 {
+    if (m_probe) {
+        return;
+    }
     if (m_imageCapture->isReadyForCapture()) {
         m_imageCapture->capture();
     }
 }
 
 void QrCodeScanDialog::onDecoded(int type, const QString &data) {
+    Q_UNUSED(type);
+    if (FountainDecoder::isPart(data)) {
+        this->onPartDecoded(data);
+        return;
+    }
+    if (m_transport) {
+        return;
+    }
+
+    // Several decoders may report the same code
+    if (!decodedString.isEmpty()) {
+        return;
+    }
     decodedString = data;
     this->accept();
 }
 
-void QrCodeScanDialog::notifyError(const QString &msg) {
-    qDebug() << "QrScanner error: " << msg;
+void QrCodeScanDialog::onPartDecoded(const QString &data) {
+    if (!m_transport || m_decoder.isComplete()) {
+        return;
+    }
+
+    if (!m_decoder.receive(data)) {
+        // Part of another message, start over if nothing was recovered yet
+        if (m_decoder.progress() > 0) {
+            return;
+        }
+        m_decoder.reset();
+        m_decoder.receive(data);
+    }
+
+    ui->progress_transport->show();
+    ui->progress_transport->setValue(static_cast<int>(m_decoder.progress() * 100));
+    ui->progress_transport->setFormat(QString("%1 of %2 fragments (%3 frames)")
+            .arg(m_decoder.fragmentsRecovered()).arg(m_decoder.fragmentCount()).arg(m_decoder.partsReceived()));
+
+    if (!m_decoder.isComplete()) {
+        return;
+    }
+
+    if (!m_decoder.isSuccess()) {
+        qWarning() << "Animated QR code checksum mismatch, starting over";
+        m_decoder.reset();
+        ui->progress_transport->setValue(0);
+        return;
+    }
+
+    decodedData = m_decoder.message();
+    this->accept();
 }
 
 QrCodeScanDialog::~QrCodeScanDialog()
 {
-    m_thread->stop();
-    m_thread->quit();
-    if (!m_thread->wait(5000))
-    {
-        m_thread->terminate();
-        m_thread->wait();
-    }
+    m_imageTimer.stop();
+    m_probe.reset();
+    m_pipeline->stop();
 }
\ No newline at end of file
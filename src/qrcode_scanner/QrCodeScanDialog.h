@@ -9,8 +9,10 @@
 #include <QCameraImageCapture>
 #include <QTimer>
 #include <QVideoFrame>
+#include <QVideoProbe>
 
-#include "QrScanThread.h"
+#include "QrScanPipeline.h"
+#include "utils/FountainCode.h"
 
 namespace Ui {
     class QrCodeScanDialog;
@@ -21,29 +23,34 @@ class QrCodeScanDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit QrCodeScanDialog(QWidget *parent);
+    // In transport mode only animated (fountain coded) QR codes are accepted, the result is in decodedData
+    explicit QrCodeScanDialog(QWidget *parent, bool transport = false);
     ~QrCodeScanDialog() override;
 
     QString decodedString = "";
+    QByteArray decodedData;
 
 private slots:
     void onCameraSwitched(int index);
     void onDecoded(int type, const QString &data);
-    void notifyError(const QString &msg);
 
 private:
     void processAvailableImage(int id, const QVideoFrame &frame);
     void displayCaptureError(int, QCameraImageCapture::Error, const QString &errorString);
     void displayCameraError();
     void takeImage();
+    void onPartDecoded(const QString &data);
 
     QScopedPointer<Ui::QrCodeScanDialog> ui;
 
     QScopedPointer<QCamera> m_camera;
     QScopedPointer<QCameraImageCapture> m_imageCapture;
+    QScopedPointer<QVideoProbe> m_probe;
 
-    QrScanThread *m_thread;
+    QrScanPipeline *m_pipeline;
     QTimer m_imageTimer;
+    bool m_transport;
+    FountainDecoder m_decoder;
     QList<QCameraInfo> m_cameras;
 };
 
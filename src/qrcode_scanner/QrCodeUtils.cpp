@@ -2,8 +2,12 @@
 // SPDX-FileCopyrightText: 2020-2022 The Monero Project
 
 #include "QrCodeUtils.h"
+
 #include <QDebug>
 
+#include <algorithm>
+#include <cstring>
+
 bool QrCodeUtils::zimageFromQImage(const QImage &qImg, zbar::Image &dst) {
     qDebug() << qImg.format();
     switch (qImg.format()) {
@@ -33,21 +37,121 @@ QString QrCodeUtils::scanImage(const QImage &img) {
     zbar::ImageScanner scanner;
     scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_ENABLE, 1);
 
-    zbar::Image zImg;
-    int r = zimageFromQImage(img, zImg);
-    if (!r) {
-        qWarning() << "Unable to convert QImage into zbar::Image";
+    QrFrame frame = lumaFromImage(img);
+    if (frame.isNull()) {
+        qWarning() << "Unable to convert QImage into luma plane";
         return "";
     }
 
-    zbar::Image scanImg = zImg.convert(zbar_fourcc('Y', '8', '0', '0'));
-    scanner.scan(scanImg);
-
+    int type;
     QString result;
-    for (zbar::Image::SymbolIterator sym = scanImg.symbol_begin(); sym != scanImg.symbol_end(); ++sym) {
-        if (!sym->get_count()) {
+    scanFrame(scanner, frame, QrScanOptions(), type, result);
+    return result;
+}
+
+QrFrame QrCodeUtils::lumaFromImage(const QImage &image) {
+    QrFrame frame;
+    QImage gray = image.convertToFormat(QImage::Format_Grayscale8);
+    if (gray.isNull()) {
+        return frame;
+    }
+
+    frame.width = gray.width();
+    frame.height = gray.height();
+    frame.luma.resize(frame.width * frame.height);
+    char *dst = frame.luma.data();
+    for (int y = 0; y < frame.height; y++) {
+        memcpy(dst + y * frame.width, gray.constScanLine(y), frame.width);
+    }
+    return frame;
+}
+
+void QrCodeUtils::configureScanner(zbar::ImageScanner &scanner) {
+    // Skip the linear barcode decoders, they are most of the work on a frame without a QR code
+    scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_ENABLE, 0);
+    scanner.set_config(zbar::ZBAR_QRCODE, zbar::ZBAR_CFG_ENABLE, 1);
+}
+
+namespace {
+    constexpr int downscaleTarget = 640;
+    constexpr double roiFraction = 0.6;
+
+    bool scanLuma(zbar::ImageScanner &scanner, const char *data, int width, int height, int &type, QString &result) {
+        zbar::Image image(width, height, "Y800", data, static_cast<unsigned long>(width) * height);
+        if (scanner.scan(image) <= 0) {
+            return false;
+        }
+        for (auto sym = image.symbol_begin(); sym != image.symbol_end(); ++sym) {
+            type = sym->get_type();
             result = QString::fromStdString(sym->get_data());
+            return true;
         }
+        return false;
     }
-    return result;
-}
\ No newline at end of file
+
+    QByteArray downscaled(const QrFrame &frame, int factor, int &width, int &height) {
+        width = frame.width / factor;
+        height = frame.height / factor;
+        QByteArray out(width * height, Qt::Uninitialized);
+
+        const auto *src = reinterpret_cast<const uchar*>(frame.luma.constData());
+        auto *dst = reinterpret_cast<uchar*>(out.data());
+        const int area = factor * factor;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int sum = 0;
+                const uchar *block = src + (y * factor) * frame.width + x * factor;
+                for (int dy = 0; dy < factor; dy++) {
+                    for (int dx = 0; dx < factor; dx++) {
+                        sum += block[dy * frame.width + dx];
+                    }
+                }
+                dst[y * width + x] = static_cast<uchar>(sum / area);
+            }
+        }
+        return out;
+    }
+
+    QByteArray centerCrop(const QrFrame &frame, int &side) {
+        side = static_cast<int>(std::min(frame.width, frame.height) * roiFraction);
+        int left = (frame.width - side) / 2;
+        int top = (frame.height - side) / 2;
+
+        QByteArray out(side * side, Qt::Uninitialized);
+        for (int y = 0; y < side; y++) {
+            memcpy(out.data() + y * side, frame.luma.constData() + (top + y) * frame.width + left, side);
+        }
+        return out;
+    }
+}
+
+bool QrCodeUtils::scanFrame(zbar::ImageScanner &scanner, const QrFrame &frame, const QrScanOptions &options, int &type, QString &data) {
+    if (frame.isNull() || frame.luma.size() < frame.width * frame.height) {
+        return false;
+    }
+
+    try {
+        int factor = (std::max(frame.width, frame.height) + downscaleTarget - 1) / downscaleTarget;
+        if (options.downscale && factor >= 2) {
+            int width, height;
+            QByteArray small = downscaled(frame, factor, width, height);
+            if (scanLuma(scanner, small.constData(), width, height, type, data)) {
+                return true;
+            }
+        }
+
+        if (options.centerRoi) {
+            int side;
+            QByteArray roi = centerCrop(frame, side);
+            if (side > 0 && scanLuma(scanner, roi.constData(), side, side, type, data)) {
+                return true;
+            }
+        }
+
+        return scanLuma(scanner, frame.luma.constData(), frame.width, frame.height, type, data);
+    }
+    catch (const std::exception &e) {
+        qWarning() << "QR scan failed:" << e.what();
+        return false;
+    }
+}
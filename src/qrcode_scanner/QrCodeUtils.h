@@ -4,13 +4,35 @@
 #ifndef FEATHER_QRCODEUTILS_H
 #define FEATHER_QRCODEUTILS_H
 
+#include <QByteArray>
 #include <QImage>
 #include <zbar.h>
 
+// 8-bit luma plane, tightly packed (zbar's Y800)
+struct QrFrame {
+    QByteArray luma;
+    int width = 0;
+    int height = 0;
+    qint64 timestamp = 0;
+
+    bool isNull() const { return luma.isEmpty(); }
+};
+
+struct QrScanOptions {
+    bool downscale = true; // try a downscaled frame first
+    bool centerRoi = true; // then the center of the frame at full resolution
+};
+
 class QrCodeUtils {
 public:
     static bool zimageFromQImage(const QImage &qImg, zbar::Image &dst);
     static QString scanImage(const QImage &img);
+
+    static QrFrame lumaFromImage(const QImage &image);
+    static void configureScanner(zbar::ImageScanner &scanner);
+
+    // Runs the enabled passes before falling back to the full frame, stops at the first symbol found
+    static bool scanFrame(zbar::ImageScanner &scanner, const QrFrame &frame, const QrScanOptions &options, int &type, QString &data);
 };
 
 
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "QrScanBenchmark.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QRandomGenerator>
+#include <QThread>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+
+#include "QrScanPipeline.h"
+#include "qrcode/QrCode.h"
+#include "utils/config.h"
+#include "utils/FountainCode.h"
+
+namespace {
+    constexpr int timeoutMs = 30000;
+
+    QString measure(const QString &name, const QVector<QrFrame> &frames, int fps, const QrScanOptions &options, int workers) {
+        QrScanPipeline pipeline(options, workers);
+
+        std::atomic<qint64> decodedAt{-1};
+        std::atomic<qint64> frameAt{-1};
+        QObject::connect(&pipeline, &QrScanPipeline::decoded, &pipeline, [&](int, const QString &, qint64 timestamp){
+            qint64 expected = -1;
+            if (decodedAt.compare_exchange_strong(expected, pipeline.elapsed())) {
+                frameAt = timestamp;
+            }
+        }, Qt::DirectConnection);
+
+        const qint64 start = pipeline.elapsed();
+        const int interval = 1000 / std::max(fps, 1);
+        for (int i = 0; decodedAt < 0 && pipeline.elapsed() - start < timeoutMs; i++) {
+            pipeline.addFrame(frames[i % frames.size()]);
+            QThread::msleep(interval);
+        }
+        pipeline.stop();
+
+        QString result = (decodedAt < 0) ? QString("no result after %1 ms").arg(timeoutMs)
+                                         : QString("%1 ms to result (%2 ms after the decoded frame)").arg(decodedAt - start).arg(decodedAt - frameAt);
+
+        // At most one frame waits in the mailbox and one is held per worker, regardless of how far decoding falls behind
+        return QString("%1: %2, %3 worker(s), %4 frames added, %5 scanned, %6 dropped, at most %7 frames buffered")
+                .arg(name, result).arg(pipeline.workers()).arg(pipeline.framesAdded()).arg(pipeline.framesScanned())
+                .arg(pipeline.framesDropped()).arg(pipeline.workers() + 1);
+    }
+}
+
+QString QrScanBenchmark::run(const QString &path, int fps) {
+    QDir dir(path);
+    QStringList files = dir.entryList({"*.png", "*.jpg", "*.jpeg", "*.bmp", "*.pgm"}, QDir::Files, QDir::Name);
+
+    QVector<QrFrame> frames;
+    for (const auto &file : files) {
+        QImage image(dir.filePath(file));
+        if (image.isNull()) {
+            continue;
+        }
+        frames.append(QrCodeUtils::lumaFromImage(image));
+    }
+
+    if (frames.isEmpty()) {
+        return QString("No frames found in %1").arg(path);
+    }
+
+    QrScanOptions fullFrame;
+    fullFrame.downscale = false;
+    fullFrame.centerRoi = false;
+
+    QStringList report;
+    report << QString("%1 frames of %2x%3 at %4 fps").arg(frames.size()).arg(frames.first().width).arg(frames.first().height).arg(fps);
+    report << measure("full frame", frames, fps, fullFrame, 1);
+    report << measure("pipeline", frames, fps, QrScanOptions(), 0);
+    return report.join("\n");
+}
+
+QString QrScanBenchmark::runTransport(int size, double lossRate) {
+    QByteArray payload(std::max(size, 1), Qt::Uninitialized);
+    for (char &c : payload) {
+        c = static_cast<char>(QRandomGenerator::global()->bounded(256));
+    }
+
+    const int fps = config()->get(Config::animatedQrFrameRate).toInt();
+    constexpr int moduleSize = 4;
+
+    FountainEncoder encoder(payload);
+    FountainDecoder decoder;
+    zbar::ImageScanner scanner;
+    QrCodeUtils::configureScanner(scanner);
+
+    int shown = 0, lost = 0, unreadable = 0, maxWidth = 0;
+    qint64 renderMs = 0, decodeMs = 0;
+    QElapsedTimer timer;
+
+    while (!decoder.isComplete() && shown < encoder.fragmentCount() * 10 + 10) {
+        QString part = encoder.nextPart();
+        shown++;
+
+        // The camera misses some frames entirely
+        if (QRandomGenerator::global()->generateDouble() < lossRate) {
+            lost++;
+            continue;
+        }
+
+        timer.start();
+        QrCode qr(part, QrCode::Version::AUTO, QrCode::ErrorCorrectionLevel::LOW);
+        maxWidth = std::max(maxWidth, qr.width());
+        QImage image = qr.toPixmap(4).toImage();
+        image = image.scaled(image.width() * moduleSize, image.height() * moduleSize);
+        QrFrame frame = QrCodeUtils::lumaFromImage(image);
+        renderMs += timer.restart();
+
+        int type;
+        QString data;
+        bool found = QrCodeUtils::scanFrame(scanner, frame, QrScanOptions(), type, data);
+        decodeMs += timer.elapsed();
+        if (!found || !decoder.receive(data)) {
+            unreadable++;
+        }
+    }
+
+    if (!decoder.isSuccess()) {
+        return QString("Transfer of %1 bytes failed after %2 frames (%3 unreadable)").arg(payload.size()).arg(shown).arg(unreadable);
+    }
+    if (decoder.message() != payload) {
+        return QString("Transfer of %1 bytes reassembled a different payload").arg(payload.size());
+    }
+
+    double seconds = static_cast<double>(shown) / fps;
+    return QString("%1 bytes in %2 fragments: %3 frames shown (%4 lost, %5 unreadable), up to %6 modules wide\n"
+                   "%7 s at %8 fps, %9 bytes/s; render %10 ms, decode %11 ms")
+            .arg(payload.size()).arg(encoder.fragmentCount()).arg(shown).arg(lost).arg(unreadable).arg(maxWidth)
+            .arg(seconds, 0, 'f', 1).arg(fps).arg(payload.size() / seconds, 0, 'f', 0).arg(renderMs).arg(decodeMs);
+}
@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_QRSCANBENCHMARK_H
+#define FEATHER_QRSCANBENCHMARK_H
+
+#include <QString>
+
+class QrScanBenchmark
+{
+public:
+    // Replays recorded frames (images in a directory, in name order) at camera rate through the scan
+    // pipeline and reports the time until the first decode, compared against plain full-frame decoding.
+    static QString run(const QString &path, int fps = 30);
+
+    // Renders an animated QR transfer of a random payload to images, decodes them offline with a share
+    // of the frames lost and reports the throughput at the configured frame rate.
+    static QString runTransport(int size, double lossRate = 0.2);
+};
+
+#endif //FEATHER_QRSCANBENCHMARK_H
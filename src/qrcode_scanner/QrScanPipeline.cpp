@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "QrScanPipeline.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+QrScanPipeline::QrScanPipeline(const QrScanOptions &options, int workers, QObject *parent)
+    : QObject(parent)
+{
+    if (workers <= 0) {
+        workers = std::clamp(QThread::idealThreadCount() / 2, 1, 4);
+    }
+
+    m_timer.start();
+    for (int i = 0; i < workers; i++) {
+        auto *thread = new QrScanThread(&m_mailbox, options, this);
+        connect(thread, &QrScanThread::decoded, this, &QrScanPipeline::decoded, Qt::DirectConnection);
+        thread->start();
+        m_threads.append(thread);
+    }
+}
+
+QrScanPipeline::~QrScanPipeline()
+{
+    this->stop();
+}
+
+void QrScanPipeline::addVideoFrame(const QVideoFrame &frame)
+{
+    QrFrame dst;
+    if (!lumaFromVideoFrame(frame, dst)) {
+        // Compressed or RGB frames, e.g. still captures
+        dst = QrCodeUtils::lumaFromImage(frame.image());
+    }
+    this->addFrame(dst);
+}
+
+void QrScanPipeline::addImage(const QImage &image)
+{
+    this->addFrame(QrCodeUtils::lumaFromImage(image));
+}
+
+void QrScanPipeline::addFrame(QrFrame frame)
+{
+    if (frame.isNull() || m_stopped) {
+        return;
+    }
+    frame.timestamp = m_timer.elapsed();
+    m_added++;
+    m_mailbox.put(frame);
+}
+
+void QrScanPipeline::stop()
+{
+    if (m_stopped.exchange(true)) {
+        return;
+    }
+
+    m_mailbox.close();
+    for (auto *thread : m_threads) {
+        thread->wait();
+    }
+}
+
+quint64 QrScanPipeline::framesScanned() const
+{
+    quint64 scanned = 0;
+    for (const auto *thread : m_threads) {
+        scanned += thread->scanned();
+    }
+    return scanned;
+}
+
+bool QrScanPipeline::lumaFromVideoFrame(const QVideoFrame &input, QrFrame &dst)
+{
+    // Offset of the first luma sample and the distance between samples, planar formats store luma first
+    int offset, step;
+    switch (input.pixelFormat()) {
+        case QVideoFrame::Format_YUV420P:
+        case QVideoFrame::Format_YUV422P:
+        case QVideoFrame::Format_YV12:
+        case QVideoFrame::Format_NV12:
+        case QVideoFrame::Format_NV21:
+        case QVideoFrame::Format_IMC1:
+        case QVideoFrame::Format_IMC2:
+        case QVideoFrame::Format_IMC3:
+        case QVideoFrame::Format_IMC4:
+        case QVideoFrame::Format_Y8:
+            offset = 0;
+            step = 1;
+            break;
+        case QVideoFrame::Format_YUYV:
+            offset = 0;
+            step = 2;
+            break;
+        case QVideoFrame::Format_UYVY:
+            offset = 1;
+            step = 2;
+            break;
+        default:
+            return false;
+    }
+
+    QVideoFrame frame(input);
+    if (!frame.map(QAbstractVideoBuffer::ReadOnly)) {
+        return false;
+    }
+
+    const int width = frame.width();
+    const int height = frame.height();
+    const int stride = frame.bytesPerLine(0);
+    const uchar *src = frame.bits(0);
+    if (!src || width <= 0 || height <= 0 || stride < width * step) {
+        frame.unmap();
+        return false;
+    }
+
+    dst.width = width;
+    dst.height = height;
+    dst.luma.resize(width * height);
+    auto *out = reinterpret_cast<uchar*>(dst.luma.data());
+    for (int y = 0; y < height; y++) {
+        const uchar *row = src + y * stride + offset;
+        if (step == 1) {
+            memcpy(out + y * width, row, width);
+        } else {
+            for (int x = 0; x < width; x++) {
+                out[y * width + x] = row[x * step];
+            }
+        }
+    }
+
+    frame.unmap();
+    return true;
+}
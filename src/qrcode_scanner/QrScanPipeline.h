@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_QRSCANPIPELINE_H
+#define FEATHER_QRSCANPIPELINE_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+#include <QVideoFrame>
+
+#include "QrScanThread.h"
+
+// Feeds camera frames to a pool of decoder threads. Only the most recent frame is kept, YUV frames
+// are reduced to their luma plane without converting to RGB.
+class QrScanPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QrScanPipeline(const QrScanOptions &options = QrScanOptions(), int workers = 0, QObject *parent = nullptr);
+    ~QrScanPipeline() override;
+
+    // May be called from any thread
+    void addVideoFrame(const QVideoFrame &frame);
+    void addImage(const QImage &image);
+    void addFrame(QrFrame frame);
+    void stop(); // call from the owning thread
+
+    qint64 elapsed() const { return m_timer.elapsed(); }
+    quint64 framesAdded() const { return m_added; }
+    quint64 framesDropped() const { return m_mailbox.dropped(); }
+    quint64 framesScanned() const;
+    int workers() const { return m_threads.size(); }
+
+    static bool lumaFromVideoFrame(const QVideoFrame &frame, QrFrame &dst);
+
+signals:
+    // timestamp is elapsed() at the time the frame was added
+    void decoded(int type, const QString &data, qint64 timestamp);
+
+private:
+    QrFrameMailbox m_mailbox;
+    QVector<QrScanThread*> m_threads;
+    QElapsedTimer m_timer;
+    std::atomic<quint64> m_added{0};
+    std::atomic<bool> m_stopped{false};
+};
+
+#endif //FEATHER_QRSCANPIPELINE_H
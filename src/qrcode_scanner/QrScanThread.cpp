@@ -5,92 +5,62 @@
 #include <QtGlobal>
 #include <QDebug>
 
-QrScanThread::QrScanThread(QObject *parent)
-    : QThread(parent)
-    , m_running(true)
-{
-    m_scanner.set_handler(*this);
-}
-
-void QrScanThread::image_callback(zbar::Image &image)
+void QrFrameMailbox::put(const QrFrame &frame)
 {
-    qDebug() << "image_callback :  Found Code ! " ;
-    for (zbar::Image::SymbolIterator sym = image.symbol_begin(); sym != image.symbol_end(); ++sym) {
-        if (!sym->get_count()) {
-            QString data = QString::fromStdString(sym->get_data());
-            emit decoded(sym->get_type(), data);
-        }
+    QMutexLocker locker(&m_mutex);
+    if (m_closed) {
+        return;
     }
+    if (m_hasFrame) {
+        m_dropped++;
+    }
+    m_frame = frame;
+    m_hasFrame = true;
+    m_waitCondition.wakeOne();
 }
 
-void QrScanThread::processZImage(zbar::Image &image)
-{
-    m_scanner.recycle_image(image);
-    zbar::Image tmp = image.convert(zbar_fourcc('Y', '8', '0', '0'));
-    m_scanner.scan(tmp);
-    image.set_symbols(tmp.get_symbols());
-}
-
-bool QrScanThread::zimageFromQImage(const QImage &qimg, zbar::Image &dst)
+bool QrFrameMailbox::take(QrFrame &frame)
 {
-    switch (qimg.format()) {
-        case QImage::Format_RGB32 :
-        case QImage::Format_ARGB32 :
-        case QImage::Format_ARGB32_Premultiplied :
-            break;
-        default :
-            qDebug() << "Format: " << qimg.format();
-            emit notifyError(QString("Invalid QImage Format !"));
-            return false;
+    QMutexLocker locker(&m_mutex);
+    while (!m_hasFrame && !m_closed) {
+        m_waitCondition.wait(&m_mutex);
     }
-    unsigned int bpl( qimg.bytesPerLine() ), width( bpl / 4), height( qimg.height());
-    dst.set_size(width, height);
-    dst.set_format("BGR4");
-    unsigned long datalen = qimg.sizeInBytes();
-    dst.set_data(qimg.bits(), datalen);
-    if((width * 4 != bpl) || (width * height * 4 > datalen)){
-        emit notifyError(QString("QImage to Zbar::Image failed !"));
+    if (m_closed) {
         return false;
     }
+    frame = m_frame;
+    m_frame = QrFrame();
+    m_hasFrame = false;
     return true;
 }
 
-void QrScanThread::processQImage(const QImage &qimg)
+void QrFrameMailbox::close()
 {
-    try {
-        m_image = QSharedPointer<zbar::Image>(new zbar::Image());
-        if (!zimageFromQImage(qimg, *m_image))
-            return;
-        processZImage(*m_image);
-    }
-    catch(std::exception &e) {
-        qDebug() << "ERROR: " << e.what();
-        emit notifyError(e.what());
-    }
-}
-
-void QrScanThread::stop()
-{
-    m_running = false;
-    m_waitCondition.wakeOne();
+    QMutexLocker locker(&m_mutex);
+    m_closed = true;
+    m_frame = QrFrame();
+    m_hasFrame = false;
+    m_waitCondition.wakeAll();
 }
 
-void QrScanThread::addImage(const QImage &img)
+QrScanThread::QrScanThread(QrFrameMailbox *mailbox, const QrScanOptions &options, QObject *parent)
+    : QThread(parent)
+    , m_mailbox(mailbox)
+    , m_options(options)
 {
-    QMutexLocker locker(&m_mutex);
-    m_queue.append(img);
-    m_waitCondition.wakeOne();
+    QrCodeUtils::configureScanner(m_scanner);
 }
 
 void QrScanThread::run()
 {
-    while (m_running) {
-        QMutexLocker locker(&m_mutex);
-        while (m_queue.isEmpty() && m_running) {
-            m_waitCondition.wait(&m_mutex);
-        }
-        if (!m_queue.isEmpty()) {
-            processQImage(m_queue.takeFirst());
+    QrFrame frame;
+    while (m_mailbox->take(frame)) {
+        int type;
+        QString data;
+        bool found = QrCodeUtils::scanFrame(m_scanner, frame, m_options, type, data);
+        m_scanned++;
+        if (found) {
+            emit decoded(type, data, frame.timestamp);
         }
     }
-}
\ No newline at end of file
+}
@@ -7,36 +7,53 @@
 #include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
-#include <QEvent>
-#include <QCamera>
 #include <zbar.h>
 
-class QrScanThread : public QThread, public zbar::Image::Handler
+#include <atomic>
+
+#include "QrCodeUtils.h"
+
+// Single slot mailbox between the camera and the decoders. A frame that wasn't picked up yet is replaced
+// by the next one, so a slow decoder never builds up a backlog.
+class QrFrameMailbox
+{
+public:
+    void put(const QrFrame &frame);
+    // Blocks until a frame is available, returns false once the mailbox is closed
+    bool take(QrFrame &frame);
+    void close();
+
+    quint64 dropped() const { return m_dropped; }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_waitCondition;
+    QrFrame m_frame;
+    bool m_hasFrame = false;
+    bool m_closed = false;
+    std::atomic<quint64> m_dropped{0};
+};
+
+// Decoder worker, several may share one mailbox
+class QrScanThread : public QThread
 {
     Q_OBJECT
 
 public:
-    QrScanThread(QObject *parent = nullptr);
-    void addImage(const QImage &img);
-    virtual void stop();
+    QrScanThread(QrFrameMailbox *mailbox, const QrScanOptions &options, QObject *parent = nullptr);
+
+    quint64 scanned() const { return m_scanned; }
 
 signals:
-    void decoded(int type, const QString &data);
-    void notifyError(const QString &error, bool warning = false);
+    void decoded(int type, const QString &data, qint64 timestamp);
 
 protected:
-    virtual void run();
-    void processQImage(const QImage &);
-    void processZImage(zbar::Image &image);
-    virtual void image_callback(zbar::Image &image);
-    bool zimageFromQImage(const QImage&, zbar::Image &);
+    void run() override;
 
 private:
+    QrFrameMailbox *m_mailbox;
+    QrScanOptions m_options;
     zbar::ImageScanner m_scanner;
-    QSharedPointer<zbar::Image> m_image;
-    bool m_running;
-    QMutex m_mutex;
-    QWaitCondition m_waitCondition;
-    QList<QImage> m_queue;
+    std::atomic<quint64> m_scanned{0};
 };
-#endif
\ No newline at end of file
+#endif
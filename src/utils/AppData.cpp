@@ -10,7 +10,7 @@ AppData::AppData(QObject *parent)
 {
     this->initRestoreHeights();
 
-    auto genesis_timestamp = this->restoreHeights[NetworkType::Type::MAINNET]->data.firstKey();
+    auto genesis_timestamp = this->restoreHeights[NetworkType::Type::MAINNET]->genesisTimestamp();
     this->txFiatHistory = new TxFiatHistory(genesis_timestamp, Config::defaultConfigDir().path(), this);
 
     connect(&websocketNotifier()->websocketClient, &WebsocketClient::connectionEstablished, this->txFiatHistory, &TxFiatHistory::onUpdateDatabase);
@@ -34,8 +34,8 @@ void AppData::onBlockHeightsReceived(int mainnet, int stagenet) {
 
 void AppData::initRestoreHeights() {
     restoreHeights[NetworkType::TESTNET] = new RestoreHeightLookup(NetworkType::TESTNET);
-    restoreHeights[NetworkType::STAGENET] = RestoreHeightLookup::fromFile(":/assets/restore_heights_monero_stagenet.txt", NetworkType::STAGENET);
-    restoreHeights[NetworkType::MAINNET] = RestoreHeightLookup::fromFile(":/assets/restore_heights_monero_mainnet.txt", NetworkType::MAINNET);
+    restoreHeights[NetworkType::STAGENET] = new RestoreHeightLookup(NetworkType::STAGENET, RestoreHeightsData::stagenet);
+    restoreHeights[NetworkType::MAINNET] = new RestoreHeightLookup(NetworkType::MAINNET, RestoreHeightsData::mainnet);
 }
 
 AppData* AppData::instance()
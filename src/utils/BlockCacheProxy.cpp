@@ -0,0 +1,1162 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "BlockCacheProxy.h"
+
+#include <QAuthenticator>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkProxy>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSslError>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+
+#include <limits>
+#include <map>
+
+#include "byte_slice.h"
+#include "cryptonote_basic/cryptonote_format_utils.h"
+#include "rpc/core_rpc_server_commands_defs.h"
+#include "storages/portable_storage_template_helper.h"
+#include "string_tools.h"
+
+#include "constants.h"
+#include "utils/config.h"
+
+using GetBlocks = cryptonote::COMMAND_RPC_GET_BLOCKS_FAST;
+
+namespace {
+    // Blocks closer than this to the daemon's tip may still be reorganized and are not persisted
+    constexpr quint64 reorgDepth = 20;
+    constexpr qint64 maxCacheSize = 4LL * 1024 * 1024 * 1024;
+    constexpr qint64 maxRequestSize = 64 * 1024 * 1024;
+    const QByteArray binaryContentType = "application/octet-stream";
+
+    // Wallets further behind than this are fed from blocks downloaded ahead in parallel
+    constexpr quint64 restoreThreshold = 5000;
+    constexpr quint64 chunkBlocks = 1000; // the daemon's limit per request
+    constexpr int maxPrefetchChunks = 16;
+    constexpr qint64 maxPrefetchSize = 256 * 1024 * 1024;
+    constexpr int requestsPerSource = 2;
+    constexpr int maxSourceFailures = 3;
+    constexpr int chunkTimeout = 60 * 1000;
+
+    // Cached responses carry the daemon height from when they were fetched, it is refreshed at most this often
+    constexpr qint64 heightMaxAge = 10 * 1000;
+
+    const QByteArray authRealm = "feather-block-cache";
+
+    QByteArray blockHash(const std::string &blob) {
+        cryptonote::block block;
+        crypto::hash hash;
+        if (!cryptonote::parse_and_validate_block_from_blob(blob, block, hash)) {
+            return {};
+        }
+        return QByteArray::fromStdString(epee::string_tools::pod_to_hex(hash));
+    }
+
+    QByteArray randomHex(int words) {
+        QVector<quint32> data(words);
+        QRandomGenerator::system()->fillRange(data.data(), data.size());
+        return QByteArray(reinterpret_cast<const char *>(data.constData()), data.size() * sizeof(quint32)).toHex();
+    }
+
+    QByteArray md5Hex(const QByteArray &data) {
+        return QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+    }
+
+    // Parameters of a 'Digest username="...", nc=00000001, ...' authorization header
+    QHash<QByteArray, QByteArray> digestParams(const QByteArray &header) {
+        QHash<QByteArray, QByteArray> params;
+        if (!header.startsWith("Digest ")) {
+            return params;
+        }
+
+        int i = 7;
+        while (i < header.size()) {
+            while (i < header.size() && (header[i] == ' ' || header[i] == ',')) {
+                i++;
+            }
+            int eq = header.indexOf('=', i);
+            if (eq < 0) {
+                break;
+            }
+            QByteArray name = header.mid(i, eq - i).trimmed().toLower();
+            i = eq + 1;
+
+            QByteArray value;
+            if (i < header.size() && header[i] == '"') {
+                int close = header.indexOf('"', i + 1);
+                if (close < 0) {
+                    break;
+                }
+                value = header.mid(i + 1, close - i - 1);
+                i = close + 1;
+            } else {
+                int comma = header.indexOf(',', i);
+                if (comma < 0) {
+                    comma = header.size();
+                }
+                value = header.mid(i, comma - i).trimmed();
+                i = comma;
+            }
+            params.insert(name, value);
+        }
+        return params;
+    }
+
+    // Replaces the daemon height a cached response was fetched at
+    QByteArray withCurrentHeight(const QByteArray &data, quint64 height) {
+        GetBlocks::response res;
+        if (!epee::serialization::load_t_from_binary(res, data.toStdString())) {
+            return data;
+        }
+        if (height <= res.current_height) {
+            return data;
+        }
+
+        res.current_height = height;
+        epee::byte_slice body;
+        if (!epee::serialization::store_t_to_binary(res, body)) {
+            return data;
+        }
+        return QByteArray(reinterpret_cast<const char *>(body.data()), body.size());
+    }
+
+    QString networkName() {
+        switch (constants::networkType) {
+            case NetworkType::MAINNET:
+                return "mainnet";
+            case NetworkType::STAGENET:
+                return "stagenet";
+            default:
+                return "testnet";
+        }
+    }
+}
+
+struct BlockCacheProxy::PrefetchBlocks {
+    GetBlocks::response response;
+    QVector<QByteArray> hashes;
+    qint64 size = 0;
+
+    // First output of every amount in the chunk with its key and txid, the other indices follow from it
+    std::vector<cryptonote::get_outputs_out> anchors;
+    std::vector<std::pair<crypto::public_key, crypto::hash>> anchorOutputs;
+};
+
+QPointer<BlockCacheProxy> BlockCacheProxy::m_instance(nullptr);
+
+BlockCacheProxy* BlockCacheProxy::instance()
+{
+    if (!m_instance) {
+        auto *thread = new QThread(QCoreApplication::instance());
+        thread->setObjectName("BlockCacheProxy");
+
+        auto *proxy = new BlockCacheProxy(Config::defaultConfigDir().filePath(QString("cache/blocks/%1").arg(networkName())));
+        proxy->moveToThread(thread);
+        connect(proxy, &QObject::destroyed, thread, &QThread::quit, Qt::DirectConnection);
+        connect(qApp, &QCoreApplication::aboutToQuit, [proxy, thread]{
+            QMetaObject::invokeMethod(proxy, &QObject::deleteLater);
+            thread->wait();
+        });
+        thread->start();
+
+        m_instance = proxy;
+    }
+
+    return m_instance;
+}
+
+BlockCacheProxy::BlockCacheProxy(const QString &cacheDir)
+    : QObject(nullptr)
+    , m_cacheDir(cacheDir)
+    , m_username("feather")
+    , m_password(QString::fromLatin1(randomHex(8)))
+    , m_nonce(randomHex(4))
+{
+}
+
+BlockCacheProxy::~BlockCacheProxy() {
+    qDeleteAll(m_prefetches);
+    qDeleteAll(m_upstreams);
+}
+
+QString BlockCacheProxy::endpoint(const Daemon &daemon, const QList<Daemon> &mirrors) {
+    if (QThread::currentThread() != this->thread()) {
+        QString result;
+        QMetaObject::invokeMethod(this, [&]{
+            result = this->endpoint(daemon, mirrors);
+        }, Qt::BlockingQueuedConnection);
+        return result;
+    }
+
+    if (!m_indexLoaded) {
+        this->loadIndex();
+        m_indexLoaded = true;
+    }
+
+    Upstream *primary = this->upstream(daemon);
+
+    primary->mirrors.clear();
+    for (const auto &mirror : mirrors) {
+        primary->mirrors.append(this->upstream(mirror));
+    }
+
+    if (!primary->server) {
+        primary->server = new QTcpServer(this);
+        connect(primary->server, &QTcpServer::newConnection, this, [this, primary]{
+            this->onNewConnection(primary);
+        });
+
+        if (!primary->server->listen(QHostAddress::LocalHost, 0)) {
+            qWarning() << "Block cache proxy unable to listen:" << primary->server->errorString();
+            primary->server->deleteLater();
+            primary->server = nullptr;
+            return {};
+        }
+
+        qInfo() << "Block cache proxy for" << daemon.address << "listening on port" << primary->server->serverPort();
+    }
+
+    return QString("127.0.0.1:%1").arg(primary->server->serverPort());
+}
+
+BlockCacheProxy::Upstream* BlockCacheProxy::upstream(const Daemon &daemon) {
+    QString key = QStringList{daemon.address, QString::number(daemon.ssl), daemon.username, daemon.password, daemon.proxyAddress}.join("\n");
+    if (auto *upstream = m_upstreams.value(key)) {
+        return upstream;
+    }
+
+    auto *upstream = new Upstream;
+    upstream->key = key;
+    upstream->scheme = daemon.ssl ? "https" : "http";
+    upstream->address = daemon.address;
+    upstream->network = new QNetworkAccessManager(this);
+
+    if (!daemon.proxyAddress.isEmpty()) {
+        QStringList parts = daemon.proxyAddress.split(":");
+        upstream->network->setProxy(QNetworkProxy(QNetworkProxy::Socks5Proxy, parts.value(0), parts.value(1).toUShort()));
+    }
+
+    QString username = daemon.username;
+    QString password = daemon.password;
+    connect(upstream->network, &QNetworkAccessManager::authenticationRequired, [username, password](QNetworkReply *, QAuthenticator *authenticator){
+        authenticator->setUser(username);
+        authenticator->setPassword(password);
+    });
+
+    // Daemons commonly use self-signed certificates, wallet2 accepts any certificate as well
+    connect(upstream->network, &QNetworkAccessManager::sslErrors, [](QNetworkReply *reply, const QList<QSslError> &){
+        reply->ignoreSslErrors();
+    });
+
+    m_upstreams.insert(key, upstream);
+    return upstream;
+}
+
+void BlockCacheProxy::onNewConnection(Upstream *upstream) {
+    while (QTcpSocket *socket = upstream->server->nextPendingConnection()) {
+        Client client;
+        client.upstream = upstream;
+        m_clients.insert(socket, client);
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]{
+            auto it = m_clients.find(socket);
+            if (it == m_clients.end()) {
+                return;
+            }
+            it->buffer += socket->readAll();
+            this->processBuffer(socket);
+        });
+
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]{
+            m_clients.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void BlockCacheProxy::processBuffer(QTcpSocket *socket) {
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end() || it->busy) {
+        return;
+    }
+
+    // Wallets send one request at a time, a request is handled once its body is complete
+    int headerEnd = it->buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (it->buffer.size() > 64 * 1024) {
+            socket->abort();
+        }
+        return;
+    }
+
+    QList<QByteArray> lines = it->buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    if (requestLine.size() < 3) {
+        socket->abort();
+        return;
+    }
+
+    Request request;
+    request.method = requestLine[0];
+    request.path = requestLine[1];
+
+    qint64 contentLength = 0;
+    for (int i = 1; i < lines.size(); i++) {
+        int colon = lines[i].indexOf(':');
+        if (colon < 0) {
+            continue;
+        }
+        QByteArray name = lines[i].left(colon).trimmed().toLower();
+        QByteArray value = lines[i].mid(colon + 1).trimmed();
+        if (name == "content-length") {
+            contentLength = value.toLongLong();
+        } else if (name == "content-type") {
+            request.contentType = value;
+        } else if (name == "authorization") {
+            request.authorization = value;
+        }
+    }
+
+    if (contentLength < 0 || contentLength > maxRequestSize) {
+        socket->abort();
+        return;
+    }
+
+    qint64 requestSize = headerEnd + 4 + contentLength;
+    if (it->buffer.size() < requestSize) {
+        return;
+    }
+
+    request.body = it->buffer.mid(headerEnd + 4, contentLength);
+    it->buffer.remove(0, requestSize);
+    it->busy = true;
+
+    // Anything running on this machine can reach the port, only the wallets we handed the credentials to get through
+    if (!this->isAuthorized(request)) {
+        QByteArray challenge = "WWW-Authenticate: Digest realm=\"" + authRealm + "\", nonce=\"" + m_nonce + "\", qop=\"auth\", algorithm=MD5\r\n";
+        this->writeResponse(socket, 401, "Unauthorized", "text/plain", {}, challenge);
+        return;
+    }
+
+    this->handleRequest(socket, it->upstream, request);
+}
+
+bool BlockCacheProxy::isAuthorized(const Request &request) const {
+    auto params = digestParams(request.authorization);
+    if (params.value("username") != m_username.toUtf8() || params.value("realm") != authRealm
+        || params.value("nonce") != m_nonce || params.value("uri") != request.path) {
+        return false;
+    }
+
+    QByteArray ha1 = md5Hex(m_username.toUtf8() + ":" + authRealm + ":" + m_password.toUtf8());
+    QByteArray algorithm = params.value("algorithm", "MD5").toUpper();
+    if (algorithm == "MD5-SESS") {
+        ha1 = md5Hex(ha1 + ":" + m_nonce + ":" + params.value("cnonce"));
+    } else if (algorithm != "MD5") {
+        return false;
+    }
+    QByteArray ha2 = md5Hex(request.method + ":" + request.path);
+
+    QByteArray expected;
+    QByteArray qop = params.value("qop");
+    if (qop == "auth") {
+        expected = md5Hex(ha1 + ":" + m_nonce + ":" + params.value("nc") + ":" + params.value("cnonce") + ":auth:" + ha2);
+    } else if (qop.isEmpty()) {
+        expected = md5Hex(ha1 + ":" + m_nonce + ":" + ha2);
+    } else {
+        return false;
+    }
+
+    return params.value("response").toLower() == expected;
+}
+
+void BlockCacheProxy::handleRequest(QTcpSocket *socket, Upstream *upstream, const Request &request) {
+    if (request.path == "/getblocks.bin" || request.path == "/get_blocks.bin") {
+        this->handleGetBlocks(socket, upstream, request);
+        return;
+    }
+
+    this->forward(socket, upstream, request);
+}
+
+void BlockCacheProxy::forward(QTcpSocket *socket, Upstream *upstream, const Request &request) {
+    this->send(upstream, request, [this, client = QPointer<QTcpSocket>(socket)](QNetworkReply *reply){
+        this->writeReply(client, reply, reply->readAll());
+    });
+}
+
+void BlockCacheProxy::handleGetBlocks(QTcpSocket *socket, Upstream *upstream, const Request &request) {
+    GetBlocks::request req;
+    if (!epee::serialization::load_t_from_binary(req, request.body.toStdString()) || req.requested_info == GetBlocks::POOL_ONLY || req.block_ids.empty()) {
+        this->forward(socket, upstream, request);
+        return;
+    }
+
+    int variant = (req.prune ? 1 : 0) | (req.no_miner_tx ? 2 : 0);
+    QByteArray topHash = QByteArray::fromStdString(epee::string_tools::pod_to_hex(req.block_ids.front()));
+
+    // The daemon starts at the requested height, or at the wallet's top block if it is on the main chain
+    qint64 startHeight = -1;
+    if (req.start_height > 0) {
+        startHeight = req.start_height;
+    } else if (m_heights.contains(topHash)) {
+        startHeight = m_heights.value(topHash);
+    }
+
+    if (startHeight >= 0) {
+        int index = this->findChunk(startHeight, variant, req.start_height > 0 ? QByteArray() : topHash);
+        if (index >= 0) {
+            Chunk &chunk = m_chunks[startHeight][index];
+            QFile file(chunk.path);
+            QByteArray data = file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+            if (!data.isEmpty()) {
+                chunk.lastUsed = QDateTime::currentMSecsSinceEpoch();
+                quint64 end = chunk.end;
+                this->refreshHeight(upstream, [this, upstream, variant, end, data, client = QPointer<QTcpSocket>(socket)]{
+                    this->writeResponse(client, 200, "OK", binaryContentType, withCurrentHeight(data, upstream->daemonHeight));
+                    this->startPrefetch(upstream, variant, end, upstream->daemonHeight);
+                });
+                return;
+            }
+            this->removeChunksFrom(startHeight);
+        }
+    }
+
+    Prefetch *prefetch = m_prefetches.value(QString("%1:%2").arg(upstream->key, QString::number(variant)));
+    if (prefetch && req.start_height == 0 && prefetch->heights.contains(topHash)) {
+        if (this->servePrefetch(prefetch, socket, prefetch->heights.value(topHash), request)) {
+            return;
+        }
+    }
+
+    QString key = QString("%1:%2:%3").arg(QString::fromLatin1(topHash), QString::number(req.start_height), QString::number(variant));
+    auto pending = m_pending.find(key);
+    if (pending != m_pending.end()) {
+        pending->append(socket);
+        return;
+    }
+    m_pending.insert(key, {});
+
+    this->send(upstream, request, [this, key, upstream, variant, client = QPointer<QTcpSocket>(socket)](QNetworkReply *reply){
+        QByteArray data = reply->readAll();
+        QVector<QPointer<QTcpSocket>> waiters = m_pending.take(key);
+
+        QByteArray shared;
+        BlockRange range;
+        if (reply->error() == QNetworkReply::NoError) {
+            shared = this->processBlocks(data, variant, range);
+        }
+
+        this->writeReply(client, reply, data);
+
+        // Pool info in the original response belongs to the requesting wallet, the others get it stripped
+        for (const auto &waiter : waiters) {
+            if (shared.isEmpty()) {
+                this->writeReply(waiter, reply, data);
+            } else {
+                this->writeResponse(waiter, 200, "OK", binaryContentType, shared);
+            }
+        }
+
+        if (!shared.isEmpty()) {
+            upstream->daemonHeight = std::max(upstream->daemonHeight, range.currentHeight);
+            upstream->heightUpdated = QDateTime::currentMSecsSinceEpoch();
+            this->startPrefetch(upstream, variant, range.end, range.currentHeight);
+        }
+    });
+}
+
+void BlockCacheProxy::send(Upstream *upstream, const Request &request, const std::function<void(QNetworkReply*)> &callback) {
+    QNetworkRequest req(QUrl(QString("%1://%2%3").arg(upstream->scheme, upstream->address, QString::fromUtf8(request.path))));
+    if (!request.contentType.isEmpty()) {
+        req.setHeader(QNetworkRequest::ContentTypeHeader, request.contentType);
+    }
+    if (request.timeout > 0) {
+        req.setTransferTimeout(request.timeout);
+    }
+
+    QNetworkReply *reply = upstream->network->sendCustomRequest(req, request.method, request.body);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, upstream, request, callback]{
+        reply->deleteLater();
+
+        // Same as wallet2's SSL autodetection, fall back to plain HTTP if the daemon does not speak TLS
+        if (reply->error() == QNetworkReply::SslHandshakeFailedError && upstream->scheme == "https") {
+            qInfo() << "Block cache proxy: TLS handshake failed, falling back to HTTP for" << upstream->address;
+            upstream->scheme = "http";
+            this->send(upstream, request, callback);
+            return;
+        }
+
+        callback(reply);
+    });
+}
+
+void BlockCacheProxy::refreshHeight(Upstream *upstream, const std::function<void()> &callback) {
+    if (QDateTime::currentMSecsSinceEpoch() - upstream->heightUpdated < heightMaxAge) {
+        callback();
+        return;
+    }
+
+    // On failure the last known height is used, the wallet gets its own error on the next request to the daemon
+    Request request{"GET", "/get_height", {}, {}, chunkTimeout};
+    this->send(upstream, request, [upstream, callback](QNetworkReply *reply){
+        QJsonObject result = QJsonDocument::fromJson(reply->readAll()).object();
+        if (reply->error() == QNetworkReply::NoError && result.value("status").toString() == CORE_RPC_STATUS_OK) {
+            upstream->daemonHeight = std::max<quint64>(upstream->daemonHeight, result.value("height").toVariant().toULongLong());
+            upstream->heightUpdated = QDateTime::currentMSecsSinceEpoch();
+        }
+        callback();
+    });
+}
+
+void BlockCacheProxy::writeReply(const QPointer<QTcpSocket> &socket, QNetworkReply *reply, const QByteArray &body) {
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 0) {
+        qWarning() << "Block cache proxy upstream error:" << reply->errorString();
+        this->writeResponse(socket, 502, "Bad Gateway", "text/plain", {});
+        return;
+    }
+
+    QByteArray reason = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toByteArray();
+    this->writeResponse(socket, status, reason, reply->header(QNetworkRequest::ContentTypeHeader).toByteArray(), body);
+}
+
+void BlockCacheProxy::writeResponse(const QPointer<QTcpSocket> &socket, int status, const QByteArray &reason, const QByteArray &contentType, const QByteArray &body, const QByteArray &headers) {
+    if (!socket) {
+        return;
+    }
+
+    QByteArray header = "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n";
+    if (!contentType.isEmpty()) {
+        header += "Content-Type: " + contentType + "\r\n";
+    }
+    header += headers;
+    header += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    header += "Connection: keep-alive\r\n\r\n";
+
+    socket->write(header);
+    socket->write(body);
+
+    auto it = m_clients.find(socket.data());
+    if (it != m_clients.end()) {
+        it->busy = false;
+        if (!it->buffer.isEmpty()) {
+            this->processBuffer(socket.data());
+        }
+    }
+}
+
+QByteArray BlockCacheProxy::processBlocks(const QByteArray &data, int variant, BlockRange &range) {
+    GetBlocks::response res;
+    if (!epee::serialization::load_t_from_binary(res, data.toStdString()) || res.status != CORE_RPC_STATUS_OK || res.blocks.empty()) {
+        return {};
+    }
+
+    quint64 start = res.start_height;
+    quint64 end = start + res.blocks.size() - 1;
+    range = {start, end, res.current_height};
+
+    QHash<quint64, QByteArray> hashes;
+    auto hashAt = [&](quint64 height) -> QByteArray {
+        if (!hashes.contains(height)) {
+            hashes.insert(height, blockHash(res.blocks[height - start].block));
+        }
+        return hashes.value(height);
+    };
+
+    QByteArray firstHash = hashAt(start);
+    QByteArray lastHash = hashAt(end);
+    if (firstHash.isEmpty() || lastHash.isEmpty()) {
+        return {};
+    }
+
+    // Drop cached ranges that no longer match the daemon's chain
+    quint64 forkHeight = std::numeric_limits<quint64>::max();
+    for (const auto &chunks : m_chunks) {
+        for (const auto &chunk : chunks) {
+            if (chunk.start >= start && chunk.start <= end && hashAt(chunk.start) != chunk.firstHash) {
+                forkHeight = std::min(forkHeight, chunk.start);
+            }
+            if (chunk.end >= start && chunk.end <= end && hashAt(chunk.end) != chunk.lastHash) {
+                forkHeight = std::min(forkHeight, chunk.end);
+            }
+        }
+    }
+    if (forkHeight != std::numeric_limits<quint64>::max()) {
+        qInfo() << "Block cache proxy: reorg detected at height" << forkHeight;
+        this->removeChunksFrom(forkHeight);
+    }
+
+    // Pool info is specific to the requesting wallet
+    res.pool_info_extent = GetBlocks::NONE;
+    res.added_pool_txs.clear();
+    res.remaining_added_pool_txids.clear();
+    res.removed_pool_txids.clear();
+
+    epee::byte_slice stripped;
+    if (!epee::serialization::store_t_to_binary(res, stripped)) {
+        return {};
+    }
+    QByteArray body(reinterpret_cast<const char *>(stripped.data()), stripped.size());
+
+    if (end + reorgDepth <= res.current_height && this->findChunk(start, variant, firstHash) < 0) {
+        Chunk chunk{start, end, variant, firstHash, lastHash, {}, body.size(), QDateTime::currentMSecsSinceEpoch()};
+        this->storeChunk(chunk, body);
+    }
+
+    return body;
+}
+
+void BlockCacheProxy::loadIndex() {
+    QDir dir(m_cacheDir);
+    if (!dir.exists()) {
+        return;
+    }
+
+    // <start>-<end>-<variant>-<first hash>-<last hash>.bin
+    for (const auto &info : dir.entryInfoList({"*.bin"}, QDir::Files)) {
+        QStringList parts = info.completeBaseName().split("-");
+        if (parts.size() != 5) {
+            continue;
+        }
+
+        Chunk chunk{parts[0].toULongLong(), parts[1].toULongLong(), parts[2].toInt(), parts[3].toLatin1(), parts[4].toLatin1(),
+                    info.absoluteFilePath(), info.size(), info.lastModified().toMSecsSinceEpoch()};
+        m_chunks[chunk.start].append(chunk);
+        m_totalSize += chunk.size;
+    }
+
+    this->rebuildHeights();
+    this->evict();
+    qDebug() << "Block cache proxy loaded" << m_heights.size() << "boundaries," << m_totalSize / (1024 * 1024) << "MiB";
+}
+
+int BlockCacheProxy::findChunk(quint64 start, int variant, const QByteArray &firstHash) const {
+    const auto chunks = m_chunks.value(start);
+    for (int i = 0; i < chunks.size(); i++) {
+        if (chunks[i].variant == variant && (firstHash.isEmpty() || chunks[i].firstHash == firstHash)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void BlockCacheProxy::storeChunk(const Chunk &chunk, const QByteArray &data) {
+    if (!QDir().mkpath(m_cacheDir)) {
+        return;
+    }
+
+    Chunk stored = chunk;
+    stored.path = QDir(m_cacheDir).filePath(QString("%1-%2-%3-%4-%5.bin").arg(QString::number(chunk.start), QString::number(chunk.end),
+                  QString::number(chunk.variant), QString::fromLatin1(chunk.firstHash), QString::fromLatin1(chunk.lastHash)));
+
+    QSaveFile file(stored.path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "Block cache proxy unable to write" << stored.path;
+        return;
+    }
+
+    m_chunks[stored.start].append(stored);
+    m_heights.insert(stored.firstHash, stored.start);
+    m_heights.insert(stored.lastHash, stored.end);
+    m_totalSize += stored.size;
+
+    this->evict();
+}
+
+void BlockCacheProxy::removeChunksFrom(quint64 height) {
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        auto &chunks = it.value();
+        for (int i = chunks.size() - 1; i >= 0; i--) {
+            if (chunks[i].end >= height) {
+                QFile::remove(chunks[i].path);
+                m_totalSize -= chunks[i].size;
+                chunks.remove(i);
+            }
+        }
+        it = chunks.isEmpty() ? m_chunks.erase(it) : std::next(it);
+    }
+
+    this->rebuildHeights();
+}
+
+void BlockCacheProxy::evict() {
+    while (m_totalSize > maxCacheSize && !m_chunks.isEmpty()) {
+        quint64 oldestStart = 0;
+        int oldestIndex = -1;
+        qint64 oldestUsed = std::numeric_limits<qint64>::max();
+
+        for (auto it = m_chunks.constBegin(); it != m_chunks.constEnd(); ++it) {
+            for (int i = 0; i < it.value().size(); i++) {
+                if (it.value()[i].lastUsed < oldestUsed) {
+                    oldestUsed = it.value()[i].lastUsed;
+                    oldestStart = it.key();
+                    oldestIndex = i;
+                }
+            }
+        }
+
+        if (oldestIndex < 0) {
+            break;
+        }
+
+        auto &chunks = m_chunks[oldestStart];
+        QFile::remove(chunks[oldestIndex].path);
+        m_totalSize -= chunks[oldestIndex].size;
+        chunks.remove(oldestIndex);
+        if (chunks.isEmpty()) {
+            m_chunks.remove(oldestStart);
+        }
+    }
+
+    this->rebuildHeights();
+}
+
+void BlockCacheProxy::rebuildHeights() {
+    m_heights.clear();
+    for (const auto &chunks : m_chunks) {
+        for (const auto &chunk : chunks) {
+            m_heights.insert(chunk.firstHash, chunk.start);
+            m_heights.insert(chunk.lastHash, chunk.end);
+        }
+    }
+}
+
+void BlockCacheProxy::startPrefetch(Upstream *upstream, int variant, quint64 position, quint64 currentHeight) {
+    QString key = QString("%1:%2").arg(upstream->key, QString::number(variant));
+    Prefetch *prefetch = m_prefetches.value(key);
+
+    // Only wallets far behind the daemon, i.e. restores, are worth downloading ahead for
+    if (currentHeight < position + restoreThreshold) {
+        if (prefetch && prefetch->waiters.isEmpty() && !prefetch->chunks.isEmpty()) {
+            prefetch->generation = ++m_prefetchGeneration;
+            prefetch->chunks.clear();
+            prefetch->heights.clear();
+            prefetch->bufferedSize = 0;
+        }
+        return;
+    }
+
+    if (!prefetch) {
+        prefetch = new Prefetch;
+        prefetch->key = key;
+        prefetch->generation = ++m_prefetchGeneration;
+        prefetch->primary = upstream;
+        prefetch->variant = variant;
+        m_prefetches.insert(key, prefetch);
+        qInfo() << "Block cache proxy: downloading blocks ahead from" << upstream->mirrors.size() + 1 << "nodes";
+    }
+
+    prefetch->position = position;
+    this->trimPrefetch(prefetch);
+    this->schedulePrefetch(prefetch);
+}
+
+bool BlockCacheProxy::servePrefetch(Prefetch *prefetch, QTcpSocket *socket, quint64 height, const Request &request) {
+    auto covering = [prefetch](quint64 h) -> const PrefetchChunk* {
+        auto it = prefetch->chunks.upperBound(h);
+        if (it == prefetch->chunks.begin()) {
+            return nullptr;
+        }
+        --it;
+        return h <= it->end ? &it.value() : nullptr;
+    };
+
+    // The wallet already has the block at height, the response starts there and continues with the next ones
+    const PrefetchChunk *next = covering(height + 1);
+    if (!next) {
+        return false;
+    }
+    if (!next->blocks) {
+        prefetch->waiters.append({socket, height, request});
+        return true;
+    }
+
+    GetBlocks::response res;
+    res.status = CORE_RPC_STATUS_OK;
+    res.untrusted = false;
+    res.start_height = height;
+    res.current_height = prefetch->primary->daemonHeight;
+    res.daemon_time = 0;
+    res.pool_info_extent = GetBlocks::NONE;
+
+    quint64 h = height;
+    while (res.blocks.size() < chunkBlocks) {
+        const PrefetchChunk *chunk = covering(h);
+        if (!chunk || !chunk->blocks) {
+            break;
+        }
+        const auto &blocks = chunk->blocks->response;
+        for (; h <= chunk->end && res.blocks.size() < chunkBlocks; h++) {
+            res.blocks.push_back(blocks.blocks[h - chunk->start]);
+            res.output_indices.push_back(blocks.output_indices[h - chunk->start]);
+        }
+    }
+
+    epee::byte_slice body;
+    if (res.blocks.size() < 2 || !epee::serialization::store_t_to_binary(res, body)) {
+        return false;
+    }
+
+    this->writeResponse(socket, 200, "OK", binaryContentType, QByteArray(reinterpret_cast<const char *>(body.data()), body.size()));
+
+    prefetch->position = h - 1;
+    this->trimPrefetch(prefetch);
+    this->schedulePrefetch(prefetch);
+    return true;
+}
+
+void BlockCacheProxy::schedulePrefetch(Prefetch *prefetch) {
+    QVector<Upstream*> sources;
+    for (auto *source : QVector<Upstream*>{prefetch->primary} + prefetch->primary->mirrors) {
+        if (source->failures < maxSourceFailures) {
+            sources.append(source);
+        }
+    }
+    if (sources.isEmpty()) {
+        return;
+    }
+
+    int inFlight = 0;
+    for (const auto &chunk : prefetch->chunks) {
+        if (!chunk.blocks) {
+            inFlight++;
+        }
+    }
+
+    // The reorder buffer is bounded, a slow chunk holds back downloads further ahead
+    while (inFlight < sources.size() * requestsPerSource && prefetch->chunks.size() < maxPrefetchChunks && prefetch->bufferedSize < maxPrefetchSize) {
+        quint64 next = prefetch->position + 1;
+        for (const auto &chunk : prefetch->chunks) {
+            if (chunk.start > next) {
+                break;
+            }
+            next = std::max(next, chunk.end + 1);
+        }
+
+        // Leave the blocks near the tip to the regular path
+        if (next + chunkBlocks + reorgDepth > prefetch->primary->daemonHeight) {
+            break;
+        }
+
+        Upstream *source = sources[prefetch->nextSource++ % sources.size()];
+        this->fetchChunk(prefetch, source, next);
+        inFlight++;
+    }
+}
+
+void BlockCacheProxy::fetchChunk(Prefetch *prefetch, Upstream *source, quint64 start) {
+    GetBlocks::request req;
+    req.requested_info = GetBlocks::BLOCKS_ONLY;
+    req.start_height = start;
+    req.prune = prefetch->variant & 1;
+    req.no_miner_tx = prefetch->variant & 2;
+    req.pool_info_since = 0;
+
+    epee::byte_slice body;
+    if (!epee::serialization::store_t_to_binary(req, body)) {
+        return;
+    }
+
+    prefetch->chunks.insert(start, {start, start + chunkBlocks - 1, source, {}});
+
+    Request request{"POST", "/getblocks.bin", binaryContentType, QByteArray(reinterpret_cast<const char *>(body.data()), body.size()), chunkTimeout};
+    QString key = prefetch->key;
+    quint64 generation = prefetch->generation;
+
+    this->send(source, request, [this, key, generation, start, source](QNetworkReply *reply){
+        Prefetch *prefetch = this->prefetchFor(key, generation);
+        if (!prefetch) {
+            return;
+        }
+
+        if (reply->error() != QNetworkReply::NoError) {
+            qDebug() << "Block cache proxy: chunk at" << start << "from" << source->address << "failed:" << reply->errorString();
+            this->onChunkFailed(prefetch, start, source);
+            return;
+        }
+
+        // Parsing and hashing a chunk takes a while, keep it off the proxy thread
+        QByteArray data = reply->readAll();
+        auto *watcher = new QFutureWatcher<QSharedPointer<PrefetchBlocks>>(this);
+        connect(watcher, &QFutureWatcher<QSharedPointer<PrefetchBlocks>>::finished, this, [this, watcher, key, generation, start, source]{
+            watcher->deleteLater();
+            this->onChunkVerified(key, generation, start, source, watcher->result());
+        });
+        watcher->setFuture(QtConcurrent::run([data, start]{
+            return BlockCacheProxy::verifyChunk(data, start);
+        }));
+    });
+}
+
+QSharedPointer<BlockCacheProxy::PrefetchBlocks> BlockCacheProxy::verifyChunk(const QByteArray &data, quint64 start) {
+    auto blocks = QSharedPointer<PrefetchBlocks>::create();
+    auto &res = blocks->response;
+    if (!epee::serialization::load_t_from_binary(res, data.toStdString()) || res.status != CORE_RPC_STATUS_OK) {
+        return {};
+    }
+    if (res.start_height != start || res.blocks.empty() || res.blocks.size() != res.output_indices.size()) {
+        return {};
+    }
+
+    // Global output indices count up per amount in chain order, within a chunk they must be consecutive
+    struct OutputRun {
+        bool anchored = false;
+        uint64_t next = 0;
+    };
+    std::map<uint64_t, OutputRun> runs;
+
+    // Every block must link to the previous one and commit to the transactions that came with it
+    crypto::hash prevHash = crypto::null_hash;
+    for (size_t i = 0; i < res.blocks.size(); i++) {
+        const auto &entry = res.blocks[i];
+
+        cryptonote::block block;
+        crypto::hash hash;
+        if (!cryptonote::parse_and_validate_block_from_blob(entry.block, block, hash)) {
+            return {};
+        }
+        if (i > 0 && block.prev_id != prevHash) {
+            return {};
+        }
+        if (block.tx_hashes.size() != entry.txs.size()) {
+            return {};
+        }
+
+        std::vector<cryptonote::transaction> txs(entry.txs.size());
+        for (size_t j = 0; j < entry.txs.size(); j++) {
+            const auto &tx = entry.txs[j];
+            cryptonote::transaction &parsed = txs[j];
+            crypto::hash txHash;
+            if (entry.pruned && tx.prunable_hash != crypto::null_hash) {
+                if (!cryptonote::parse_and_validate_tx_base_from_blob(tx.blob, parsed)) {
+                    return {};
+                }
+                txHash = cryptonote::get_pruned_transaction_hash(parsed, tx.prunable_hash);
+            } else if (!cryptonote::parse_and_validate_tx_from_blob(tx.blob, parsed, txHash)) {
+                return {};
+            }
+            if (txHash != block.tx_hashes[j]) {
+                return {};
+            }
+        }
+
+        // The miner transaction comes first, its indices are left out of no_miner_tx responses
+        const auto &indices = res.output_indices[i].indices;
+        if (indices.size() != txs.size() + 1) {
+            return {};
+        }
+        for (size_t j = 0; j <= txs.size(); j++) {
+            const cryptonote::transaction &tx = j == 0 ? block.miner_tx : txs[j - 1];
+            const auto &txIndices = indices[j].indices;
+            bool known = !txIndices.empty() || tx.vout.empty();
+            if ((known && txIndices.size() != tx.vout.size()) || (!known && j > 0)) {
+                return {};
+            }
+
+            for (size_t k = 0; k < tx.vout.size(); k++) {
+                // RingCT outputs, coinbase included, are indexed under amount 0
+                uint64_t amount = tx.version >= 2 ? 0 : tx.vout[k].amount;
+                OutputRun &run = runs[amount];
+                if (!known) {
+                    run.next++;
+                    continue;
+                }
+
+                if (!run.anchored) {
+                    crypto::public_key outputKey;
+                    if (!cryptonote::get_output_public_key(tx.vout[k], outputKey)) {
+                        return {};
+                    }
+                    blocks->anchors.push_back({amount, txIndices[k]});
+                    blocks->anchorOutputs.emplace_back(outputKey, j == 0 ? cryptonote::get_transaction_hash(tx) : block.tx_hashes[j - 1]);
+                    run.anchored = true;
+                } else if (txIndices[k] != run.next) {
+                    return {};
+                }
+                run.next = txIndices[k] + 1;
+            }
+        }
+
+        prevHash = hash;
+        blocks->hashes.append(QByteArray::fromStdString(epee::string_tools::pod_to_hex(hash)));
+    }
+
+    blocks->size = data.size();
+    return blocks;
+}
+
+void BlockCacheProxy::onChunkVerified(const QString &key, quint64 generation, quint64 start, Upstream *source, const QSharedPointer<PrefetchBlocks> &blocks) {
+    Prefetch *prefetch = this->prefetchFor(key, generation);
+    if (!prefetch) {
+        return;
+    }
+
+    if (!blocks) {
+        qWarning() << "Block cache proxy: chunk at" << start << "from" << source->address << "failed verification";
+        this->onChunkFailed(prefetch, start, source);
+        return;
+    }
+
+    if (source == prefetch->primary) {
+        this->onChunkReady(prefetch, start, blocks);
+        return;
+    }
+
+    // Anchor the chunk to the connected node's chain, the blocks are linked by hash so checking the last one suffices
+    quint64 end = start + blocks->hashes.size() - 1;
+    QJsonObject body{{"jsonrpc", "2.0"}, {"id", "0"}, {"method", "get_block_header_by_height"}, {"params", QJsonObject{{"height", (qint64)end}}}};
+    Request request{"POST", "/json_rpc", "application/json", QJsonDocument(body).toJson(QJsonDocument::Compact), chunkTimeout};
+
+    this->send(prefetch->primary, request, [this, key, generation, start, source, blocks](QNetworkReply *reply){
+        Prefetch *prefetch = this->prefetchFor(key, generation);
+        if (!prefetch) {
+            return;
+        }
+
+        QJsonObject header = QJsonDocument::fromJson(reply->readAll()).object().value("result").toObject().value("block_header").toObject();
+        if (header.value("hash").toString().toLatin1() != blocks->hashes.last()) {
+            qWarning() << "Block cache proxy: chunk at" << start << "from" << source->address << "is not on the connected node's chain";
+            this->onChunkFailed(prefetch, start, source);
+            return;
+        }
+
+        this->checkOutputIndices(key, generation, start, source, blocks);
+    });
+}
+
+void BlockCacheProxy::checkOutputIndices(const QString &key, quint64 generation, quint64 start, Upstream *source, const QSharedPointer<PrefetchBlocks> &blocks) {
+    Prefetch *prefetch = this->prefetchFor(key, generation);
+    if (!prefetch) {
+        return;
+    }
+
+    if (blocks->anchors.empty()) {
+        this->onChunkReady(prefetch, start, blocks);
+        return;
+    }
+
+    // The block hashes don't cover the output indices, a wallet given wrong ones builds unspendable transactions.
+    // The connected node has to agree on the first output of every amount, the rest are consecutive to it.
+    cryptonote::COMMAND_RPC_GET_OUTPUTS_BIN::request req;
+    req.outputs = blocks->anchors;
+    req.get_txid = true;
+
+    epee::byte_slice body;
+    if (!epee::serialization::store_t_to_binary(req, body)) {
+        this->onChunkFailed(prefetch, start, source);
+        return;
+    }
+
+    Request request{"POST", "/get_outs.bin", binaryContentType, QByteArray(reinterpret_cast<const char *>(body.data()), body.size()), chunkTimeout};
+    this->send(prefetch->primary, request, [this, key, generation, start, source, blocks](QNetworkReply *reply){
+        Prefetch *prefetch = this->prefetchFor(key, generation);
+        if (!prefetch) {
+            return;
+        }
+
+        cryptonote::COMMAND_RPC_GET_OUTPUTS_BIN::response res;
+        bool valid = reply->error() == QNetworkReply::NoError && epee::serialization::load_t_from_binary(res, reply->readAll().toStdString())
+                     && res.status == CORE_RPC_STATUS_OK && res.outs.size() == blocks->anchorOutputs.size();
+        for (size_t i = 0; valid && i < res.outs.size(); i++) {
+            valid = res.outs[i].key == blocks->anchorOutputs[i].first && res.outs[i].txid == blocks->anchorOutputs[i].second;
+        }
+
+        if (!valid) {
+            qWarning() << "Block cache proxy: chunk at" << start << "from" << source->address << "has output indices the connected node disagrees with";
+            this->onChunkFailed(prefetch, start, source);
+            return;
+        }
+
+        this->onChunkReady(prefetch, start, blocks);
+    });
+}
+
+void BlockCacheProxy::onChunkReady(Prefetch *prefetch, quint64 start, const QSharedPointer<PrefetchBlocks> &blocks) {
+    auto it = prefetch->chunks.find(start);
+    if (it == prefetch->chunks.end() || it->blocks) {
+        return;
+    }
+
+    it->source->failures = 0;
+    it->blocks = blocks;
+    it->end = start + blocks->hashes.size() - 1;
+    for (int i = 0; i < blocks->hashes.size(); i++) {
+        prefetch->heights.insert(blocks->hashes[i], start + i);
+    }
+    prefetch->bufferedSize += blocks->size;
+
+    this->serviceWaiters(prefetch);
+    this->schedulePrefetch(prefetch);
+}
+
+void BlockCacheProxy::onChunkFailed(Prefetch *prefetch, quint64 start, Upstream *source) {
+    prefetch->chunks.remove(start);
+
+    if (++source->failures == maxSourceFailures) {
+        qInfo() << "Block cache proxy: no longer downloading blocks from" << source->address;
+    }
+
+    // Another source picks up the range, waiters fall back to the regular path if none is left
+    this->schedulePrefetch(prefetch);
+    this->serviceWaiters(prefetch);
+}
+
+void BlockCacheProxy::serviceWaiters(Prefetch *prefetch) {
+    QVector<PrefetchWaiter> waiters;
+    waiters.swap(prefetch->waiters);
+
+    QString key = prefetch->key;
+    quint64 generation = prefetch->generation;
+
+    for (const auto &waiter : waiters) {
+        if (!waiter.socket) {
+            continue;
+        }
+
+        Prefetch *current = this->prefetchFor(key, generation);
+        if (current && this->servePrefetch(current, waiter.socket, waiter.height, waiter.request)) {
+            continue;
+        }
+
+        auto it = m_clients.find(waiter.socket.data());
+        if (it != m_clients.end()) {
+            this->handleGetBlocks(waiter.socket, it->upstream, waiter.request);
+        }
+    }
+}
+
+void BlockCacheProxy::trimPrefetch(Prefetch *prefetch) {
+    // Drop chunks the wallet has moved past, the chunk holding its top block is kept
+    for (auto it = prefetch->chunks.begin(); it != prefetch->chunks.end();) {
+        if (it->end >= prefetch->position) {
+            ++it;
+            continue;
+        }
+
+        if (it->blocks) {
+            for (const auto &hash : it->blocks->hashes) {
+                prefetch->heights.remove(hash);
+            }
+            prefetch->bufferedSize -= it->blocks->size;
+        }
+        it = prefetch->chunks.erase(it);
+    }
+}
+
+BlockCacheProxy::Prefetch* BlockCacheProxy::prefetchFor(const QString &key, quint64 generation) const {
+    Prefetch *prefetch = m_prefetches.value(key);
+    if (!prefetch || prefetch->generation != generation) {
+        return nullptr;
+    }
+    return prefetch;
+}
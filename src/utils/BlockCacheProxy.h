@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_BLOCKCACHEPROXY_H
+#define FEATHER_BLOCKCACHEPROXY_H
+
+#include <QHash>
+#include <QMap>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QVector>
+
+#include <functional>
+
+// Local HTTP proxy that wallets connect to in place of their daemon. Block requests (/getblocks.bin) are
+// deduplicated across wallets and persisted to a bounded on-disk cache, everything else is passed through.
+// Wallets that are far behind (restores) are fed from chunks downloaded in parallel from several nodes.
+// Lives on its own thread, endpoint() may be called from any thread. Requests must carry the per-session
+// credentials from username() and password() (HTTP digest auth), other local processes are turned away.
+class BlockCacheProxy : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Daemon {
+        QString address;
+        bool ssl = false;
+        QString username;
+        QString password;
+        QString proxyAddress;
+    };
+
+    static BlockCacheProxy* instance();
+    ~BlockCacheProxy() override;
+
+    // Returns a local address ("127.0.0.1:port") that forwards to the given daemon, or an empty string on failure.
+    // Mirrors are additional nodes that restores may download blocks from, verified against the daemon's chain.
+    QString endpoint(const Daemon &daemon, const QList<Daemon> &mirrors = {});
+
+    // Generated at startup and never changed, safe to read from any thread
+    QString username() const { return m_username; }
+    QString password() const { return m_password; }
+
+private:
+    struct Upstream {
+        QString key;
+        QString scheme;
+        QString address;
+        QTcpServer *server = nullptr;
+        QNetworkAccessManager *network = nullptr;
+        QVector<Upstream*> mirrors;
+        quint64 daemonHeight = 0;
+        qint64 heightUpdated = 0;
+        int failures = 0;
+    };
+
+    struct Client {
+        Upstream *upstream = nullptr;
+        QByteArray buffer;
+        bool busy = false;
+    };
+
+    struct Request {
+        QByteArray method;
+        QByteArray path;
+        QByteArray contentType;
+        QByteArray body;
+        int timeout = 0;
+        QByteArray authorization;
+    };
+
+    struct Chunk {
+        quint64 start;
+        quint64 end;
+        int variant;
+        QByteArray firstHash;
+        QByteArray lastHash;
+        QString path;
+        qint64 size;
+        qint64 lastUsed;
+    };
+
+    struct BlockRange {
+        quint64 start = 0;
+        quint64 end = 0;
+        quint64 currentHeight = 0;
+    };
+
+    // Parsed and verified blocks of a prefetched chunk
+    struct PrefetchBlocks;
+
+    struct PrefetchChunk {
+        quint64 start;
+        quint64 end; // expected end while in flight
+        Upstream *source = nullptr;
+        QSharedPointer<PrefetchBlocks> blocks;
+    };
+
+    struct PrefetchWaiter {
+        QPointer<QTcpSocket> socket;
+        quint64 height;
+        Request request;
+    };
+
+    struct Prefetch {
+        QString key;
+        quint64 generation;
+        Upstream *primary;
+        int variant;
+        quint64 position; // height of the wallet's top block, the next request starts here
+        QMap<quint64, PrefetchChunk> chunks;
+        QHash<QByteArray, quint64> heights;
+        qint64 bufferedSize = 0;
+        int nextSource = 0;
+        QVector<PrefetchWaiter> waiters;
+    };
+
+    explicit BlockCacheProxy(const QString &cacheDir);
+
+    Upstream* upstream(const Daemon &daemon);
+    void onNewConnection(Upstream *upstream);
+    void processBuffer(QTcpSocket *socket);
+    bool isAuthorized(const Request &request) const;
+    void handleRequest(QTcpSocket *socket, Upstream *upstream, const Request &request);
+    void handleGetBlocks(QTcpSocket *socket, Upstream *upstream, const Request &request);
+    void forward(QTcpSocket *socket, Upstream *upstream, const Request &request);
+    void send(Upstream *upstream, const Request &request, const std::function<void(QNetworkReply*)> &callback);
+    void refreshHeight(Upstream *upstream, const std::function<void()> &callback);
+    void writeReply(const QPointer<QTcpSocket> &socket, QNetworkReply *reply, const QByteArray &body);
+    void writeResponse(const QPointer<QTcpSocket> &socket, int status, const QByteArray &reason, const QByteArray &contentType, const QByteArray &body, const QByteArray &headers = {});
+
+    QByteArray processBlocks(const QByteArray &data, int variant, BlockRange &range);
+    void loadIndex();
+    int findChunk(quint64 start, int variant, const QByteArray &firstHash) const;
+    void storeChunk(const Chunk &chunk, const QByteArray &data);
+    void removeChunksFrom(quint64 height);
+    void evict();
+    void rebuildHeights();
+
+    void startPrefetch(Upstream *upstream, int variant, quint64 position, quint64 currentHeight);
+    bool servePrefetch(Prefetch *prefetch, QTcpSocket *socket, quint64 height, const Request &request);
+    void schedulePrefetch(Prefetch *prefetch);
+    void fetchChunk(Prefetch *prefetch, Upstream *source, quint64 start);
+    void onChunkVerified(const QString &key, quint64 generation, quint64 start, Upstream *source, const QSharedPointer<PrefetchBlocks> &blocks);
+    void checkOutputIndices(const QString &key, quint64 generation, quint64 start, Upstream *source, const QSharedPointer<PrefetchBlocks> &blocks);
+    void onChunkReady(Prefetch *prefetch, quint64 start, const QSharedPointer<PrefetchBlocks> &blocks);
+    void onChunkFailed(Prefetch *prefetch, quint64 start, Upstream *source);
+    void serviceWaiters(Prefetch *prefetch);
+    void trimPrefetch(Prefetch *prefetch);
+    Prefetch* prefetchFor(const QString &key, quint64 generation) const;
+    static QSharedPointer<PrefetchBlocks> verifyChunk(const QByteArray &data, quint64 start);
+
+    static QPointer<BlockCacheProxy> m_instance;
+
+    QString m_cacheDir;
+    bool m_indexLoaded = false;
+
+    const QString m_username;
+    const QString m_password;
+    const QByteArray m_nonce;
+
+    QHash<QString, Upstream*> m_upstreams;
+    QHash<QTcpSocket*, Client> m_clients;
+
+    // In-flight block requests, other wallets asking for the same range wait on the first fetch
+    QHash<QString, QVector<QPointer<QTcpSocket>>> m_pending;
+
+    // Cached ranges by start height, and the heights of their boundary blocks by hash
+    QMap<quint64, QVector<Chunk>> m_chunks;
+    QHash<QByteArray, quint64> m_heights;
+    qint64 m_totalSize = 0;
+
+    QHash<QString, Prefetch*> m_prefetches;
+    quint64 m_prefetchGeneration = 0;
+};
+
+inline BlockCacheProxy* blockCacheProxy()
+{
+    return BlockCacheProxy::instance();
+}
+
+#endif //FEATHER_BLOCKCACHEPROXY_H
@@ -0,0 +1,307 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "ConsolidationPlanner.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+
+#include "utils/config.h"
+#include "libwalletqt/Coins.h"
+
+namespace {
+    // Sweeps constructed ahead of the commit
+    constexpr int constructAhead = 2;
+
+    const QStringList stateNames = {"waiting", "constructing", "constructed", "committing", "committed", "failed", "cancelled"};
+}
+
+ConsolidationPlanner::ConsolidationPlanner(QSharedPointer<AppContext> ctx, QObject *parent)
+        : QObject(parent)
+        , m_ctx(std::move(ctx))
+{
+    m_pool.setMaxThreadCount(1);
+
+    m_commitTimer.setSingleShot(true);
+    connect(&m_commitTimer, &QTimer::timeout, this, &ConsolidationPlanner::commitNext);
+}
+
+ConsolidationPlanner::~ConsolidationPlanner() {
+    this->cancel();
+    m_pool.waitForDone();
+}
+
+void ConsolidationPlanner::plan(const Options &options) {
+    if (m_running) {
+        return;
+    }
+
+    m_options = options;
+    m_groups.clear();
+    m_sweeps.clear();
+
+    QMap<QPair<quint32, quint32>, QVector<Coins::Output>> outputsByAddress;
+    for (const auto &output : m_ctx->wallet->coins()->spendableOutputs()) {
+        outputsByAddress[{output.account, output.subaddress}].append(output);
+    }
+
+    for (auto it = outputsByAddress.begin(); it != outputsByAddress.end(); ++it) {
+        Group group;
+        group.account = it.key().first;
+        group.subaddress = it.key().second;
+        group.address = m_ctx->wallet->address(group.account, group.subaddress);
+
+        QVector<Coins::Output> spendable;
+        for (const auto &output : it.value()) {
+            if (!output.unlocked) {
+                group.locked++;
+                group.lockedAmount += output.amount;
+            } else if (output.amount < m_options.minAmount) {
+                group.skipped++;
+            } else {
+                spendable.append(output);
+                group.amount += output.amount;
+            }
+        }
+        group.outputs = spendable.size();
+
+        // Nothing to gain from sweeping a single output
+        if (spendable.size() >= 2) {
+            std::sort(spendable.begin(), spendable.end(), [](const Coins::Output &a, const Coins::Output &b) {
+                return a.amount < b.amount;
+            });
+
+            // Fewest sweeps that respect the input limit, with inputs spread evenly over them
+            int count = (spendable.size() + m_options.maxInputs - 1) / m_options.maxInputs;
+            int base = spendable.size() / count;
+            int extra = spendable.size() % count;
+
+            int next = 0;
+            for (int i = 0; i < count; i++) {
+                Sweep sweep;
+                sweep.index = m_sweeps.size();
+                sweep.group = m_groups.size();
+                int size = base + (i < extra ? 1 : 0);
+                for (int j = 0; j < size; j++) {
+                    sweep.keyImages.append(spendable[next].keyImage);
+                    sweep.amount += spendable[next].amount;
+                    next++;
+                }
+                group.sweeps.append(sweep.index);
+                m_sweeps.append(sweep);
+            }
+        }
+
+        m_groups.append(group);
+    }
+}
+
+void ConsolidationPlanner::start() {
+    if (m_running || m_sweeps.isEmpty()) {
+        return;
+    }
+
+    for (auto &sweep : m_sweeps) {
+        if (sweep.state == Cancelled) {
+            sweep.state = Waiting;
+            sweep.error.clear();
+            emit sweepUpdated(sweep.index);
+        }
+    }
+
+    m_cancel = false;
+    m_running = true;
+    m_next = 0;
+    this->schedule();
+}
+
+void ConsolidationPlanner::cancel() {
+    m_cancel = true;
+    m_commitTimer.stop();
+
+    for (const auto &constructed : m_constructed) {
+        m_ctx->wallet->disposeTransaction(constructed.second);
+        this->setState(constructed.first, Cancelled);
+    }
+    m_constructed.clear();
+
+    this->finishIfDone();
+}
+
+bool ConsolidationPlanner::isRunning() const {
+    return m_running;
+}
+
+void ConsolidationPlanner::schedule() {
+    while (!m_cancel && m_next < m_sweeps.size() && m_constructing == 0 && m_constructed.size() < constructAhead) {
+        int index = m_next++;
+        if (m_sweeps[index].state == Waiting) {
+            this->construct(index);
+        }
+    }
+
+    this->commitNext();
+    this->finishIfDone();
+}
+
+void ConsolidationPlanner::construct(int index) {
+    this->setState(index, Constructing);
+    m_constructing++;
+
+    QVector<QString> keyImages = m_sweeps[index].keyImages;
+    QString address = m_groups[m_sweeps[index].group].address;
+    PendingTransaction::Priority priority = m_options.priority;
+
+    QtConcurrent::run(&m_pool, [this, index, keyImages, address, priority]{
+        PendingTransaction *tx = nullptr;
+        m_ctx->wallet->runLocked([&]{
+            tx = m_ctx->wallet->createTransactionSelected(keyImages, address, 1, priority);
+        });
+
+        QMetaObject::invokeMethod(this, [this, index, tx]{
+            this->onConstructed(index, tx);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ConsolidationPlanner::onConstructed(int index, PendingTransaction *tx) {
+    m_constructing--;
+
+    if (tx->status() != PendingTransaction::Status_Ok || m_cancel) {
+        QString error = tx->errorString();
+        bool failed = tx->status() != PendingTransaction::Status_Ok;
+        m_ctx->wallet->disposeTransaction(tx);
+        this->setState(index, failed ? Failed : Cancelled, failed ? error : QString());
+        this->schedule();
+        return;
+    }
+
+    m_sweeps[index].fee = tx->fee();
+    m_sweeps[index].txids = tx->txid();
+    this->setState(index, Constructed);
+    m_constructed.append({index, tx});
+
+    this->schedule();
+}
+
+void ConsolidationPlanner::commitNext() {
+    if (m_cancel || m_committing || m_constructed.isEmpty()) {
+        return;
+    }
+
+    // Spread the sweeps out, so they don't all show up in the same block
+    if (m_lastCommit.isValid()) {
+        qint64 remaining = m_options.interval * 1000 - m_lastCommit.elapsed();
+        if (remaining > 0) {
+            if (!m_commitTimer.isActive()) {
+                m_commitTimer.start(remaining);
+            }
+            return;
+        }
+    }
+
+    auto next = m_constructed.takeFirst();
+    int index = next.first;
+    PendingTransaction *tx = next.second;
+
+    m_committing = true;
+    this->setState(index, Committing);
+
+    if (config()->get(Config::multiBroadcast).toBool()) {
+        m_ctx->onMultiBroadcast(tx);
+    }
+
+    QtConcurrent::run(&m_pool, [this, index, tx]{
+        bool success = false;
+        QString error;
+        m_ctx->wallet->runLocked([&]{
+            QStringList txids = tx->txid();
+            success = tx->commit();
+            error = tx->errorString();
+            if (success) {
+                for (const auto &txid : txids) {
+                    m_ctx->wallet->setUserNote(txid, "Consolidation");
+                }
+            }
+            m_ctx->wallet->disposeTransaction(tx);
+        });
+
+        QMetaObject::invokeMethod(this, [this, index, success, error]{
+            this->onCommitted(index, success, error);
+        }, Qt::QueuedConnection);
+    });
+
+    // Keep constructing while the commit is in flight
+    this->schedule();
+}
+
+void ConsolidationPlanner::onCommitted(int index, bool success, const QString &error) {
+    m_committing = false;
+    m_lastCommit.start();
+
+    if (success) {
+        this->setState(index, Committed);
+        // Don't risk losing the tx keys
+        m_ctx->storeWallet(true);
+    } else {
+        qWarning() << "Consolidation sweep" << index + 1 << "failed:" << error;
+        this->setState(index, Failed, error);
+    }
+
+    this->schedule();
+}
+
+void ConsolidationPlanner::setState(int index, SweepState state, const QString &error) {
+    m_sweeps[index].state = state;
+    m_sweeps[index].error = error;
+    emit sweepUpdated(index);
+}
+
+void ConsolidationPlanner::finishIfDone() {
+    if (!m_running || m_constructing > 0 || m_committing) {
+        return;
+    }
+
+    if (!m_cancel && (!m_constructed.isEmpty() || m_next < m_sweeps.size())) {
+        return;
+    }
+
+    m_running = false;
+    m_ctx->refreshModels();
+    m_ctx->updateBalance();
+
+    int committed = 0;
+    int failed = 0;
+    for (const auto &sweep : m_sweeps) {
+        if (sweep.state == Committed) {
+            committed++;
+        } else if (sweep.state == Failed) {
+            failed++;
+        }
+    }
+    emit finished(committed, failed);
+}
+
+QVector<ConsolidationPlanner::Group> ConsolidationPlanner::groups() const {
+    return m_groups;
+}
+
+QVector<ConsolidationPlanner::Sweep> ConsolidationPlanner::sweeps() const {
+    return m_sweeps;
+}
+
+ConsolidationPlanner::Sweep ConsolidationPlanner::sweep(int index) const {
+    return m_sweeps.value(index);
+}
+
+int ConsolidationPlanner::nextCommit() const {
+    if (!m_commitTimer.isActive()) {
+        return -1;
+    }
+    return m_commitTimer.remainingTime() / 1000;
+}
+
+QString ConsolidationPlanner::stateToString(SweepState state) {
+    return stateNames.value(state);
+}
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_CONSOLIDATIONPLANNER_H
+#define FEATHER_CONSOLIDATIONPLANNER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <atomic>
+
+#include "appcontext.h"
+
+// Merges many small outputs into few. Outputs are grouped by account and subaddress, every group is swept
+// back to its own address so no subaddresses get linked on chain. Sweeps are constructed one at a time on a
+// worker thread, a few ahead of the commits, which are spaced out by an interval.
+class ConsolidationPlanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        int maxInputs = 100;
+        quint64 minAmount = 0; // outputs worth less than this are left alone
+        int interval = 60;     // seconds between commits
+        PendingTransaction::Priority priority = PendingTransaction::Priority_Low;
+    };
+
+    struct Group {
+        quint32 account = 0;
+        quint32 subaddress = 0;
+        QString address;
+        int outputs = 0;
+        quint64 amount = 0;
+        int locked = 0;
+        quint64 lockedAmount = 0;
+        int skipped = 0; // below the minimum amount
+        QVector<int> sweeps;
+    };
+
+    enum SweepState {
+        Waiting = 0,
+        Constructing,
+        Constructed,
+        Committing,
+        Committed,
+        Failed,
+        Cancelled
+    };
+
+    struct Sweep {
+        int index = 0;
+        int group = 0;
+        QVector<QString> keyImages;
+        quint64 amount = 0;
+        SweepState state = Waiting;
+        QStringList txids;
+        quint64 fee = 0;
+        QString error;
+    };
+
+    explicit ConsolidationPlanner(QSharedPointer<AppContext> ctx, QObject *parent = nullptr);
+    ~ConsolidationPlanner() override;
+
+    void plan(const Options &options);
+    void start();
+    void cancel();
+    bool isRunning() const;
+
+    QVector<Group> groups() const;
+    QVector<Sweep> sweeps() const;
+    Sweep sweep(int index) const;
+
+    // Seconds until the next commit, -1 if none is scheduled
+    int nextCommit() const;
+
+    static QString stateToString(SweepState state);
+
+signals:
+    void sweepUpdated(int index);
+    void finished(int committed, int failed);
+
+private:
+    void schedule();
+    void construct(int index);
+    void onConstructed(int index, PendingTransaction *tx);
+    void commitNext();
+    void onCommitted(int index, bool success, const QString &error);
+    void setState(int index, SweepState state, const QString &error = {});
+    void finishIfDone();
+
+    QSharedPointer<AppContext> m_ctx;
+    Options m_options;
+    QVector<Group> m_groups;
+    QVector<Sweep> m_sweeps;
+
+    // libwallet is not thread safe, constructions and commits run one after another on this pool
+    // and under Wallet::runLocked(), so they also wait for any refresh or store in progress
+    QThreadPool m_pool;
+
+    int m_next = 0;         // next sweep to construct
+    int m_constructing = 0;
+    bool m_committing = false;
+    QList<QPair<int, PendingTransaction*>> m_constructed;
+    QTimer m_commitTimer;
+    QElapsedTimer m_lastCommit;
+
+    bool m_running = false;
+    std::atomic<bool> m_cancel{false};
+};
+
+#endif //FEATHER_CONSOLIDATIONPLANNER_H
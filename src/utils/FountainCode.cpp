@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "FountainCode.h"
+
+#include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QtEndian>
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    const QString prefix = "FTHR:";
+    constexpr quint32 maxFragments = 65536;
+    const char base32Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+    // Portable PRNG, both ends have to draw the same numbers
+    class SplitMix64 {
+    public:
+        explicit SplitMix64(quint64 seed) : m_state(seed) {}
+
+        quint64 next() {
+            quint64 z = (m_state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        double nextDouble() {
+            return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        quint32 nextInt(quint32 bound) {
+            return static_cast<quint32>(next() % bound);
+        }
+
+    private:
+        quint64 m_state;
+    };
+
+    QString base32Encode(const QByteArray &data) {
+        QString out;
+        out.reserve((data.size() * 8 + 4) / 5);
+        quint32 buffer = 0;
+        int bits = 0;
+        for (char c : data) {
+            buffer = (buffer << 8) | static_cast<quint8>(c);
+            bits += 8;
+            while (bits >= 5) {
+                out += QLatin1Char(base32Alphabet[(buffer >> (bits - 5)) & 0x1F]);
+                bits -= 5;
+            }
+        }
+        if (bits > 0) {
+            out += QLatin1Char(base32Alphabet[(buffer << (5 - bits)) & 0x1F]);
+        }
+        return out;
+    }
+
+    bool base32Decode(const QString &text, QByteArray &out) {
+        out.clear();
+        out.reserve(text.size() * 5 / 8);
+        quint32 buffer = 0;
+        int bits = 0;
+        for (QChar qc : text) {
+            ushort c = qc.unicode();
+            int value;
+            if (c >= 'A' && c <= 'Z') {
+                value = c - 'A';
+            } else if (c >= '2' && c <= '7') {
+                value = c - '2' + 26;
+            } else {
+                return false;
+            }
+            buffer = (buffer << 5) | value;
+            bits += 5;
+            if (bits >= 8) {
+                out += static_cast<char>((buffer >> (bits - 8)) & 0xFF);
+                bits -= 8;
+            }
+        }
+        return true;
+    }
+
+    void xorInto(QByteArray &dst, const QByteArray &src) {
+        char *d = dst.data();
+        const char *s = src.constData();
+        for (int i = 0; i < dst.size(); i++) {
+            d[i] ^= s[i];
+        }
+    }
+}
+
+QVector<int> FountainCode::chooseFragments(quint32 seq, quint32 count, quint32 checksum) {
+    if (seq <= count) {
+        return {static_cast<int>(seq - 1)};
+    }
+
+    SplitMix64 rng((static_cast<quint64>(checksum) << 32) | seq);
+
+    // Degree d is chosen with weight 1/d, mostly low degrees that peel easily with some wide parts for coverage
+    double total = 0;
+    for (quint32 d = 1; d <= count; d++) {
+        total += 1.0 / d;
+    }
+    double target = rng.nextDouble() * total;
+    quint32 degree = 1;
+    for (double sum = 1.0; sum < target && degree < count; ) {
+        degree++;
+        sum += 1.0 / degree;
+    }
+
+    // Partial Fisher-Yates shuffle
+    QVector<int> indexes(static_cast<int>(count));
+    std::iota(indexes.begin(), indexes.end(), 0);
+    for (quint32 i = 0; i < degree; i++) {
+        quint32 j = i + rng.nextInt(count - i);
+        std::swap(indexes[i], indexes[j]);
+    }
+    indexes.resize(static_cast<int>(degree));
+    std::sort(indexes.begin(), indexes.end());
+    return indexes;
+}
+
+quint32 FountainCode::checksum(const QByteArray &message) {
+    QByteArray hash = QCryptographicHash::hash(message, QCryptographicHash::Sha256);
+    return qFromBigEndian<quint32>(hash.constData());
+}
+
+FountainEncoder::FountainEncoder(const QByteArray &message, int fragmentLength)
+    : m_message(message)
+    , m_checksum(FountainCode::checksum(message))
+{
+    fragmentLength = std::max(fragmentLength, 1);
+    int count = std::max((message.size() + fragmentLength - 1) / fragmentLength, 1);
+
+    // Spread the message evenly so the last fragment isn't mostly padding
+    fragmentLength = (message.size() + count - 1) / count;
+    for (int i = 0; i < count; i++) {
+        QByteArray fragment = message.mid(i * fragmentLength, fragmentLength);
+        fragment.append(fragmentLength - fragment.size(), '\0');
+        m_fragments.append(fragment);
+    }
+}
+
+QString FountainEncoder::nextPart() {
+    m_seq++;
+    const auto count = static_cast<quint32>(m_fragments.size());
+
+    QByteArray data;
+    for (int index : FountainCode::chooseFragments(m_seq, count, m_checksum)) {
+        if (data.isEmpty()) {
+            data = m_fragments[index];
+        } else {
+            xorInto(data, m_fragments[index]);
+        }
+    }
+
+    QString checksum = QString::number(m_checksum, 16).rightJustified(8, '0').toUpper();
+    return QString("%1%2-%3-%4-%5:%6").arg(prefix).arg(m_seq).arg(count).arg(m_message.size()).arg(checksum, base32Encode(data));
+}
+
+bool FountainDecoder::isPart(const QString &text) {
+    return text.startsWith(prefix);
+}
+
+bool FountainDecoder::receive(const QString &text) {
+    static const QRegularExpression re("^FTHR:(\\d+)-(\\d+)-(\\d+)-([0-9A-F]{8}):([A-Z2-7]*)$");
+    auto match = re.match(text.trimmed());
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    bool ok;
+    quint32 seq = match.captured(1).toUInt(&ok);
+    if (!ok || seq == 0) return false;
+    quint32 count = match.captured(2).toUInt(&ok);
+    if (!ok || count == 0 || count > maxFragments) return false;
+    quint32 length = match.captured(3).toUInt(&ok);
+    if (!ok) return false;
+    quint32 checksum = match.captured(4).toUInt(&ok, 16);
+    if (!ok) return false;
+
+    QByteArray data;
+    if (!base32Decode(match.captured(5), data)) {
+        return false;
+    }
+
+    // Base32 rounds up to whole characters, drop the trailing partial byte
+    int fragmentLength = static_cast<int>((static_cast<quint64>(length) + count - 1) / count);
+    if (data.size() < fragmentLength) {
+        return false;
+    }
+    data.truncate(fragmentLength);
+
+    if (m_count == 0) {
+        m_count = count;
+        m_length = length;
+        m_checksum = checksum;
+        m_fragments.resize(static_cast<int>(count));
+        m_known.fill(false, static_cast<int>(count));
+    }
+    else if (count != m_count || length != m_length || checksum != m_checksum) {
+        return false;
+    }
+
+    if (m_complete || m_seen.contains(seq)) {
+        return true;
+    }
+    m_seen.insert(seq);
+
+    this->process({FountainCode::chooseFragments(seq, count, checksum), data});
+    return true;
+}
+
+void FountainDecoder::process(Part part) {
+    QVector<Part> queue{std::move(part)};
+
+    while (!queue.isEmpty()) {
+        Part current = queue.takeLast();
+
+        // Remove fragments we already know
+        QVector<int> remaining;
+        for (int index : current.indexes) {
+            if (m_known[index]) {
+                xorInto(current.data, m_fragments[index]);
+            } else {
+                remaining.append(index);
+            }
+        }
+        current.indexes = remaining;
+
+        if (current.indexes.isEmpty()) {
+            continue;
+        }
+
+        if (current.indexes.size() > 1) {
+            bool duplicate = std::any_of(m_mixed.begin(), m_mixed.end(), [&current](const Part &p){
+                return p.indexes == current.indexes;
+            });
+            if (!duplicate) {
+                m_mixed.append(current);
+            }
+            continue;
+        }
+
+        int index = current.indexes.first();
+        m_fragments[index] = current.data;
+        m_known[index] = true;
+        m_knownCount++;
+
+        // Mixed parts that contain the new fragment may now reduce further
+        for (int i = m_mixed.size() - 1; i >= 0; i--) {
+            if (m_mixed[i].indexes.contains(index)) {
+                queue.append(m_mixed.takeAt(i));
+            }
+        }
+    }
+
+    if (m_knownCount < static_cast<int>(m_count)) {
+        return;
+    }
+
+    m_message.clear();
+    for (const auto &fragment : m_fragments) {
+        m_message += fragment;
+    }
+    m_message.truncate(static_cast<int>(m_length));
+    m_mixed.clear();
+    m_complete = true;
+    m_success = (FountainCode::checksum(m_message) == m_checksum);
+}
+
+void FountainDecoder::reset() {
+    *this = FountainDecoder();
+}
+
+double FountainDecoder::progress() const {
+    if (m_count == 0) {
+        return 0;
+    }
+    return static_cast<double>(m_knownCount) / m_count;
+}
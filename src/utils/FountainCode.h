@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_FOUNTAINCODE_H
+#define FEATHER_FOUNTAINCODE_H
+
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// Rateless (LT) fountain code for moving payloads that don't fit a single QR code. The first parts carry
+// one fragment each, later parts XOR a pseudo-random set of fragments. The receiver can reassemble the
+// message from any sufficient set of parts, in any order.
+//
+// Parts are text: "FTHR:<seq>-<count>-<length>-<checksum>:<base32 data>", which fits the QR alphanumeric mode.
+namespace FountainCode {
+    // Fragment indexes mixed into part seq (1-based), the same on both ends
+    QVector<int> chooseFragments(quint32 seq, quint32 count, quint32 checksum);
+    quint32 checksum(const QByteArray &message);
+}
+
+class FountainEncoder
+{
+public:
+    explicit FountainEncoder(const QByteArray &message, int fragmentLength = 200);
+
+    QString nextPart();
+    int fragmentCount() const { return m_fragments.size(); }
+    quint32 sequence() const { return m_seq; }
+
+private:
+    QByteArray m_message;
+    quint32 m_checksum;
+    QVector<QByteArray> m_fragments;
+    quint32 m_seq = 0;
+};
+
+class FountainDecoder
+{
+public:
+    static bool isPart(const QString &text);
+
+    // Returns false for malformed parts or parts of a different message
+    bool receive(const QString &text);
+    void reset();
+
+    bool isComplete() const { return m_complete; }
+    bool isSuccess() const { return m_success; }
+    QByteArray message() const { return m_message; }
+
+    double progress() const;
+    int partsReceived() const { return m_seen.size(); }
+    int fragmentCount() const { return static_cast<int>(m_count); }
+    int fragmentsRecovered() const { return m_knownCount; }
+
+private:
+    struct Part {
+        QVector<int> indexes;
+        QByteArray data;
+    };
+
+    void process(Part part);
+
+    quint32 m_count = 0;
+    quint32 m_length = 0;
+    quint32 m_checksum = 0;
+
+    QVector<QByteArray> m_fragments;
+    QVector<bool> m_known;
+    int m_knownCount = 0;
+    QVector<Part> m_mixed;
+    QSet<quint32> m_seen;
+
+    QByteArray m_message;
+    bool m_complete = false;
+    bool m_success = false;
+};
+
+#endif //FEATHER_FOUNTAINCODE_H
@@ -0,0 +1,878 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "PayoutEngine.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+
+#include "utils/config.h"
+#include "libwalletqt/Coins.h"
+#include "libwalletqt/CoinsInfo.h"
+#include "libwalletqt/WalletManager.h"
+
+namespace {
+    constexpr int journalVersion = 1;
+    constexpr int maxAttempts = 3;
+
+    // Set aside for the fee when assigning outputs, whatever is not spent comes back as change
+    constexpr quint64 baseFeeReserve = 1000000000; // 0.001 XMR at low priority
+
+    // Scaled by wallet2's fee multipliers
+    quint64 feeReserve(PendingTransaction::Priority priority) {
+        switch (priority) {
+            case PendingTransaction::Priority_Medium:
+                return baseFeeReserve * 5;
+            case PendingTransaction::Priority_High:
+                return baseFeeReserve * 25;
+            default:
+                return baseFeeReserve;
+        }
+    }
+
+    QStringList parseCsvLine(const QString &line) {
+        QStringList fields;
+        QString field;
+        bool quoted = false;
+        for (int i = 0; i < line.size(); i++) {
+            QChar c = line[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                    field += c;
+                    i++;
+                } else if (c == '"') {
+                    quoted = false;
+                } else {
+                    field += c;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields << field.trimmed();
+                field.clear();
+            } else {
+                field += c;
+            }
+        }
+        fields << field.trimmed();
+        return fields;
+    }
+
+    QString csvField(const QString &field) {
+        if (!field.contains(',') && !field.contains('"') && !field.contains('\n')) {
+            return field;
+        }
+        return QString("\"%1\"").arg(QString(field).replace("\"", "\"\""));
+    }
+
+    const QStringList stateNames = {"unfunded", "planned", "constructed", "committed", "failed"};
+}
+
+PayoutEngine::PayoutEngine(QSharedPointer<AppContext> ctx, QObject *parent)
+        : QObject(parent)
+        , m_ctx(std::move(ctx))
+{
+    // One thread constructs the next transaction while the other commits the previous one
+    m_pool.setMaxThreadCount(2);
+
+    connect(&m_validation, &QFutureWatcher<Row>::finished, [this]{
+        m_rows = m_validation.future().results().toVector();
+
+        int invalid = 0;
+        for (const auto &row : m_rows) {
+            if (!row.error.isEmpty()) {
+                invalid++;
+            }
+        }
+        emit validated(m_rows.size() - invalid, invalid);
+    });
+}
+
+PayoutEngine::~PayoutEngine() {
+    this->cancel();
+    m_validation.waitForFinished();
+    m_pool.waitForDone();
+
+    for (const auto &queued : m_queue) {
+        m_ctx->wallet->disposeTransaction(queued.second);
+    }
+}
+
+bool PayoutEngine::load(const QString &path, QString &error) {
+    if (m_running || m_validation.isRunning()) {
+        error = "A payout is in progress";
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        error = QString("Could not open file: %1").arg(file.errorString());
+        return false;
+    }
+
+    QVector<Row> rows;
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine()).trimmed();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        QStringList fields = parseCsvLine(line);
+        if (rows.isEmpty() && fields[0].compare("address", Qt::CaseInsensitive) == 0) {
+            continue;
+        }
+
+        Row row;
+        row.line = lineNumber;
+        row.address = fields[0];
+        if (fields.size() > 2) {
+            row.label = fields.mid(2).join(", ");
+        }
+        if (fields.size() < 2) {
+            row.error = "Expected \"address,amount\"";
+        } else {
+            row.amount = WalletManager::amountFromString(fields[1]);
+            if (row.amount == 0) {
+                row.error = "Invalid amount";
+            }
+        }
+        rows.append(row);
+    }
+
+    if (rows.isEmpty()) {
+        error = "File contains no payments";
+        return false;
+    }
+
+    m_path = path;
+    m_rows.clear();
+    m_batches.clear();
+    m_batchId.clear();
+
+    // Address validation dominates, spread it over all cores
+    NetworkType::Type nettype = m_ctx->wallet->nettype();
+    std::function<Row(const Row&)> validate = [nettype](const Row &row) {
+        return PayoutEngine::validateRow(row, nettype);
+    };
+    m_validation.setFuture(QtConcurrent::mapped(rows, validate));
+    return true;
+}
+
+PayoutEngine::Row PayoutEngine::validateRow(const Row &row, NetworkType::Type nettype) {
+    Row result = row;
+    if (result.error.isEmpty() && !WalletManager::addressValid(result.address, nettype)) {
+        result.error = "Invalid address";
+    }
+    return result;
+}
+
+bool PayoutEngine::plan(QString &error) {
+    if (m_running) {
+        error = "A payout is in progress";
+        return false;
+    }
+
+    QByteArray normalized = m_ctx->wallet->address(0, 0).toUtf8();
+    for (auto &row : m_rows) {
+        row.paidBy.clear();
+        if (row.error.isEmpty()) {
+            normalized += QString("\n%1,%2").arg(row.address, QString::number(row.amount)).toUtf8();
+        }
+    }
+
+    // The same file paid from the same wallet maps to the same journal
+    m_batchId = QCryptographicHash::hash(normalized, QCryptographicHash::Sha256).toHex().left(16);
+    m_journalPath = Config::defaultConfigDir().filePath(QString("payouts/%1.json").arg(m_batchId));
+
+    // An edited file gets a new journal, rows that the old one paid must not be paid again
+    int paid = this->markPaidRows();
+
+    QVector<int> valid;
+    for (int i = 0; i < m_rows.size(); i++) {
+        if (m_rows[i].error.isEmpty() && m_rows[i].paidBy.isEmpty()) {
+            valid.append(i);
+        }
+    }
+
+    if (valid.isEmpty()) {
+        error = paid > 0 ? "Every payment in this file was already paid by an earlier run" : "File contains no valid payments";
+        m_batchId.clear();
+        return false;
+    }
+
+    m_ctx->wallet->coins()->refresh(m_ctx->wallet->currentSubaddressAccount());
+
+    QMutexLocker locker(&m_lock);
+
+    if (QFile::exists(m_journalPath)) {
+        if (!this->loadJournal(error)) {
+            return false;
+        }
+    } else {
+        // As few transactions as possible, with destinations spread evenly over them
+        int count = (valid.size() + maxDestinations - 1) / maxDestinations;
+        int base = valid.size() / count;
+        int extra = valid.size() % count;
+
+        m_batches.clear();
+        int next = 0;
+        for (int i = 0; i < count; i++) {
+            Batch batch;
+            batch.index = i;
+            int size = base + (i < extra ? 1 : 0);
+            for (int j = 0; j < size; j++) {
+                int row = valid[next++];
+                batch.rows.append(row);
+                batch.total += m_rows[row].amount;
+            }
+            m_batches.append(batch);
+        }
+    }
+
+    // Inputs spent by anything other than an attempt of the batch itself are gone for good, the batch is planned again
+    QSet<QString> spent;
+    Coins *coins = m_ctx->wallet->coins();
+    for (int i = 0; i < coins->count(); i++) {
+        coins->coin(i, [&](CoinsInfo &c) {
+            if (c.spent()) {
+                spent.insert(c.keyImage());
+            }
+        });
+    }
+    for (auto &batch : m_batches) {
+        if (batch.state == Unfunded || batch.state == Committed) {
+            continue;
+        }
+        bool inputsSpent = std::any_of(batch.inputs.begin(), batch.inputs.end(), [&](const QString &input) {
+            return spent.contains(input);
+        });
+        bool attemptKnown = std::any_of(batch.history.begin(), batch.history.end(), [&](const QString &txid) {
+            return m_ctx->wallet->haveTransaction(txid);
+        });
+        if (inputsSpent && !attemptKnown) {
+            qInfo() << "Payout batch" << batch.index + 1 << "lost its inputs, planning it again";
+            batch.inputs.clear();
+            batch.state = Unfunded;
+            batch.attempts = 0;
+        }
+    }
+
+    QVector<Batch*> unfunded;
+    for (auto &batch : m_batches) {
+        if (batch.state == Unfunded) {
+            unfunded.append(&batch);
+        }
+    }
+    this->assignInputs(unfunded);
+
+    QDir().mkpath(QFileInfo(m_journalPath).absolutePath());
+    this->writeJournal();
+    return true;
+}
+
+void PayoutEngine::assignInputs(QVector<Batch*> batches) {
+    if (batches.isEmpty()) {
+        return;
+    }
+
+    // Outputs pinned to batches that may still be committed are off limits
+    QSet<QString> pinned;
+    for (const auto &batch : m_batches) {
+        if (batch.state != Committed) {
+            for (const auto &input : batch.inputs) {
+                pinned.insert(input);
+            }
+        }
+    }
+
+    quint32 account = m_ctx->wallet->currentSubaddressAccount();
+    std::multimap<quint64, QString> available;
+    Coins *coins = m_ctx->wallet->coins();
+    for (int i = 0; i < coins->count(); i++) {
+        coins->coin(i, [&](CoinsInfo &c) {
+            if (c.spent() || c.frozen() || !c.unlocked() || !c.keyImageKnown() || c.subaddrAccount() != account) {
+                return;
+            }
+            if (!pinned.contains(c.keyImage())) {
+                available.emplace(c.amount(), c.keyImage());
+            }
+        });
+    }
+
+    // Largest batches first. Each takes the smallest output that covers what is left,
+    // or the largest one if none does, which keeps both input counts and change small.
+    std::sort(batches.begin(), batches.end(), [](const Batch *a, const Batch *b) {
+        return a->total > b->total;
+    });
+
+    for (auto *batch : batches) {
+        QVector<std::pair<quint64, QString>> taken;
+        quint64 needed = batch->total + feeReserve(m_ctx->tx_priority);
+        quint64 covered = 0;
+
+        while (covered < needed && !available.empty()) {
+            auto it = available.lower_bound(needed - covered);
+            if (it == available.end()) {
+                it = std::prev(available.end());
+            }
+            covered += it->first;
+            taken.append(*it);
+            available.erase(it);
+        }
+
+        if (covered < needed) {
+            for (const auto &coin : taken) {
+                available.emplace(coin.first, coin.second);
+            }
+            batch->inputs.clear();
+            batch->state = Unfunded;
+            batch->error = QString("Waiting for %1 XMR of unlocked balance").arg(WalletManager::displayAmount(needed - covered, false));
+            continue;
+        }
+
+        batch->inputs.clear();
+        for (const auto &coin : taken) {
+            batch->inputs.append(coin.second);
+        }
+        batch->state = Planned;
+        batch->error.clear();
+    }
+}
+
+void PayoutEngine::start() {
+    if (m_running || m_batches.isEmpty()) {
+        return;
+    }
+
+    QVector<int> indices;
+    {
+        QMutexLocker locker(&m_lock);
+        for (const auto &batch : m_batches) {
+            if (batch.state == Planned || batch.state == Constructed || batch.state == Failed) {
+                indices.append(batch.index);
+            }
+        }
+        m_queue.clear();
+        m_constructDone = false;
+    }
+
+    if (indices.isEmpty()) {
+        this->onFinished();
+        return;
+    }
+
+    m_cancel = false;
+    m_running = true;
+    // Config isn't safe to read from the pool
+    m_multiBroadcast = config()->get(Config::multiBroadcast).toBool();
+
+    QtConcurrent::run(&m_pool, [this, indices]{
+        this->constructStage(indices);
+    });
+    QtConcurrent::run(&m_pool, [this]{
+        this->commitStage();
+        QMetaObject::invokeMethod(this, &PayoutEngine::onFinished, Qt::QueuedConnection);
+    });
+}
+
+void PayoutEngine::cancel() {
+    m_cancel = true;
+    m_validation.cancel();
+
+    QMutexLocker locker(&m_lock);
+    m_queueCondition.wakeAll();
+}
+
+bool PayoutEngine::isRunning() const {
+    return m_running;
+}
+
+void PayoutEngine::constructStage(QVector<int> indices) {
+    for (int index : indices) {
+        if (m_cancel) {
+            break;
+        }
+
+        if (this->alreadyCommitted(index)) {
+            continue;
+        }
+
+        PendingTransaction *tx = this->construct(index);
+        if (!tx) {
+            continue;
+        }
+
+        QMutexLocker locker(&m_lock);
+        while (!m_queue.isEmpty() && !m_cancel) {
+            m_queueCondition.wait(&m_lock);
+        }
+        m_queue.append({index, tx});
+        m_queueCondition.wakeAll();
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_constructDone = true;
+    m_queueCondition.wakeAll();
+}
+
+void PayoutEngine::commitStage() {
+    Wallet *wallet = m_ctx->wallet;
+
+    while (true) {
+        QPair<int, PendingTransaction*> next;
+        {
+            QMutexLocker locker(&m_lock);
+            while (m_queue.isEmpty() && !m_constructDone) {
+                m_queueCondition.wait(&m_lock);
+            }
+            if (m_queue.isEmpty()) {
+                break;
+            }
+            next = m_queue.takeFirst();
+            m_queueCondition.wakeAll();
+        }
+
+        int index = next.first;
+        PendingTransaction *tx = next.second;
+
+        while (tx) {
+            if (m_cancel) {
+                wallet->runLocked([wallet, tx]{
+                    wallet->disposeTransaction(tx);
+                });
+                this->setState(index, Planned);
+                break;
+            }
+
+            QStringList txids = tx->txid();
+            if (m_multiBroadcast) {
+                QStringList txData;
+                for (quint64 i = 0; i < tx->txCount(); i++) {
+                    txData.append(tx->signedTxToHex(i));
+                }
+                QMetaObject::invokeMethod(m_ctx.data(), [ctx = m_ctx, txids, txData]{
+                    ctx->multiBroadcast(txids, txData);
+                }, Qt::QueuedConnection);
+            }
+
+            bool success = false;
+            QString error;
+            wallet->runLocked([&]{
+                success = tx->commit();
+                error = tx->errorString();
+                if (success) {
+                    for (const auto &txid : txids) {
+                        wallet->setUserNote(txid, QString("Payout %1 #%2").arg(m_batchId, QString::number(index + 1)));
+                    }
+                }
+                wallet->disposeTransaction(tx);
+            });
+            tx = nullptr;
+
+            if (success) {
+                this->setState(index, Committed);
+                // Don't risk losing the tx keys
+                QMetaObject::invokeMethod(m_ctx.data(), [ctx = m_ctx]{
+                    ctx->storeWallet(true);
+                }, Qt::QueuedConnection);
+                break;
+            }
+
+            qWarning() << "Payout batch" << index + 1 << "failed to commit:" << error;
+            if (this->alreadyCommitted(index)) {
+                break;
+            }
+
+            int attempts = this->batch(index).attempts;
+            if (attempts >= maxAttempts) {
+                this->setState(index, Failed, error);
+                break;
+            }
+
+            // Same inputs as before, a retry can't pay this batch twice
+            tx = this->construct(index);
+        }
+    }
+}
+
+PendingTransaction* PayoutEngine::construct(int index) {
+    QVector<QString> addresses;
+    QVector<quint64> amounts;
+    QStringList inputs;
+    {
+        QMutexLocker locker(&m_lock);
+        const Batch &batch = m_batches[index];
+        for (int row : batch.rows) {
+            addresses.append(m_rows[row].address);
+            amounts.append(m_rows[row].amount);
+        }
+        inputs = batch.inputs;
+    }
+
+    PendingTransaction *tx = nullptr;
+    QString error;
+    QStringList txids;
+    m_ctx->wallet->runLocked([&]{
+        tx = m_ctx->wallet->createTransactionMultiDest(addresses, amounts, m_ctx->tx_priority, inputs);
+        if (tx->status() != PendingTransaction::Status_Ok) {
+            error = tx->errorString();
+            m_ctx->wallet->disposeTransaction(tx);
+            tx = nullptr;
+            return;
+        }
+        txids = tx->txid();
+    });
+
+    if (!tx) {
+        QMutexLocker locker(&m_lock);
+        m_batches[index].attempts++;
+        locker.unlock();
+        this->setState(index, Failed, error);
+        return nullptr;
+    }
+
+    // Journaled before the transaction is relayed
+    {
+        QMutexLocker locker(&m_lock);
+        Batch &batch = m_batches[index];
+        batch.txids = txids;
+        batch.history.append(txids);
+        batch.attempts++;
+    }
+    this->setState(index, Constructed);
+    return tx;
+}
+
+bool PayoutEngine::alreadyCommitted(int index) {
+    QStringList history = this->batch(index).history;
+    if (history.isEmpty()) {
+        return false;
+    }
+
+    QString found;
+    m_ctx->wallet->runLocked([&]{
+        for (const auto &txid : history) {
+            if (m_ctx->wallet->haveTransaction(txid)) {
+                found = txid;
+                break;
+            }
+        }
+    });
+    if (found.isEmpty()) {
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_lock);
+        m_batches[index].txids = QStringList{found};
+    }
+    this->setState(index, Committed);
+    return true;
+}
+
+void PayoutEngine::setState(int index, BatchState state, const QString &error) {
+    {
+        QMutexLocker locker(&m_lock);
+        m_batches[index].state = state;
+        m_batches[index].error = error;
+        this->writeJournal();
+    }
+    emit batchUpdated(index);
+}
+
+void PayoutEngine::onFinished() {
+    m_running = false;
+
+    m_ctx->refreshModels();
+    m_ctx->updateBalance();
+
+    int committed = 0;
+    int failed = 0;
+    for (const auto &batch : this->batches()) {
+        if (batch.state == Committed) {
+            committed++;
+        } else if (batch.state == Failed) {
+            failed++;
+        }
+    }
+    emit finished(committed, failed);
+}
+
+// Caller holds m_lock
+void PayoutEngine::writeJournal() {
+    QJsonArray rows;
+    for (const auto &row : m_rows) {
+        if (!row.error.isEmpty() || !row.paidBy.isEmpty()) {
+            continue;
+        }
+        QJsonObject obj;
+        obj["line"] = row.line;
+        obj["address"] = row.address;
+        obj["amount"] = QString::number(row.amount);
+        obj["label"] = row.label;
+        rows.append(obj);
+    }
+
+    QJsonArray batches;
+    for (const auto &batch : m_batches) {
+        batches.append(this->batchToJson(batch));
+    }
+
+    QJsonObject journal;
+    journal["version"] = journalVersion;
+    journal["id"] = m_batchId;
+    journal["wallet"] = m_ctx->wallet->address(0, 0);
+    journal["source"] = m_path;
+    journal["updated"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    journal["rows"] = rows;
+    journal["batches"] = batches;
+
+    QSaveFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write payout journal:" << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(journal).toJson());
+    if (!file.commit()) {
+        qWarning() << "Could not write payout journal:" << file.errorString();
+    }
+}
+
+QJsonObject PayoutEngine::batchToJson(const Batch &batch) const {
+    // Rows are stored by their line in the file, indices into m_rows depend on which rows were valid
+    QJsonArray lines;
+    for (int row : batch.rows) {
+        lines.append(m_rows[row].line);
+    }
+
+    QJsonObject obj;
+    obj["index"] = batch.index;
+    obj["lines"] = lines;
+    obj["total"] = QString::number(batch.total);
+    obj["inputs"] = QJsonArray::fromStringList(batch.inputs);
+    obj["state"] = stateNames[batch.state];
+    obj["txids"] = QJsonArray::fromStringList(batch.txids);
+    obj["history"] = QJsonArray::fromStringList(batch.history);
+    obj["attempts"] = batch.attempts;
+    obj["error"] = batch.error;
+    return obj;
+}
+
+// Caller holds m_lock
+bool PayoutEngine::loadJournal(QString &error) {
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Could not read payout journal: %1").arg(file.errorString());
+        return false;
+    }
+
+    QJsonObject journal = QJsonDocument::fromJson(file.readAll()).object();
+    if (journal["version"].toInt() != journalVersion || journal["id"].toString() != m_batchId) {
+        error = QString("Payout journal is damaged: %1").arg(m_journalPath);
+        return false;
+    }
+
+    QHash<int, int> rowByLine;
+    for (int i = 0; i < m_rows.size(); i++) {
+        rowByLine[m_rows[i].line] = i;
+    }
+
+    m_batches.clear();
+    for (const auto &value : journal["batches"].toArray()) {
+        QJsonObject obj = value.toObject();
+
+        Batch batch;
+        batch.index = obj["index"].toInt();
+        if (batch.index != m_batches.size()) {
+            error = QString("Payout journal is damaged: %1").arg(m_journalPath);
+            return false;
+        }
+        for (const auto &line : obj["lines"].toArray()) {
+            int row = rowByLine.value(line.toInt(), -1);
+            if (row < 0) {
+                error = QString("Payout journal does not match the file: %1").arg(m_journalPath);
+                return false;
+            }
+            batch.rows.append(row);
+            batch.total += m_rows[row].amount;
+        }
+        for (const auto &input : obj["inputs"].toArray()) {
+            batch.inputs.append(input.toString());
+        }
+        for (const auto &txid : obj["txids"].toArray()) {
+            batch.txids.append(txid.toString());
+        }
+        for (const auto &txid : obj["history"].toArray()) {
+            batch.history.append(txid.toString());
+        }
+        batch.attempts = obj["attempts"].toInt();
+        batch.error = obj["error"].toString();
+        batch.state = static_cast<BatchState>(std::max(0, stateNames.indexOf(obj["state"].toString())));
+
+        // Interrupted before the commit finished, construction checks whether it made it to the network
+        if (batch.state == Constructed) {
+            batch.state = Planned;
+        }
+        m_batches.append(batch);
+    }
+
+    if (m_batches.isEmpty()) {
+        error = QString("Payout journal is damaged: %1").arg(m_journalPath);
+        return false;
+    }
+
+    return true;
+}
+
+int PayoutEngine::markPaidRows() {
+    QString source = QFileInfo(m_path).absoluteFilePath();
+    QString wallet = m_ctx->wallet->address(0, 0);
+
+    // Rows of committed batches in other journals of this file, by destination
+    QMultiHash<QPair<QString, quint64>, QString> paid;
+    QDir dir(Config::defaultConfigDir().filePath("payouts"));
+    for (const auto &entry : dir.entryInfoList({"*.json"}, QDir::Files)) {
+        if (entry.completeBaseName() == m_batchId) {
+            continue;
+        }
+
+        QFile file(entry.absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QJsonObject journal = QJsonDocument::fromJson(file.readAll()).object();
+        if (journal["wallet"].toString() != wallet || QFileInfo(journal["source"].toString()).absoluteFilePath() != source) {
+            continue;
+        }
+
+        QHash<int, QPair<QString, quint64>> rowByLine;
+        for (const auto &value : journal["rows"].toArray()) {
+            QJsonObject obj = value.toObject();
+            rowByLine[obj["line"].toInt()] = {obj["address"].toString(), obj["amount"].toString().toULongLong()};
+        }
+        for (const auto &value : journal["batches"].toArray()) {
+            QJsonObject obj = value.toObject();
+            if (obj["state"].toString() != stateNames[Committed]) {
+                continue;
+            }
+            QString txid = obj["txids"].toArray().first().toString();
+            for (const auto &line : obj["lines"].toArray()) {
+                if (rowByLine.contains(line.toInt())) {
+                    paid.insert(rowByLine[line.toInt()], txid);
+                }
+            }
+        }
+    }
+
+    // Each earlier payment accounts for one row, a destination that appears twice is only skipped as often as it was paid
+    int count = 0;
+    for (auto &row : m_rows) {
+        if (!row.error.isEmpty()) {
+            continue;
+        }
+        auto it = paid.find({row.address, row.amount});
+        if (it != paid.end()) {
+            row.paidBy = it.value();
+            paid.erase(it);
+            count++;
+        }
+    }
+
+    if (count > 0) {
+        qWarning() << "Payout:" << count << "rows were already paid by an earlier run of" << m_path;
+    }
+    return count;
+}
+
+QString PayoutEngine::batchId() const {
+    return m_batchId;
+}
+
+QString PayoutEngine::journalPath() const {
+    return m_journalPath;
+}
+
+QVector<PayoutEngine::Row> PayoutEngine::rows() const {
+    return m_rows;
+}
+
+QVector<PayoutEngine::Batch> PayoutEngine::batches() const {
+    QMutexLocker locker(&m_lock);
+    return m_batches;
+}
+
+PayoutEngine::Batch PayoutEngine::batch(int index) const {
+    QMutexLocker locker(&m_lock);
+    return m_batches.value(index);
+}
+
+quint64 PayoutEngine::total() const {
+    quint64 total = 0;
+    for (const auto &batch : this->batches()) {
+        total += batch.total;
+    }
+    return total;
+}
+
+bool PayoutEngine::exportReport(const QString &path, QString &error) const {
+    QVector<Batch> batches = this->batches();
+    QHash<int, int> batchByRow;
+    for (const auto &batch : batches) {
+        for (int row : batch.rows) {
+            batchByRow[row] = batch.index;
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        error = file.errorString();
+        return false;
+    }
+
+    file.write("line,address,amount,label,batch,status,txid\n");
+    for (int i = 0; i < m_rows.size(); i++) {
+        const Row &row = m_rows[i];
+        QString batchNumber, status, txid;
+        if (!row.error.isEmpty()) {
+            status = QString("invalid: %1").arg(row.error);
+        } else if (!row.paidBy.isEmpty()) {
+            status = "paid by an earlier run";
+            txid = row.paidBy;
+        } else if (batchByRow.contains(i)) {
+            const Batch &batch = batches[batchByRow[i]];
+            batchNumber = QString::number(batch.index + 1);
+            status = stateToString(batch.state);
+            if (batch.state == Committed) {
+                txid = batch.txids.join(';');
+            }
+        }
+
+        QStringList fields = {QString::number(row.line), row.address, WalletManager::displayAmount(row.amount, false),
+                              csvField(row.label), batchNumber, csvField(status), txid};
+        file.write(fields.join(',').toUtf8() + "\n");
+    }
+
+    if (!file.commit()) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString PayoutEngine::stateToString(BatchState state) {
+    return stateNames.value(state);
+}
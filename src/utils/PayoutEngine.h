@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_PAYOUTENGINE_H
+#define FEATHER_PAYOUTENGINE_H
+
+#include <QFutureWatcher>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include "appcontext.h"
+
+// Pays a CSV file of "address,amount[,label]" rows. Destinations are split into multi-destination
+// transactions that each spend their own set of outputs, pinned by key image when the payout is planned.
+// Every state change is written to a journal in the config directory before anything is relayed, so an
+// interrupted payout can be resumed: a retry can only ever spend the same outputs as the earlier attempt,
+// which makes it impossible for a batch to be paid twice.
+class PayoutEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 16 outputs per transaction, one of them is change
+    static constexpr int maxDestinations = 15;
+
+    struct Row {
+        int line = 0;
+        QString address;
+        quint64 amount = 0;
+        QString label;
+        QString error;
+        QString paidBy; // txid, if an earlier run of an edited version of this file already paid the row
+    };
+
+    enum BatchState {
+        Unfunded = 0,
+        Planned,
+        Constructed,
+        Committed,
+        Failed
+    };
+
+    struct Batch {
+        int index = 0;
+        QVector<int> rows;
+        quint64 total = 0;
+        QStringList inputs;
+        BatchState state = Unfunded;
+        QStringList txids;   // of the latest attempt
+        QStringList history; // txids of every attempt, to recognize an attempt that made it to the network
+        int attempts = 0;
+        QString error;
+    };
+
+    explicit PayoutEngine(QSharedPointer<AppContext> ctx, QObject *parent = nullptr);
+    ~PayoutEngine() override;
+
+    // Parses the file and validates all rows in parallel, emits validated() when done
+    bool load(const QString &path, QString &error);
+
+    // Splits valid rows into batches and assigns outputs to them. Picks up the journal of an earlier run of the same file.
+    // Rows paid by earlier runs of the same path that had different contents are left out, see Row::paidBy.
+    bool plan(QString &error);
+
+    void start();
+    void cancel();
+    bool isRunning() const;
+
+    QString batchId() const;
+    QString journalPath() const;
+    QVector<Row> rows() const;
+    QVector<Batch> batches() const;
+    Batch batch(int index) const;
+    quint64 total() const;
+
+    // CSV of every row with the transaction that paid it
+    bool exportReport(const QString &path, QString &error) const;
+
+    static QString stateToString(BatchState state);
+
+signals:
+    void validated(int valid, int invalid);
+    void batchUpdated(int index);
+    void finished(int committed, int failed);
+
+private:
+    static Row validateRow(const Row &row, NetworkType::Type nettype);
+    void assignInputs(QVector<Batch*> batches);
+    bool loadJournal(QString &error);
+    int markPaidRows();
+    void writeJournal();
+    QJsonObject batchToJson(const Batch &batch) const;
+
+    void setState(int index, BatchState state, const QString &error = {});
+    void constructStage(QVector<int> indices);
+    void commitStage();
+    PendingTransaction* construct(int index);
+    bool alreadyCommitted(int index);
+    void onFinished();
+
+    QSharedPointer<AppContext> m_ctx;
+    QString m_path;
+    QString m_batchId;
+    QString m_journalPath;
+    QVector<Row> m_rows;
+    QVector<Batch> m_batches;
+
+    QFutureWatcher<Row> m_validation;
+    QThreadPool m_pool;
+
+    // Constructed transactions on their way to the commit stage
+    QList<QPair<int, PendingTransaction*>> m_queue;
+    bool m_constructDone = false;
+    QWaitCondition m_queueCondition;
+
+    // Guards m_batches, m_queue and the journal file. Calls into libwallet go through Wallet::runLocked().
+    mutable QMutex m_lock;
+
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_running{false};
+    bool m_multiBroadcast = false;
+};
+
+#endif //FEATHER_PAYOUTENGINE_H
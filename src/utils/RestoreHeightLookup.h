@@ -4,98 +4,95 @@
 #ifndef FEATHER_RESTOREHEIGHTLOOKUP_H
 #define FEATHER_RESTOREHEIGHTLOOKUP_H
 
-#include <cstdio>
-#include <cstdlib>
+#include <algorithm>
+#include <ctime>
 
-#include <monero_seed/monero_seed.hpp>
+#include <QDateTime>
 
 #include "networktype.h"
+#include "utils/RestoreHeightsData.h"
 #include "utils/Utils.h"
 
 struct RestoreHeightLookup {
+    static constexpr int blockTime = 120;
+    static constexpr int blocksPerDay = 720;
+    static constexpr int blockCalcClearance = blocksPerDay * 5;
+
     NetworkType::Type type;
-    QMap<time_t, int> data;
-    explicit RestoreHeightLookup(NetworkType::Type type) : type(type) {}
+    const RestoreHeightCheckpoint *first = nullptr;
+    const RestoreHeightCheckpoint *last = nullptr;
 
-    int dateToHeight(time_t date) {
-        // restore height based on a given timestamp using a lookup
-        // table. If it cannot find the date in the lookup table, it
-        // will calculate the blockheight based off the last known
-        // date: ((now - lastKnownDate) / blockTime) - clearance
+    constexpr explicit RestoreHeightLookup(NetworkType::Type type) : type(type) {}
 
-        if (this->type == NetworkType::TESTNET) {
-            return 1;
-        }
+    template <std::size_t N>
+    constexpr RestoreHeightLookup(NetworkType::Type type, const RestoreHeightCheckpoint (&table)[N])
+        : type(type), first(table), last(table + N) {}
 
-        int blockTime = 120;
-        int blocksPerDay = 720;
-        int blockCalcClearance = blocksPerDay * 5;
+    bool isEmpty() const {
+        return first == last;
+    }
 
-        QList<time_t> values = this->data.keys();
+    time_t genesisTimestamp() const {
+        return this->isEmpty() ? 0 : first->timestamp;
+    }
 
-        // If timestamp is before epoch, return genesis height.
-        if (date <= values.at(0)) {
+    int dateToHeight(time_t date) const {
+        // Estimate the restore height for a given timestamp by interpolating between the
+        // two surrounding checkpoints, or extrapolating from the last one. Subtracts a
+        // clearance of a few days to make sure no transactions are missed.
+
+        if (this->type == NetworkType::TESTNET || this->isEmpty()) {
             return 1;
         }
 
-        for (int i = 0; i != values.count(); i++) {
-            if (values[i] > date) {
-                if (i == 0) {
-                    return 1;
-                }
-                return this->data[values[i-1]] - blockCalcClearance;
-            }
+        // If timestamp is before epoch, return genesis height.
+        if (date <= first->timestamp) {
+            return 1;
         }
 
-        // lookup failed, calculate blockheight from last known checkpoint
-        time_t lastBlockHeightTime = values.last();
-        int lastBlockHeight = this->data[lastBlockHeightTime];
-
-        time_t deltaTime = date - lastBlockHeightTime;
-        int deltaBlocks = deltaTime / blockTime;
+        auto next = std::upper_bound(first, last, (qint64)date, [](qint64 ts, const RestoreHeightCheckpoint &cp) {
+            return ts < cp.timestamp;
+        });
+        auto prev = next - 1;
+
+        qint64 height;
+        if (next == last) {
+            // Past the last known checkpoint, assume the target block time
+            height = prev->height + (date - prev->timestamp) / blockTime;
+        } else {
+            height = interpolate(date, prev->timestamp, next->timestamp, prev->height, next->height);
+        }
 
-        int blockHeight = (lastBlockHeight + deltaBlocks) - blockCalcClearance;
-        return blockHeight;
+        return std::max<qint64>(1, height - blockCalcClearance);
     }
 
-    time_t heightToTimestamp(int height) {
-        // @TODO: most likely inefficient, refactor
-        QMap<time_t, int>::iterator i;
-        time_t timestamp = 0;
-        int heightData = 1;
-        for (i = this->data.begin(); i != this->data.end(); ++i) {
-            time_t ts = i.key();
-            if (i.value() > height)
-                return timestamp;
-            timestamp = ts;
-            heightData = i.value();
+    time_t heightToTimestamp(int height) const {
+        if (this->isEmpty()) {
+            return 0;
         }
 
-        while (heightData < height) {
-            heightData += 720; // blocks per day
-            timestamp += 86400; // seconds in day
+        if (height <= first->height) {
+            return first->timestamp;
         }
 
-        return timestamp;
+        auto next = std::upper_bound(first, last, (qint64)height, [](qint64 h, const RestoreHeightCheckpoint &cp) {
+            return h < cp.height;
+        });
+        auto prev = next - 1;
+
+        if (next == last) {
+            return prev->timestamp + (height - prev->height) * blockTime;
+        }
+        return interpolate(height, prev->height, next->height, prev->timestamp, next->timestamp);
     }
 
-    QDateTime heightToDate(int height) {
+    QDateTime heightToDate(int height) const {
         return QDateTime::fromSecsSinceEpoch(this->heightToTimestamp(height));
     }
 
-    static RestoreHeightLookup *fromFile(const QString &fn, NetworkType::Type type) {
-        // initialize this class using a lookup table, e.g `:/assets/restore_heights_monero_mainnet.txt`/
-        auto rtn = new RestoreHeightLookup(type);
-        auto data= Utils::barrayToString(Utils::fileOpen(fn));
-
-        for (const auto &line: data.split('\n')) {
-            if (line.trimmed().isEmpty()) {
-                continue;
-            }
-            auto spl = line.trimmed().split(':');
-            rtn->data[(time_t)spl.at(0).toInt()] = spl.at(1).toInt();
-        }
-        return rtn;
+private:
+    static qint64 interpolate(qint64 x, qint64 x0, qint64 x1, qint64 y0, qint64 y1) {
+        return y0 + (x - x0) * (y1 - y0) / (x1 - x0);
     }
 };
 
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "SyncBundle.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+
+namespace {
+    const QByteArray magic = "FSYN";
+    const QString textPrefix = "feather-sync:";
+    constexpr quint8 formatVersion = 1;
+    constexpr int checksumSize = 32;
+}
+
+QByteArray SyncBundle::encode() const {
+    // libwallet encrypts the payload, so compression mostly helps small bundles with little entropy
+    QByteArray compressed = qCompress(payload, 9);
+    bool isCompressed = compressed.size() < payload.size();
+
+    QByteArray data = magic;
+    QDataStream stream(&data, QIODevice::Append);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << formatVersion << static_cast<quint8>(kind) << static_cast<quint8>(nettype) << walletId
+           << sequence << acknowledged << full << isCompressed << (isCompressed ? compressed : payload);
+
+    data += QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    return data;
+}
+
+bool SyncBundle::decode(const QByteArray &input, SyncBundle &bundle, QString &error) {
+    QByteArray data = input.startsWith(textPrefix.toLatin1()) ? fromText(QString::fromLatin1(input)) : input;
+
+    if (!data.startsWith(magic) || data.size() < magic.size() + checksumSize) {
+        error = "Not a sync bundle";
+        return false;
+    }
+
+    QByteArray content = data.left(data.size() - checksumSize);
+    if (QCryptographicHash::hash(content, QCryptographicHash::Sha256) != data.right(checksumSize)) {
+        error = "Sync bundle is damaged, checksum mismatch";
+        return false;
+    }
+
+    QDataStream stream(content.mid(magic.size()));
+    stream.setVersion(QDataStream::Qt_5_15);
+
+    quint8 version, kind, nettype;
+    bool isCompressed;
+    QByteArray payload;
+    stream >> version;
+    if (version != formatVersion) {
+        error = "Sync bundle was made by an incompatible version of Feather";
+        return false;
+    }
+
+    stream >> kind >> nettype >> bundle.walletId >> bundle.sequence >> bundle.acknowledged >> bundle.full >> isCompressed >> payload;
+    if (stream.status() != QDataStream::Ok || (kind != Outputs && kind != KeyImages)) {
+        error = "Sync bundle is malformed";
+        return false;
+    }
+
+    bundle.kind = static_cast<Kind>(kind);
+    bundle.nettype = static_cast<NetworkType::Type>(nettype);
+    bundle.payload = isCompressed ? qUncompress(payload) : payload;
+    if (bundle.payload.isEmpty()) {
+        error = "Sync bundle is malformed";
+        return false;
+    }
+
+    return true;
+}
+
+QString SyncBundle::toText(const QByteArray &data) {
+    return textPrefix + QString::fromLatin1(data.toBase64());
+}
+
+QByteArray SyncBundle::fromText(const QString &text) {
+    QString trimmed = text.trimmed();
+    if (!trimmed.startsWith(textPrefix)) {
+        return {};
+    }
+    return QByteArray::fromBase64(trimmed.mid(textPrefix.size()).toLatin1());
+}
+
+QByteArray SyncBundle::walletIdFor(const QString &primaryAddress) {
+    return QCryptographicHash::hash(primaryAddress.toLatin1(), QCryptographicHash::Sha256).left(8);
+}
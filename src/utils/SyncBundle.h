@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_SYNCBUNDLE_H
+#define FEATHER_SYNCBUNDLE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "utils/networktype.h"
+
+// Envelope for the offline signing round trip. A view-only wallet sends its outputs, the offline wallet
+// answers with key images. The payload is the file exported by libwallet, usually only what was added
+// since the other wallet acknowledged the previous bundle.
+struct SyncBundle {
+    enum Kind : quint8 {
+        Outputs = 1,
+        KeyImages = 2
+    };
+
+    Kind kind = Outputs;
+    NetworkType::Type nettype = NetworkType::MAINNET;
+    QByteArray walletId;
+    quint32 sequence = 0;     // sequence number of this bundle, per sending wallet
+    quint32 acknowledged = 0; // highest sequence number the sender imported from the receiver
+    bool full = false;
+    QByteArray payload;
+
+    QByteArray encode() const;
+    static bool decode(const QByteArray &data, SyncBundle &bundle, QString &error);
+
+    // Text form for the clipboard
+    static QString toText(const QByteArray &data);
+    static QByteArray fromText(const QString &text);
+
+    static QByteArray walletIdFor(const QString &primaryAddress);
+};
+
+#endif //FEATHER_SYNCBUNDLE_H
@@ -7,6 +7,7 @@
 #include <QDesktopServices>
 #include <QRegularExpression>
 
+#include "utils/Trace.h"
 #include "utils/Utils.h"
 #include "utils/os/tails.h"
 #include "appcontext.h"
@@ -49,6 +50,7 @@ void TorManager::stop() {
 }
 
 void TorManager::start() {
+    TRACE_BEGIN("Tor start");
     m_checkConnectionTimer->start(5000);
 
     if (m_localTor) {
@@ -119,6 +121,9 @@ void TorManager::checkConnection() {
 }
 
 void TorManager::setConnectionState(bool connected) {
+    if (connected && !this->torConnected) {
+        TRACE_END("Tor start");
+    }
     this->torConnected = connected;
     emit connectionStateChanged(connected);
 }
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThread>
+
+Trace* Trace::instance() {
+    static Trace trace;
+    return &trace;
+}
+
+void Trace::start(const QString &path) {
+    QMutexLocker locker(&m_mutex);
+    if (m_enabled) {
+        return;
+    }
+
+    m_path = path;
+    m_events.reserve(4096);
+    m_threadIds.insert(reinterpret_cast<quintptr>(QThread::currentThreadId()), 0);
+    m_timer.start();
+    m_enabled = true;
+
+    if (qApp) {
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, [this]{
+            this->stop();
+        });
+    }
+
+    qInfo() << "Tracing enabled, writing to" << path;
+}
+
+void Trace::stop() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled) {
+        return;
+    }
+    m_enabled = false;
+
+    QJsonArray events;
+    for (const auto &event : m_events) {
+        QJsonObject obj;
+        obj["name"] = QString::fromUtf8(event.name);
+        obj["cat"] = "feather";
+        obj["ph"] = QString(QChar(event.phase));
+        obj["pid"] = 1;
+        obj["tid"] = event.tid;
+        obj["ts"] = event.ts;
+        if (event.phase == 'X') {
+            obj["dur"] = event.dur;
+        } else {
+            obj["id"] = QString::number(qHash(QByteArray(event.name)), 16);
+        }
+        events.append(obj);
+    }
+
+    for (auto it = m_threadIds.constBegin(); it != m_threadIds.constEnd(); ++it) {
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = 1;
+        meta["tid"] = it.value();
+        meta["args"] = QJsonObject{{"name", it.value() == 0 ? "main" : QString("thread %1").arg(it.value())}};
+        events.append(meta);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to open trace file:" << m_path;
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "Unable to write trace file:" << m_path;
+        return;
+    }
+
+    qInfo() << "Wrote" << m_events.size() << "trace events to" << m_path;
+    m_events.clear();
+}
+
+qint64 Trace::now() const {
+    return m_timer.nsecsElapsed() / 1000;
+}
+
+void Trace::complete(const char *name, qint64 startUs, qint64 durationUs) {
+    this->append({name, 'X', this->threadId(), startUs, durationUs});
+}
+
+void Trace::asyncBegin(const char *name) {
+    if (!m_enabled) {
+        return;
+    }
+    this->append({name, 'b', this->threadId(), this->now(), 0});
+}
+
+void Trace::asyncEnd(const char *name) {
+    if (!m_enabled) {
+        return;
+    }
+    this->append({name, 'e', this->threadId(), this->now(), 0});
+}
+
+int Trace::threadId() {
+    auto key = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    QMutexLocker locker(&m_mutex);
+    auto it = m_threadIds.constFind(key);
+    if (it != m_threadIds.constEnd()) {
+        return it.value();
+    }
+    int id = m_threadIds.size();
+    m_threadIds.insert(key, id);
+    return id;
+}
+
+void Trace::append(const Event &event) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled) {
+        return;
+    }
+    m_events.append(event);
+}
+
+Trace::Scope::Scope(const char *name)
+    : m_name(name)
+{
+    if (Trace::instance()->isEnabled()) {
+        m_start = Trace::instance()->now();
+    }
+}
+
+Trace::Scope::~Scope() {
+    if (m_start < 0) {
+        return;
+    }
+    auto trace = Trace::instance();
+    trace->complete(m_name, m_start, trace->now() - m_start);
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_TRACE_H
+#define FEATHER_TRACE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+// Records spans in the Chrome trace event format, viewable in chrome://tracing or ui.perfetto.dev.
+// Enabled with the WITH_TRACING build option, recording starts with --trace <file>.
+class Trace
+{
+public:
+    static Trace* instance();
+
+    void start(const QString &path);
+    void stop();
+    bool isEnabled() const { return m_enabled; }
+
+    // Event names must be string literals, they are stored by pointer
+    void complete(const char *name, qint64 startUs, qint64 durationUs);
+    void asyncBegin(const char *name);
+    void asyncEnd(const char *name);
+
+    qint64 now() const;
+
+    class Scope {
+    public:
+        explicit Scope(const char *name);
+        ~Scope();
+
+    private:
+        const char *m_name;
+        qint64 m_start = -1;
+    };
+
+private:
+    struct Event {
+        const char *name;
+        char phase;
+        int tid;
+        qint64 ts;
+        qint64 dur;
+    };
+
+    Trace() = default;
+    int threadId();
+    void append(const Event &event);
+
+    std::atomic<bool> m_enabled{false};
+    QString m_path;
+    QElapsedTimer m_timer;
+    QMutex m_mutex;
+    QVector<Event> m_events;
+    QHash<quintptr, int> m_threadIds;
+};
+
+#if defined(HAS_TRACING)
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(_traceScope, __LINE__)(name)
+#define TRACE_BEGIN(name) Trace::instance()->asyncBegin(name)
+#define TRACE_END(name) Trace::instance()->asyncEnd(name)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_BEGIN(name) do {} while (0)
+#define TRACE_END(name) do {} while (0)
+#endif
+
+#endif //FEATHER_TRACE_H
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#include "TxBlobStore.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSet>
+
+#include "crypto/chacha.h"
+
+namespace {
+    constexpr int macSize = 32;
+}
+
+TxBlobStore::TxBlobStore(const QString &path, const QByteArray &key, QObject *parent)
+        : QObject(parent)
+        , m_path(path)
+        , m_encryptionKey(QCryptographicHash::hash(key + "encryption", QCryptographicHash::Sha256))
+        , m_macKey(QCryptographicHash::hash(key + "authentication", QCryptographicHash::Sha256))
+{
+    if (!QDir().mkpath(m_path)) {
+        qWarning() << "Unable to create transaction store:" << m_path;
+    }
+    this->loadIndex();
+}
+
+bool TxBlobStore::add(const QString &txid, const QString &txHex) {
+    QByteArray tx = QByteArray::fromHex(txHex.toLatin1());
+    if (txid.isEmpty() || tx.isEmpty()) {
+        return false;
+    }
+
+    QString blob = this->blobName(tx);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (!QFile::exists(this->blobPath(blob))) {
+        QSaveFile file(this->blobPath(blob));
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Unable to store transaction" << txid << ":" << file.errorString();
+            return false;
+        }
+        file.write(this->encrypt(qCompress(tx, 9)));
+        if (!file.commit()) {
+            qWarning() << "Unable to store transaction" << txid << ":" << file.errorString();
+            return false;
+        }
+    }
+
+    Entry entry;
+    entry.blob = blob;
+    entry.added = QDateTime::currentSecsSinceEpoch();
+    m_index.insert(txid, entry);
+    return this->saveIndex();
+}
+
+QString TxBlobStore::get(const QString &txid) const {
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_index.contains(txid)) {
+        return {};
+    }
+
+    QString blob = m_index.value(txid).blob;
+    QFile file(this->blobPath(blob));
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to read transaction" << txid << ":" << file.errorString();
+        return {};
+    }
+
+    QByteArray tx = qUncompress(this->decrypt(file.readAll()));
+    if (tx.isEmpty() || this->blobName(tx) != blob) {
+        qWarning() << "Stored transaction" << txid << "is corrupt";
+        return {};
+    }
+    return tx.toHex();
+}
+
+bool TxBlobStore::contains(const QString &txid) const {
+    QMutexLocker locker(&m_mutex);
+    return m_index.contains(txid);
+}
+
+int TxBlobStore::count() const {
+    QMutexLocker locker(&m_mutex);
+    return m_index.size();
+}
+
+int TxBlobStore::prune(const QHash<QString, quint64> &confirmations, quint64 depth, qint64 maxAge) {
+    QMutexLocker locker(&m_mutex);
+
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    QSet<QString> dropped;
+    int removed = 0;
+    for (auto it = m_index.begin(); it != m_index.end();) {
+        bool expired = confirmations.value(it.key(), 0) >= depth || now - it->added > maxAge;
+        if (expired) {
+            dropped.insert(it->blob);
+            it = m_index.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+
+    if (removed == 0) {
+        return 0;
+    }
+
+    // Blobs are shared by content, only remove the ones nothing points to anymore
+    for (const auto &entry : m_index) {
+        dropped.remove(entry.blob);
+    }
+    for (const auto &blob : dropped) {
+        QFile::remove(this->blobPath(blob));
+    }
+
+    this->saveIndex();
+    return removed;
+}
+
+void TxBlobStore::loadIndex() {
+    QFile file(QDir(m_path).filePath("index.bin"));
+    if (!file.exists()) {
+        return;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to read transaction store index:" << file.errorString();
+        return;
+    }
+
+    QByteArray data = this->decrypt(file.readAll());
+    if (data.isEmpty()) {
+        qWarning() << "Transaction store index is corrupt or belongs to another wallet";
+        return;
+    }
+
+    QJsonObject index = QJsonDocument::fromJson(data).object();
+    for (auto it = index.begin(); it != index.end(); ++it) {
+        QJsonObject obj = it.value().toObject();
+        Entry entry;
+        entry.blob = obj.value("blob").toString();
+        entry.added = obj.value("added").toVariant().toLongLong();
+        if (!entry.blob.isEmpty()) {
+            m_index.insert(it.key(), entry);
+        }
+    }
+}
+
+bool TxBlobStore::saveIndex() const {
+    QJsonObject index;
+    for (auto it = m_index.begin(); it != m_index.end(); ++it) {
+        QJsonObject obj;
+        obj["blob"] = it->blob;
+        obj["added"] = it->added;
+        index[it.key()] = obj;
+    }
+
+    QSaveFile file(QDir(m_path).filePath("index.bin"));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write transaction store index:" << file.errorString();
+        return false;
+    }
+    file.write(this->encrypt(QJsonDocument(index).toJson(QJsonDocument::Compact)));
+    if (!file.commit()) {
+        qWarning() << "Unable to write transaction store index:" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString TxBlobStore::blobPath(const QString &blob) const {
+    return QDir(m_path).filePath(blob + ".bin");
+}
+
+QString TxBlobStore::blobName(const QByteArray &tx) const {
+    return QMessageAuthenticationCode::hash(tx, m_macKey, QCryptographicHash::Sha256).toHex();
+}
+
+// iv || ciphertext || HMAC-SHA256(iv || ciphertext)
+QByteArray TxBlobStore::encrypt(const QByteArray &data) const {
+    QByteArray iv(CHACHA_IV_SIZE, 0);
+    for (auto &c : iv) {
+        c = static_cast<char>(QRandomGenerator::system()->bounded(256));
+    }
+
+    QByteArray cipher(data.size(), 0);
+    crypto::chacha20(data.constData(), data.size(), reinterpret_cast<const uint8_t *>(m_encryptionKey.constData()),
+                     reinterpret_cast<const uint8_t *>(iv.constData()), cipher.data());
+
+    QByteArray out = iv + cipher;
+    return out + QMessageAuthenticationCode::hash(out, m_macKey, QCryptographicHash::Sha256);
+}
+
+QByteArray TxBlobStore::decrypt(const QByteArray &data) const {
+    if (data.size() < CHACHA_IV_SIZE + macSize) {
+        return {};
+    }
+
+    QByteArray payload = data.left(data.size() - macSize);
+    if (QMessageAuthenticationCode::hash(payload, m_macKey, QCryptographicHash::Sha256) != data.right(macSize)) {
+        return {};
+    }
+
+    QByteArray cipher = payload.mid(CHACHA_IV_SIZE);
+    QByteArray plain(cipher.size(), 0);
+    crypto::chacha20(cipher.constData(), cipher.size(), reinterpret_cast<const uint8_t *>(m_encryptionKey.constData()),
+                     reinterpret_cast<const uint8_t *>(payload.constData()), plain.data());
+    return plain;
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// SPDX-FileCopyrightText: 2020-2022 The Monero Project
+
+#ifndef FEATHER_TXBLOBSTORE_H
+#define FEATHER_TXBLOBSTORE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+
+// Signed transactions we created, kept so they can be resent until they are buried deep enough.
+// Blobs are stored zlib compressed in a directory next to the wallet, with an index from txid to blob.
+// Nothing here goes through the wallet cache. Blobs and index are encrypted with ChaCha20 under a key derived
+// from the wallet's, and blobs are named after a keyed hash of the transaction, so the directory doesn't
+// tell anyone without the wallet which transactions it sent.
+class TxBlobStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    // key is a 32 byte secret that stays the same for the wallet
+    TxBlobStore(const QString &path, const QByteArray &key, QObject *parent = nullptr);
+
+    bool add(const QString &txid, const QString &txHex);
+    QString get(const QString &txid) const;
+    bool contains(const QString &txid) const;
+
+    // Drops transactions with at least depth confirmations, and any transaction older than maxAge seconds,
+    // e.g. ones that never made it into a block. Returns the number of transactions dropped.
+    int prune(const QHash<QString, quint64> &confirmations, quint64 depth, qint64 maxAge);
+
+    int count() const;
+
+private:
+    struct Entry {
+        QString blob;
+        qint64 added = 0;
+    };
+
+    void loadIndex();
+    bool saveIndex() const;
+    QString blobPath(const QString &blob) const;
+    QString blobName(const QByteArray &tx) const;
+    QByteArray encrypt(const QByteArray &data) const;
+    QByteArray decrypt(const QByteArray &data) const;
+
+    QString m_path;
+    QByteArray m_encryptionKey;
+    QByteArray m_macKey;
+    QHash<QString, Entry> m_index;
+    mutable QMutex m_mutex;
+};
+
+#endif //FEATHER_TXBLOBSTORE_H
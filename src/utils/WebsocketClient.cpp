@@ -3,7 +3,10 @@
 
 #include "WebsocketClient.h"
 
+#include <QCborMap>
+#include <QCborValue>
 #include <QCoreApplication>
+#include <QJsonArray>
 #include "utils/Utils.h"
 
 WebsocketClient::WebsocketClient(QObject *parent)
@@ -37,6 +40,23 @@ void WebsocketClient::sendMsg(const QByteArray &data) {
     }
 }
 
+void WebsocketClient::subscribe(const QStringList &topics) {
+    m_topics = topics;
+
+    // Servers that don't understand this message keep sending every topic as JSON,
+    // which is handled as before. Supported encodings are listed in order of preference.
+    QJsonObject data;
+    data["topics"] = QJsonArray::fromStringList(m_topics);
+    data["encodings"] = QJsonArray{"cbor", "json"};
+    data["deltas"] = QJsonArray{"txFiatHistory"};
+
+    QJsonObject msg;
+    msg["cmd"] = "subscribe";
+    msg["data"] = data;
+
+    this->sendMsg(QJsonDocument(msg).toJson(QJsonDocument::Compact));
+}
+
 void WebsocketClient::start() {
     if (m_stopped) {
         return;
@@ -63,6 +83,9 @@ void WebsocketClient::stop() {
 
 void WebsocketClient::onConnected() {
     qDebug() << "WebSocket connected";
+    if (!m_topics.isEmpty()) {
+        this->subscribe(m_topics);
+    }
     emit connectionEstablished();
 }
 
@@ -90,6 +113,13 @@ void WebsocketClient::onError(QAbstractSocket::SocketError error) {
 }
 
 void WebsocketClient::nextWebsocketUrl() {
+    // Allows pointing Feather at a local stand-in server for testing
+    QString overrideUrl = qEnvironmentVariable("FEATHER_WEBSOCKET_URL");
+    if (!overrideUrl.isEmpty()) {
+        m_url = QUrl(overrideUrl);
+        return;
+    }
+
     m_url = constants::websocketUrls[m_websocketUrlIndex];
     m_websocketUrlIndex = (m_websocketUrlIndex+1)%constants::websocketUrls.length();
 }
@@ -100,16 +130,41 @@ void WebsocketClient::onConnectionTimeout() {
     this->onDisconnected();
 }
 
+bool WebsocketClient::decodeMessage(const QByteArray &message, QJsonObject &object) {
+    if (message.isEmpty()) {
+        return false;
+    }
+
+    // JSON frames always start with '{', a CBOR map never does
+    if (message.at(0) == '{') {
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(message, &error);
+        if (error.error != QJsonParseError::NoError) {
+            qCritical() << "Could not interpret WebSocket message as JSON";
+            return false;
+        }
+        object = doc.object();
+        return true;
+    }
+
+    QCborParserError error;
+    QCborValue value = QCborValue::fromCbor(message, &error);
+    if (error.error != QCborError::NoError || !value.isMap()) {
+        qCritical() << "Could not interpret WebSocket message as CBOR:" << error.errorString();
+        return false;
+    }
+    object = value.toMap().toJsonObject();
+    return true;
+}
+
 void WebsocketClient::onbinaryMessageReceived(const QByteArray &message) {
 //    qDebug() << "WebSocket received:" << message;
 
-    if (!Utils::validateJSON(message)) {
-        qCritical() << "Could not interpret WebSocket message as JSON";
+    QJsonObject object;
+    if (!this->decodeMessage(message, object)) {
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(message);
-    QJsonObject object = doc.object();
     if(!object.contains("cmd") || !object.contains("data")) {
         qCritical() << "Invalid WebSocket message received";
         return;
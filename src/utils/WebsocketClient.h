@@ -20,6 +20,7 @@ public:
     void restart();
     void stop();
     void sendMsg(const QByteArray &data);
+    void subscribe(const QStringList &topics);
 
     QWebSocket webSocket;
 
@@ -37,7 +38,10 @@ private slots:
     void onConnectionTimeout();
 
 private:
+    bool decodeMessage(const QByteArray &message, QJsonObject &object);
+
     QUrl m_url;
+    QStringList m_topics;
     QTimer m_pingTimer;
     QTimer m_connectionTimeout;
     int m_timeout = 10;
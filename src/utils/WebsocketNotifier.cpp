@@ -13,16 +13,97 @@ WebsocketNotifier::WebsocketNotifier(QObject *parent)
     , websocketClient(new WebsocketClient(this))
 {
     connect(&websocketClient, &WebsocketClient::WSMessage, this, &WebsocketNotifier::onWSMessage);
+    connect(config(), &Config::changed, this, &WebsocketNotifier::onConfigChanged);
+
+    this->updateSubscription();
 }
 
 QPointer<WebsocketNotifier> WebsocketNotifier::m_instance(nullptr);
 
+QStringList WebsocketNotifier::topics() {
+    QStringList topics{"blockheights", "nodes", "crypto_rates", "fiat_rates", "txFiatHistory"};
+
+    if (config()->get(Config::showTabHome).toBool()) {
+        topics << "reddit" << "ccs" << "bounties" << "revuo";
+    }
+
+#if defined(CHECK_UPDATES)
+    topics << "updates";
+#endif
+
+#if defined(HAS_XMRIG)
+    if (config()->get(Config::showTabXMRig).toBool()) {
+        topics << "xmrig";
+    }
+#endif
+
+#if defined(HAS_LOCALMONERO)
+    if (config()->get(Config::showTabExchange).toBool()) {
+        topics << "localmonero_countries" << "localmonero_currencies" << "localmonero_payment_methods";
+    }
+#endif
+
+    return topics;
+}
+
+void WebsocketNotifier::updateSubscription() {
+    QStringList topics = this->topics();
+    QSet<QString> newTopics{topics.begin(), topics.end()};
+    if (newTopics == m_topics) {
+        return;
+    }
+
+    // Replay cached data for topics that were just enabled
+    QSet<QString> added = newTopics - m_topics;
+    m_topics = newTopics;
+    for (const auto &topic : added) {
+        if (m_cache.contains(topic)) {
+            this->dispatch(topic, m_cache[topic]);
+        }
+    }
+
+    websocketClient.subscribe(topics);
+}
+
+void WebsocketNotifier::onConfigChanged(Config::ConfigKey key) {
+    if (key == Config::showTabHome || key == Config::showTabXMRig || key == Config::showTabExchange) {
+        this->updateSubscription();
+    }
+}
+
 void WebsocketNotifier::onWSMessage(const QJsonObject &msg) {
     QString cmd = msg.value("cmd").toString();
 
     m_lastMessageReceived = QDateTime::currentDateTimeUtc();
-    m_cache[cmd] = msg;
 
+    // Delta updates only carry changed keys, merge them into the cached message
+    if (msg.value("delta").toBool()) {
+        // Nothing to apply it to yet, wait for a full message for this topic
+        if (!m_cache.contains(cmd)) {
+            return;
+        }
+
+        QJsonObject merged = m_cache[cmd].value("data").toObject();
+        QJsonObject delta = msg.value("data").toObject();
+        for (auto it = delta.constBegin(); it != delta.constEnd(); ++it) {
+            merged[it.key()] = it.value();
+        }
+        m_cache[cmd]["data"] = merged;
+    } else {
+        QJsonObject full = msg;
+        full.remove("delta");
+        m_cache[cmd] = full;
+    }
+
+    // Older servers ignore the subscription and send all topics
+    if (!m_topics.contains(cmd)) {
+        return;
+    }
+
+    this->dispatch(cmd, m_cache[cmd]);
+}
+
+void WebsocketNotifier::dispatch(const QString &cmd, const QJsonObject &msg) {
     if (cmd == "blockheights") {
         QJsonObject data = msg.value("data").toObject();
         int mainnet = data.value("mainnet").toInt();
@@ -98,8 +179,16 @@ void WebsocketNotifier::onWSMessage(const QJsonObject &msg) {
 }
 
 void WebsocketNotifier::emitCache() {
-    for (const auto &msg : m_cache) {
-        this->onWSMessage(msg);
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        if (m_topics.contains(it.key())) {
+            this->dispatch(it.key(), it.value());
+        }
+    }
+}
+
+void WebsocketNotifier::emitCache(const QString &topic) {
+    if (m_topics.contains(topic) && m_cache.contains(topic)) {
+        this->dispatch(topic, m_cache[topic]);
     }
 }
 
@@ -16,6 +16,7 @@
 #include "widgets/CCSEntry.h"
 #include "widgets/RevuoItem.h"
 #include "TxFiatHistory.h"
+#include "config.h"
 
 class WebsocketNotifier : public QObject {
     Q_OBJECT
@@ -28,8 +29,10 @@ public:
 
     static WebsocketNotifier* instance();
     void emitCache();
+    void emitCache(const QString &topic);
 
     bool stale(int minutes);
+    QStringList topics();
 
 signals:
     void BlockHeightsReceived(int mainnet, int stagenet);
@@ -49,6 +52,7 @@ signals:
 
 private slots:
     void onWSMessage(const QJsonObject &msg);
+    void onConfigChanged(Config::ConfigKey key);
 
     void onWSNodes(const QJsonArray &nodes);
     void onWSReddit(const QJsonArray &reddit_data);
@@ -59,8 +63,12 @@ private slots:
     void onWSXMRigDownloads(const QJsonObject &downloads);
 
 private:
+    void dispatch(const QString &cmd, const QJsonObject &msg);
+    void updateSubscription();
+
     static QPointer<WebsocketNotifier> m_instance;
 
+    QSet<QString> m_topics;
     QHash<QString, QJsonObject> m_cache;
     QDateTime m_lastMessageReceived;
 };
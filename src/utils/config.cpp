@@ -4,6 +4,9 @@
 // SPDX-FileCopyrightText: 2020-2022 The Monero Project
 
 #include "config.h"
+
+#include <QJsonDocument>
+
 #include "utils/Utils.h"
 #include "utils/os/tails.h"
 
@@ -39,6 +42,7 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
         {Config::nodes,{QS("nodes"), "{}"}},
         {Config::nodeSource,{QS("nodeSource"), 0}},
         {Config::useOnionNodes,{QS("useOnionNodes"), false}},
+        {Config::useBlockCache,{QS("useBlockCache"), false}},
 
         // Tabs
         {Config::showTabHome,{QS("showTabHome"), true}},
@@ -72,9 +76,12 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
         {Config::offlineMode, {QS("offlineMode"), false}},
 
         {Config::multiBroadcast, {QS("multiBroadcast"), true}},
+        {Config::prepareTransactions, {QS("prepareTransactions"), false}},
+        {Config::txStoreConfirmations, {QS("txStoreConfirmations"), 20}},
         {Config::warnOnExternalLink,{QS("warnOnExternalLink"), true}},
         {Config::hideBalance, {QS("hideBalance"), false}},
         {Config::disableLogging, {QS("disableLogging"), false}},
+        {Config::animatedQrFrameRate, {QS("animatedQrFrameRate"), 5}},
 
         {Config::blockExplorer,{QS("blockExplorer"), "exploremonero.com"}},
         {Config::redditFrontend, {QS("redditFrontend"), "old.reddit.com"}},
@@ -119,7 +126,9 @@ void Config::set(ConfigKey key, const QVariant& value)
     auto cfg = configStrings[key];
     m_settings->setValue(cfg.name, value);
 
-    this->sync();
+    this->appendJournal({{"set", cfg.name}, {"value", QJsonValue::fromVariant(value)}});
+    m_syncTimer.start();
+    this->updateSnapshot();
     emit changed(key);
 }
 
@@ -128,6 +137,9 @@ void Config::remove(ConfigKey key)
     auto cfg = configStrings[key];
     m_settings->remove(cfg.name);
 
+    this->appendJournal({{"remove", cfg.name}});
+    m_syncTimer.start();
+    this->updateSnapshot();
     emit changed(key);
 }
 
@@ -140,12 +152,87 @@ void Config::remove(ConfigKey key)
  */
 void Config::sync()
 {
+    m_syncTimer.stop();
     m_settings->sync();
+
+    if (m_settings->status() != QSettings::NoError) {
+        qWarning() << "Unable to write config file, keeping journal:" << m_settings->fileName();
+        return;
+    }
+
+    // Everything in the journal is now in the config file
+    if (m_journal.isOpen()) {
+        m_journal.resize(0);
+    }
 }
 
 void Config::resetToDefaults()
 {
     m_settings->clear();
+
+    this->appendJournal({{"clear", true}});
+    m_syncTimer.start();
+    this->updateSnapshot();
+}
+
+std::shared_ptr<const ConfigSnapshot> Config::snapshot() const
+{
+    // Not lock-free: libstdc++ guards atomic shared_ptr access with a small spinlock pool
+    return std::atomic_load(&m_snapshot);
+}
+
+void Config::updateSnapshot()
+{
+    auto snapshot = std::make_shared<ConfigSnapshot>();
+#define X(key, type, conv) snapshot->key = this->get(Config::key).conv();
+    FEATHER_CONFIG_SNAPSHOT(X)
+#undef X
+    std::atomic_store(&m_snapshot, std::shared_ptr<const ConfigSnapshot>(std::move(snapshot)));
+}
+
+void Config::appendJournal(const QJsonObject &entry)
+{
+    if (!m_journal.isOpen()) {
+        return;
+    }
+
+    m_journal.write(QJsonDocument(entry).toJson(QJsonDocument::Compact) + "\n");
+    m_journal.flush();
+}
+
+void Config::replayJournal()
+{
+    if (!m_journal.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        qWarning() << "Unable to open config journal:" << m_journal.fileName();
+        return;
+    }
+
+    m_journal.seek(0);
+    QByteArray data = m_journal.readAll();
+    if (data.isEmpty()) {
+        return;
+    }
+
+    qInfo() << "Recovering unsaved config changes from journal";
+
+    int count = 0;
+    for (const auto &line : data.split('\n')) {
+        // The last line may be incomplete if we crashed while writing it
+        QJsonObject entry = QJsonDocument::fromJson(line).object();
+        if (entry.contains("set")) {
+            m_settings->setValue(entry.value("set").toString(), entry.value("value").toVariant());
+        } else if (entry.contains("remove")) {
+            m_settings->remove(entry.value("remove").toString());
+        } else if (entry.contains("clear")) {
+            m_settings->clear();
+        } else {
+            continue;
+        }
+        count++;
+    }
+
+    qInfo() << QString("Replayed %1 config changes").arg(count);
+    this->sync();
 }
 
 Config::Config(const QString& fileName, QObject* parent)
@@ -213,6 +300,16 @@ void Config::init(const QString& configFileName)
     const QSettings::Format jsonFormat = QSettings::registerFormat("json", Utils::readJsonFile, Utils::writeJsonFile);
     QSettings::setDefaultFormat(jsonFormat);
     m_settings.reset(new QSettings(configFileName, jsonFormat));
+    m_settings->setAtomicSyncRequired(true); // write to a temporary file and rename
+
+    m_journal.setFileName(configFileName + ".journal");
+    this->replayJournal();
+    this->updateSnapshot();
+
+    // Batch writes, QSettings keeps the values in memory until then
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(1000);
+    connect(&m_syncTimer, &QTimer::timeout, this, &Config::sync);
 
     connect(qApp, &QCoreApplication::aboutToQuit, this, &Config::sync);
 }
@@ -10,6 +10,28 @@
 #include <QSettings>
 #include <QPointer>
 #include <QDir>
+#include <QFile>
+#include <QJsonObject>
+#include <QTimer>
+
+#include <memory>
+
+// Keys that are read on hot paths, with their types. Accessed through Config::snapshot().
+#define FEATHER_CONFIG_SNAPSHOT(X) \
+    X(preferredFiatCurrency, QString, toString) \
+    X(dateFormat, QString, toString) \
+    X(timeFormat, QString, toString) \
+    X(amountPrecision, int, toInt) \
+    X(hideBalance, bool, toBool) \
+    X(balanceDisplay, int, toInt)
+
+// Immutable copy of frequently read settings, replaced whenever the config changes
+struct ConfigSnapshot
+{
+#define X(key, type, conv) type key{};
+    FEATHER_CONFIG_SNAPSHOT(X)
+#undef X
+};
 
 class Config : public QObject
 {
@@ -43,6 +65,7 @@ public:
         nodes,
         nodeSource,
         useOnionNodes,
+        useBlockCache,
 
         // Tabs
         showTabHome,
@@ -76,9 +99,12 @@ public:
         offlineMode,
 
         multiBroadcast,
+        prepareTransactions,
+        txStoreConfirmations,
         warnOnExternalLink,
         hideBalance,
         disableLogging,
+        animatedQrFrameRate,
 
         blockExplorer,
         redditFrontend,
@@ -117,6 +143,8 @@ public:
 
     ~Config() override;
     QVariant get(ConfigKey key);
+    // Safe to call from any thread, costs a shared_ptr copy instead of a QSettings lookup
+    std::shared_ptr<const ConfigSnapshot> snapshot() const;
     QString getFileName();
     void set(ConfigKey key, const QVariant& value);
     void remove(ConfigKey key);
@@ -134,11 +162,21 @@ private:
     Config(const QString& fileName, QObject* parent = nullptr);
     explicit Config(QObject* parent);
     void init(const QString& configFileName);
+    void appendJournal(const QJsonObject &entry);
+    void updateSnapshot();
+    void replayJournal();
 
     static QPointer<Config> m_instance;
 
     QScopedPointer<QSettings> m_settings;
     QHash<QString, QVariant> m_defaults;
+
+    // Changes are kept in memory by QSettings and written out in batches,
+    // the journal makes sure they survive a crash in between
+    QTimer m_syncTimer;
+    QFile m_journal;
+
+    std::shared_ptr<const ConfigSnapshot> m_snapshot;
 };
 
 inline Config* config()
@@ -146,4 +184,9 @@ inline Config* config()
     return Config::instance();
 }
 
+inline std::shared_ptr<const ConfigSnapshot> configSnapshot()
+{
+    return Config::instance()->snapshot();
+}
+
 #endif //FEATHER_CONFIG_H
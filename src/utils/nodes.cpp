@@ -11,6 +11,9 @@
 #include "utils/WebsocketNotifier.h"
 #include "utils/TorManager.h"
 
+// Nodes that restores download blocks from besides the connected one
+constexpr int maxDownloadNodes = 4;
+
 bool NodeList::addNode(const QString &node, NetworkType::Type networkType, NodeList::Type source) {
     // We can't obtain references to QJsonObjects...
     QJsonObject obj = this->getConfigData();
@@ -198,23 +201,35 @@ void Nodes::connectToNode(const FeatherNode &node) {
 
     qInfo() << QString("Attempting to connect to %1 (%2)").arg(node.toAddress()).arg(node.custom ? "custom" : "ws");
 
+    // Set on every connect, a previous connection may have left the block cache's login or SSL setting behind
     if (!node.url.userName().isEmpty() && !node.url.password().isEmpty())
         m_ctx->wallet->setDaemonLogin(node.url.userName(), node.url.password());
+    else
+        m_ctx->wallet->setDaemonLogin("", "");
 
     // Don't use SSL over Tor
     m_ctx->wallet->setUseSSL(!node.isOnion());
 
-    QString proxyAddress;
-    if (useTorProxy(node)) {
-        if (!torManager()->isLocalTor()) {
-            proxyAddress = QString("%1:%2").arg(torManager()->featherTorHost, QString::number(torManager()->featherTorPort));
-        } else {
-            proxyAddress = QString("%1:%2").arg(config()->get(Config::socks5Host).toString(),
-                                                config()->get(Config::socks5Port).toString());
+    QString proxyAddress = this->proxyAddress(node);
+    QString daemonAddress = node.toAddress();
+
+    // Route through the local block cache, which talks to the node on the wallet's behalf
+    if (config()->get(Config::useBlockCache).toBool()) {
+        QList<BlockCacheProxy::Daemon> mirrors;
+        for (const auto &mirror : this->downloadNodes(node)) {
+            mirrors.append(this->cacheDaemon(mirror));
+        }
+
+        QString endpoint = blockCacheProxy()->endpoint(this->cacheDaemon(node), mirrors);
+        if (!endpoint.isEmpty()) {
+            daemonAddress = endpoint;
+            proxyAddress.clear();
+            m_ctx->wallet->setUseSSL(false);
+            m_ctx->wallet->setDaemonLogin(blockCacheProxy()->username(), blockCacheProxy()->password());
         }
     }
 
-    m_ctx->wallet->initAsync(node.toAddress(), true, 0, false, false, 0, proxyAddress);
+    m_ctx->wallet->initAsync(daemonAddress, true, 0, false, false, 0, proxyAddress);
 
     m_connection = node;
     m_connection.isActive = false;
@@ -324,6 +339,60 @@ FeatherNode Nodes::pickEligibleNode() {
     return rtn;
 }
 
+QList<FeatherNode> Nodes::downloadNodes(const FeatherNode &connected) {
+    // Other eligible nodes that restores can download blocks from in parallel
+    auto wsMode = (this->source() == NodeSource::websocket);
+    auto nodes = wsMode ? websocketNodes() : m_customNodes;
+
+    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
+    std::shuffle(nodes.begin(), nodes.end(), std::default_random_engine(seed));
+
+    int mode_height = this->modeHeight(nodes);
+    QList<FeatherNode> eligible;
+    for (const auto &node : nodes) {
+        if (eligible.size() >= maxDownloadNodes) {
+            break;
+        }
+
+        if (!node.isValid() || node == connected || m_recentFailures.contains(node.toAddress())) {
+            continue;
+        }
+
+        if (wsMode && m_wsNodesReceived) {
+            if (!node.online || node.height < (mode_height - 25) || node.target_height > node.height) {
+                continue;
+            }
+        }
+
+        eligible.append(node);
+    }
+
+    return eligible;
+}
+
+QString Nodes::proxyAddress(const FeatherNode &node) {
+    if (!useTorProxy(node)) {
+        return {};
+    }
+
+    if (!torManager()->isLocalTor()) {
+        return QString("%1:%2").arg(torManager()->featherTorHost, QString::number(torManager()->featherTorPort));
+    }
+
+    return QString("%1:%2").arg(config()->get(Config::socks5Host).toString(),
+                                config()->get(Config::socks5Port).toString());
+}
+
+BlockCacheProxy::Daemon Nodes::cacheDaemon(const FeatherNode &node) {
+    BlockCacheProxy::Daemon daemon;
+    daemon.address = node.toAddress();
+    daemon.ssl = !node.isOnion();
+    daemon.username = node.url.userName();
+    daemon.password = node.url.password();
+    daemon.proxyAddress = this->proxyAddress(node);
+    return daemon;
+}
+
 void Nodes::onWSNodesReceived(QList<FeatherNode> &nodes) {
     m_websocketNodes.clear();
 
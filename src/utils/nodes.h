@@ -14,6 +14,7 @@
 #include "model/NodeModel.h"
 #include "utils/Utils.h"
 #include "utils/config.h"
+#include "utils/BlockCacheProxy.h"
 
 enum NodeSource {
     websocket = 0,
@@ -160,6 +161,9 @@ private:
     bool m_enableAutoconnect = true;
 
     FeatherNode pickEligibleNode();
+    QList<FeatherNode> downloadNodes(const FeatherNode &connected);
+    QString proxyAddress(const FeatherNode &node);
+    BlockCacheProxy::Daemon cacheDaemon(const FeatherNode &node);
 
     bool useOnionNodes();
     bool useTorProxy(const FeatherNode &node);
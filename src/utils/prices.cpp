@@ -3,6 +3,8 @@
 
 #include "utils/prices.h"
 
+#include <QSet>
+
 Prices::Prices(QObject *parent)
     : QObject(parent)
 {
@@ -25,6 +27,7 @@ void Prices::cryptoPricesReceived(const QJsonArray &data) {
         this->markets.insert(ms.symbol.toUpper(), ms);
     }
 
+    this->updateConversionMatrix();
     emit cryptoPricesUpdated();
 }
 
@@ -33,41 +36,90 @@ void Prices::fiatPricesReceived(const QJsonObject &data) {
     for (const auto &currency : ratesData.keys()) {
         this->rates.insert(currency, ratesData.value(currency).toDouble());
     }
+    this->updateConversionMatrix();
     emit fiatPricesUpdated();
 }
 
-double Prices::convert(QString symbolFrom, QString symbolTo, double amount) {
-    if (symbolFrom == symbolTo)
-        return amount;
-    if (amount <= 0.0)
-        return 0.0;
+void Prices::updateConversionMatrix() {
+    // Price of one unit of each symbol in USD, markets take precedence over fiat rates.
+    // Ids are never reassigned, a symbol that is no longer priced keeps its id and converts to 0.
+    QVector<double> usdPrices(m_symbolIds.size(), 0.0);
+    QSet<QString> priced;
 
-    symbolFrom = symbolFrom.toUpper();
-    symbolTo = symbolTo.toUpper();
+    auto intern = [this, &usdPrices, &priced](const QString &symbol, double usdPrice) {
+        if (usdPrice <= 0.0 || priced.contains(symbol)) {
+            return;
+        }
+        priced.insert(symbol);
+        auto it = m_symbolIds.constFind(symbol);
+        if (it == m_symbolIds.constEnd()) {
+            m_symbolIds.insert(symbol, usdPrices.size());
+            usdPrices.append(usdPrice);
+        } else {
+            usdPrices[it.value()] = usdPrice;
+        }
+    };
 
-    double usdPrice;
-    if (this->markets.contains(symbolFrom)) {
-        usdPrice = this->markets[symbolFrom].price_usd * amount;
+    intern("USD", 1.0);
+    for (auto it = this->markets.constBegin(); it != this->markets.constEnd(); ++it) {
+        intern(it.key(), it.value().price_usd);
     }
-    else if (this->rates.contains(symbolFrom)) {
-        if (symbolFrom == "USD") {
-            usdPrice = amount;
-        } else {
-            usdPrice = amount / this->rates[symbolFrom];
+    for (auto it = this->rates.constBegin(); it != this->rates.constEnd(); ++it) {
+        if (it.value() > 0.0) {
+            intern(it.key().toUpper(), 1.0 / it.value());
         }
     }
-    else {
+
+    int n = usdPrices.size();
+    QVector<double> matrix(n * n);
+    for (int from = 0; from < n; from++) {
+        for (int to = 0; to < n; to++) {
+            if (usdPrices[from] <= 0.0 || usdPrices[to] <= 0.0) {
+                matrix[from * n + to] = 0.0;
+            } else {
+                matrix[from * n + to] = (from == to) ? 1.0 : usdPrices[from] / usdPrices[to];
+            }
+        }
+    }
+
+    m_matrix = matrix;
+    m_symbolCount = n;
+}
+
+int Prices::symbolId(const QString &symbol) const {
+    auto it = m_symbolIds.constFind(symbol);
+    if (it != m_symbolIds.constEnd()) {
+        return it.value();
+    }
+    return m_symbolIds.value(symbol.toUpper(), -1);
+}
+
+double Prices::rate(int idFrom, int idTo) const {
+    if (idFrom < 0 || idTo < 0 || idFrom >= m_symbolCount || idTo >= m_symbolCount) {
         return 0.0;
     }
+    return m_matrix[idFrom * m_symbolCount + idTo];
+}
 
-    if (symbolTo == "USD")
-        return usdPrice;
+double Prices::convert(int idFrom, int idTo, double amount) const {
+    if (amount <= 0.0)
+        return 0.0;
+    return amount * this->rate(idFrom, idTo);
+}
 
-    if (this->markets.contains(symbolTo))
-        return usdPrice / this->markets[symbolTo].price_usd;
-    else if (this->rates.contains(symbolTo))
-        return usdPrice * this->rates[symbolTo];
+QVector<double> Prices::convertAtomic(int idFrom, int idTo, const QVector<qint64> &amounts, double divisor) const {
+    double factor = this->rate(idFrom, idTo) / divisor;
 
-    return 0.0;
+    QVector<double> result(amounts.size());
+    for (int i = 0; i < amounts.size(); i++) {
+        result[i] = (amounts[i] > 0) ? amounts[i] * factor : 0.0;
+    }
+    return result;
 }
 
+double Prices::convert(const QString &symbolFrom, const QString &symbolTo, double amount) const {
+    if (symbolFrom == symbolTo)
+        return amount;
+
+    return this->convert(this->symbolId(symbolFrom), this->symbolId(symbolTo), amount);
+}
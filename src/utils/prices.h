@@ -25,15 +25,30 @@ public:
     QMap<QString, double> rates;
     QMap<QString, marketStruct> markets;
 
+    // Symbols are interned to small ids that stay the same for the session, -1 if we never had a price for the symbol
+    int symbolId(const QString &symbol) const;
+    double rate(int idFrom, int idTo) const;
+    double convert(int idFrom, int idTo, double amount) const;
+    // Converts a column of atomic XMR amounts (or any atomic amounts with the given divisor) at once
+    QVector<double> convertAtomic(int idFrom, int idTo, const QVector<qint64> &amounts, double divisor) const;
+
 public slots:
     void cryptoPricesReceived(const QJsonArray &data);
     void fiatPricesReceived(const QJsonObject &data);
 
-    double convert(QString symbolFrom, QString symbolTo, double amount);
+    double convert(const QString &symbolFrom, const QString &symbolTo, double amount) const;
 
 signals:
     void fiatPricesUpdated();
     void cryptoPricesUpdated();
+
+private:
+    void updateConversionMatrix();
+
+    QHash<QString, int> m_symbolIds;
+    // m_matrix[from * m_symbolCount + to] is the price of one unit of 'from' in 'to'
+    QVector<double> m_matrix;
+    int m_symbolCount = 0;
 };
 
 #endif //FEATHER_PRICES_H
@@ -7,11 +7,20 @@
 #include <QPainter>
 #include <QPen>
 
+#include <algorithm>
+
+#include "utils/config.h"
+
 QrCodeWidget::QrCodeWidget(QWidget *parent) : QWidget(parent)
 {
+    connect(&m_timer, &QTimer::timeout, this, &QrCodeWidget::nextFrame);
 }
 
 void QrCodeWidget::setQrCode(QrCode *qrCode) {
+    m_timer.stop();
+    m_encoder.reset();
+    m_frame.reset();
+
     m_qrcode = qrCode;
 
     int k = m_qrcode->width();
@@ -20,6 +29,42 @@ void QrCodeWidget::setQrCode(QrCode *qrCode) {
     this->update();
 }
 
+void QrCodeWidget::setAnimatedData(const QByteArray &data, int fragmentLength) {
+    m_encoder.reset(new FountainEncoder(data, fragmentLength));
+    this->nextFrame();
+
+    int k = m_qrcode->width();
+    this->setMinimumSize(k*5, k*5);
+
+    if (m_encoder->fragmentCount() > 1) {
+        this->setFrameRate(config()->get(Config::animatedQrFrameRate).toInt());
+    } else {
+        m_timer.stop();
+    }
+}
+
+void QrCodeWidget::setFrameRate(int fps) {
+    if (!this->isAnimated()) {
+        return;
+    }
+    m_timer.start(1000 / std::clamp(fps, 1, 30));
+}
+
+bool QrCodeWidget::isAnimated() const {
+    return m_encoder && m_encoder->fragmentCount() > 1;
+}
+
+void QrCodeWidget::nextFrame() {
+    if (!m_encoder) {
+        return;
+    }
+
+    // Low error correction leaves the most room for data, frames that fail to scan are made up for by later ones
+    m_frame.reset(new QrCode(m_encoder->nextPart(), QrCode::Version::AUTO, QrCode::ErrorCorrectionLevel::LOW));
+    m_qrcode = m_frame.data();
+    this->update();
+}
+
 void QrCodeWidget::paintEvent(QPaintEvent *event) {
     // Implementation adapted from Electrum: qrcodewidget.py
     if (!m_qrcode) {
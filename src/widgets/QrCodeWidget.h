@@ -4,9 +4,11 @@
 #ifndef FEATHER_QRCODEWIDGET_H
 #define FEATHER_QRCODEWIDGET_H
 
+#include <QTimer>
 #include <QWidget>
 
 #include "qrcode/QrCode.h"
+#include "utils/FountainCode.h"
 
 class QrCodeWidget : public QWidget
 {
@@ -16,13 +18,24 @@ public:
     explicit QrCodeWidget(QWidget *parent = nullptr);
     void setQrCode(QrCode *qrCode);
 
+    // Shows data of any size as a sequence of fountain coded frames, a single frame if it fits
+    void setAnimatedData(const QByteArray &data, int fragmentLength = 200);
+    void setFrameRate(int fps);
+    bool isAnimated() const;
+
 protected:
     void paintEvent(QPaintEvent *event) override;
     int heightForWidth(int w) const override;
     bool hasHeightForWidth() const override;
 
 private:
+    void nextFrame();
+
     QrCode *m_qrcode = nullptr;
+
+    QScopedPointer<FountainEncoder> m_encoder;
+    QScopedPointer<QrCode> m_frame;
+    QTimer m_timer;
 };
 
 #endif //FEATHER_QRCODEWIDGET_H
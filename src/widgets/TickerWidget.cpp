@@ -71,7 +71,7 @@ BalanceTickerWidget::BalanceTickerWidget(QWidget *parent, QSharedPointer<AppCont
 
 void BalanceTickerWidget::updateDisplay() {
     double balance = (m_totalBalance ? m_ctx->wallet->balanceAll() : m_ctx->wallet->balance()) / constants::cdiv;
-    QString fiatCurrency = config()->get(Config::preferredFiatCurrency).toString();
+    QString fiatCurrency = configSnapshot()->preferredFiatCurrency;
     double balanceFiatAmount = appData()->prices.convert("XMR", fiatCurrency, balance);
     if (balanceFiatAmount < 0)
         return;
@@ -90,7 +90,7 @@ PriceTickerWidget::PriceTickerWidget(QWidget *parent, QSharedPointer<AppContext>
 }
 
 void PriceTickerWidget::updateDisplay() {
-    QString fiatCurrency = config()->get(Config::preferredFiatCurrency).toString();
+    QString fiatCurrency = configSnapshot()->preferredFiatCurrency;
     double price = appData()->prices.convert(m_symbol, fiatCurrency, 1.0);
     if (price < 0)
         return;
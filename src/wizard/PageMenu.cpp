@@ -24,9 +24,25 @@ PageMenu::PageMenu(WizardFields *fields, WalletKeysFilesModel *wallets, QWidget
     ui->check_darkMode->setChecked(settingsSkin == "QDarkStyle");
 
     connect(ui->check_darkMode, &QCheckBox::toggled, this, &PageMenu::enableDarkMode);
+
+    // Wallets are discovered in the background, the default follows until the user picks something
+    for (auto *radio : {ui->radioCreate, ui->radioOpen, ui->radioSeed, ui->radioViewOnly, ui->radioCreateFromDevice}) {
+        connect(radio, &QRadioButton::clicked, [this]{
+            m_choiceMade = true;
+        });
+    }
+    connect(m_walletKeysFilesModel, &WalletKeysFilesModel::refreshFinished, [this]{
+        if (!m_choiceMade) {
+            this->setDefaultChoice();
+        }
+    });
 }
 
 void PageMenu::initializePage() {
+    this->setDefaultChoice();
+}
+
+void PageMenu::setDefaultChoice() {
     if (m_walletKeysFilesModel->rowCount() > 0) {
         ui->radioOpen->setChecked(true);
     } else {
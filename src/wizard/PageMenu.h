@@ -28,9 +28,12 @@ signals:
     void enableDarkMode(bool enable);
 
 private:
+    void setDefaultChoice();
+
     Ui::PageMenu *ui;
     WalletKeysFilesModel *m_walletKeysFilesModel;
     WizardFields *m_fields;
+    bool m_choiceMade = false;
 };
 
 #endif //FEATHER_WIZARDMENU_H